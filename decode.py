@@ -6,58 +6,328 @@ HEADER_BOOT =  0x00
 HEADER_UPDATE = 0x01
 HEADER_BUTTON_CLICK = 0x02
 HEADER_BUTTON_HOLD  = 0x03
+HEADER_BATCH = 0x04
+HEADER_THRESHOLD = 0x05
+HEADER_BACKFILL = 0x06
+
+HEADER_COMPACT = 0x80
+HEADER_KEYFRAME = 0x40
+HEADER_ACK = 0x08
+# Power tier of the device in the standard and batch frames
+HEADER_TIER = 0x30
+HEADER_TIER_SHIFT = 4
+
+ORIENTATION_TAMPER = 0x80
+
+COMPACT_FIELDS = (
+    # name, conversion to the physical value, signed in keyframe
+    ('voltage', lambda v: v / 10.0, False),
+    ('orientation', int, False),
+    ('temperature', lambda v: v / 10.0, True),
+    ('humidity', lambda v: v / 2.0, False),
+    ('illuminance', int, False),
+    ('pressure', lambda v: v * 2, False),
+    ('pir_motion_count', int, False),
+    ('co2', int, False),
+)
 
 header_lut = {
     HEADER_BOOT: 'BOOT',
     HEADER_UPDATE: 'UPDATE',
     HEADER_BUTTON_CLICK: 'BUTTON_CLICK',
-    HEADER_BUTTON_HOLD: 'BUTTON_HOLD'
+    HEADER_BUTTON_HOLD: 'BUTTON_HOLD',
+    HEADER_BATCH: 'BATCH',
+    HEADER_THRESHOLD: 'THRESHOLD',
+    HEADER_BACKFILL: 'BACKFILL'
 }
 
+tier_lut = ('NORMAL', 'ECO', 'SURVIVAL')
+
+
+def read_varint(raw, offset):
+    value = 0
+    shift = 0
+    while True:
+        byte = raw[offset]
+        offset += 1
+        value |= (byte & 0x7f) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, offset
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def decode_compact_raw(data):
+    raw = bytes.fromhex(data)
+    keyframe = bool(raw[0] & HEADER_KEYFRAME)
+    fields = raw[1]
+    values = {}
+    offset = 2
+
+    for i, (name, _, signed) in enumerate(COMPACT_FIELDS):
+        if not fields & (1 << i):
+            continue
+        value, offset = read_varint(raw, offset)
+        if name == 'pir_motion_count' or (keyframe and not signed):
+            values[name] = value
+        else:
+            values[name] = unzigzag(value)
+
+    # Keyframe closes with the power tier unless it is normal
+    tier = raw[offset] if keyframe and offset < len(raw) else 0
+
+    return {
+        "header": raw[0] & 0x07,
+        "tier": tier,
+        "keyframe": keyframe,
+        "sequence": (raw[0] >> 4) & 0x03,
+        "fields": fields,
+        "values": values
+    }
+
+
+def decode_compact(data, keyframe=None):
+    frame = decode_compact_raw(data)
+    values = frame['values']
+
+    if not frame['keyframe']:
+        if keyframe is None:
+            raise Exception("Delta frame, keyframe data required")
+
+        reference = decode_compact_raw(keyframe)
+
+        if not reference['keyframe'] or reference['sequence'] != frame['sequence']:
+            raise Exception("Keyframe does not match the sequence of the delta frame")
+
+        # Fields left out of a delta frame are unchanged since the keyframe
+        values = dict((name, value + values.get(name, 0)) for name, value in reference['values'].items())
+        frame['tier'] = reference['tier']
+
+    decoded = {"header": header_lut.get(frame['header'], frame['header']), "tier": tier_lut[frame['tier']]}
+
+    for name, convert, _ in COMPACT_FIELDS:
+        value = values.get(name)
+        decoded[name] = convert(value) if value is not None else None
+
+    if decoded['orientation'] is not None:
+        decoded['tamper'] = bool(decoded['orientation'] & ORIENTATION_TAMPER)
+        decoded['orientation'] &= ~ORIENTATION_TAMPER
+
+    return decoded
+
+
+def decode_snapshots(data, offset, count, age_size=1):
+    size = (6 + age_size) * 2
+
+    if len(data) != offset + count * size:
+        raise Exception("Bad data length, %d characters expected" % (offset + count * size))
+
+    snapshots = []
+
+    for i in range(count):
+        s = data[offset + i * size:offset + size + i * size]
+        age = int(s[0:age_size * 2], 16)
+        # The fields after the age as in a batch snapshot
+        s = s[age_size * 2 - 2:]
+
+        temperature = int(s[2:6], 16) if s[2:6] != 'ffff' else None
+
+        if temperature is not None:
+            if temperature >= 32768:
+                temperature -= 65536
+            temperature /= 10.0
+
+        snapshots.append({
+            "age": age,
+            "temperature": temperature,
+            "humidity": int(s[6:8], 16) / 2.0 if s[6:8] != 'ff' else None,
+            "co2": int(s[8:12], 16) if s[8:12] != 'ffff' else None,
+            "pir_motion": int(s[12:14], 16)
+        })
+
+    return snapshots
+
+
+def decode_batch(data):
+    snapshots = decode_snapshots(data, 16, int(data[14:16], 16))
+
+    return {
+        "header": header_lut[HEADER_BATCH],
+        "tier": tier_lut[0],
+        "voltage": int(data[2:4], 16) / 10.0 if data[2:4] != 'ff' else None,
+        "orientation": int(data[4:6], 16) & ~ORIENTATION_TAMPER,
+        "tamper": bool(int(data[4:6], 16) & ORIENTATION_TAMPER),
+        "illuminance": int(data[6:10], 16) if data[6:10] != 'ffff' else None,
+        "pressure": int(data[10:14], 16) * 2 if data[10:14] != 'ffff' else None,
+        "snapshots": snapshots
+    }
 
-def decode(data):
-    if len(data) != 32:
-        raise Exception("Bad data length, 32 characters expected")
+
+def decode_backfill(data):
+    return {
+        "header": header_lut[HEADER_BACKFILL],
+        "sequence": int(data[2:6], 16),
+        "records": decode_snapshots(data, 8, int(data[6:8], 16), 2)
+    }
+
+
+def decode(data, keyframe=None):
+    if int(data[0:2], 16) & HEADER_ACK:
+        # Acknowledgement of the last downlink closes the frame
+        decoded = decode('%02x' % (int(data[0:2], 16) & ~HEADER_ACK) + data[2:-4], keyframe)
+        decoded['ack'] = {"sequence": int(data[-4:-2], 16), "status": int(data[-2:], 16)}
+        return decoded
+
+    if int(data[0:2], 16) & HEADER_COMPACT:
+        return decode_compact(data, keyframe)
+
+    if int(data[0:2], 16) & HEADER_TIER:
+        decoded = decode('%02x' % (int(data[0:2], 16) & ~HEADER_TIER) + data[2:], keyframe)
+        decoded['tier'] = tier_lut[(int(data[0:2], 16) & HEADER_TIER) >> HEADER_TIER_SHIFT]
+        return decoded
+
+    if int(data[0:2], 16) == HEADER_BATCH:
+        return decode_batch(data)
+
+    if int(data[0:2], 16) == HEADER_BACKFILL:
+        return decode_backfill(data)
+
+    # Firmware before the occupancy ends after CO2 or the statistics
+    if len(data) not in (32, 40, 54, 62):
+        raise Exception("Bad data length, 32, 40, 54 or 62 characters expected")
 
     header = int(data[0:2], 16)
 
     temperature = int(data[6:10], 16) if data[6:10] != 'ffff' else None
 
-    if temperature:
-        if temperature > 32768:
+    if temperature is not None:
+        if temperature >= 32768:
             temperature -= 65536
         temperature /= 10.0
 
-    return {
+    decoded = {
         "header": header_lut[header],
+        "tier": tier_lut[0],
         "voltage": int(data[2:4], 16) / 10.0 if data[2:4] != 'ff' else None,
-        "orientation": int(data[4:6], 16),
+        "orientation": int(data[4:6], 16) & ~ORIENTATION_TAMPER,
+        "tamper": bool(int(data[4:6], 16) & ORIENTATION_TAMPER),
         "temperature": temperature,
         "humidity": int(data[10:12], 16) / 2.0 if data[10:12] != 'ff' else None,
         "illuminance": int(data[12:16], 16) if data[12:16] != 'ffff' else None,
         "pressure": int(data[16:20], 16) * 2 if data[16:20] != 'ffff' else None,
         "pir_motion_count": int(data[20:28], 16) if data[20:28] != 'ffffffff' else None,
+        "occupancy": decode_occupancy(data[-8:]) if len(data) in (40, 62) else None,
         "co2": int(data[28:32], 16) if data[28:32] != 'ffff' else None
     }
 
+    if len(data) in (54, 62):
+        decoded.update(decode_stats(data[32:54]))
+
+    return decoded
+
+
+def decode_occupancy(data):
+    if data == 'ffffffff':
+        return None
+
+    minutes = int(data[0:2], 16)
+    bin = int(data[2:4], 16)
+    bitmap = int(data[4:8], 16)
+    bins = [i for i in range(16) if bitmap & (1 << i)]
+
+    return {
+        "minutes": minutes,
+        "bin": bin,
+        "bitmap": bitmap,
+        # Resolution of the bins, the last bin also holds motion after the nominal end of the interval
+        "first": bins[0] * bin if bins else None,
+        "last": (bins[-1] + 1) * bin if bins else None
+    }
+
+
+def decode_stats(data):
+    def temperature(s):
+        if s == 'ffff':
+            return None
+        value = int(s, 16)
+        return (value - 65536 if value >= 32768 else value) / 10.0
+
+    return {
+        "temperature_min": temperature(data[0:4]),
+        "temperature_max": temperature(data[4:8]),
+        "temperature_stddev": int(data[8:10], 16) / 100.0 if data[8:10] != 'ff' else None,
+        "co2_min": int(data[10:14], 16) if data[10:14] != 'ffff' else None,
+        "co2_max": int(data[14:18], 16) if data[14:18] != 'ffff' else None,
+        "co2_stddev": int(data[18:22], 16) if data[18:22] != 'ffff' else None
+    }
+
+
+def pprint_batch(data):
+    print('Header :', data['header'])
+    print('Tier :', data['tier'])
+    print('Voltage :', data['voltage'])
+    print('Orientation :', data['orientation'])
+    print('Tamper :', data['tamper'])
+    print('Illuminance :', data['illuminance'])
+    print('Pressure :', data['pressure'])
+    for snapshot in data['snapshots']:
+        print('-%3d min : Temperature %s, Humidity %s, CO2 %s, PIR motion %s' % (
+            snapshot['age'], snapshot['temperature'], snapshot['humidity'], snapshot['co2'], snapshot['pir_motion']))
+
+
+def pprint_backfill(data):
+    print('Header :', data['header'])
+    print('Sequence :', data['sequence'])
+    for record in data['records']:
+        print('-%3d min : Temperature %s, Humidity %s, CO2 %s, PIR motion %s' % (
+            record['age'], record['temperature'], record['humidity'], record['co2'], record['pir_motion']))
+
 
 def pprint(data):
+    if 'ack' in data:
+        print('Downlink ack : sequence %d, status 0x%02x' % (data['ack']['sequence'], data['ack']['status']))
+
+    if 'snapshots' in data:
+        return pprint_batch(data)
+
+    if 'records' in data:
+        return pprint_backfill(data)
+
     print('Header :', data['header'])
+    if 'tier' in data:
+        print('Tier :', data['tier'])
     print('Voltage :', data['voltage'])
     print('Orientation :', data['orientation'])
+    print('Tamper :', data['tamper'])
     print('Temperature :', data['temperature'])
     print('Humidity :', data['humidity'])
     print('Illuminance :', data['illuminance'])
     print('Pressure :', data['pressure'])
     print('PIR motion count :', data['pir_motion_count'])
+    if 'occupancy' in data:
+        occupancy = data['occupancy']
+        if occupancy and occupancy['minutes']:
+            print('Occupancy : %d min, motion %d - %d min, bitmap %s per %d min' % (
+                occupancy['minutes'], occupancy['first'], occupancy['last'],
+                format(occupancy['bitmap'], '016b')[::-1], occupancy['bin']))
+        else:
+            print('Occupancy :', occupancy['minutes'] if occupancy else None)
     print('CO2 :', data['co2'])
 
+    if 'co2_stddev' in data:
+        print('Temperature min/max/stddev :', data['temperature_min'], data['temperature_max'], data['temperature_stddev'])
+        print('CO2 min/max/stddev :', data['co2_min'], data['co2_max'], data['co2_stddev'])
+
 
 if __name__ == '__main__':
-    if len(sys.argv) != 2 or sys.argv[1] in ('help', '-h', '--help'):
-        print("usage: python3 decode.py [data]")
+    if len(sys.argv) not in (2, 3) or sys.argv[1] in ('help', '-h', '--help'):
+        print("usage: python3 decode.py [data] [keyframe]")
         print("example: python3 decode.py 001E0100F5540070C1BE00000001FFFF")
+        print("example: python3 decode.py a1ec01020a008b04 e1ff3e048c035d00e9800300cc06")
         exit(1)
 
-    data = decode(sys.argv[1].lower())
+    data = decode(sys.argv[1].lower(), sys.argv[2].lower() if len(sys.argv) == 3 else None)
     pprint(data)
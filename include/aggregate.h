@@ -0,0 +1,46 @@
+#ifndef _AGGREGATE_H
+#define _AGGREGATE_H
+
+#include <twr_common.h>
+
+// Streaming statistics of one quantity over one interval in integer units (e.g. centi-degrees, ppm),
+// every feed is O(1) without sample buffers and without floating point
+typedef struct
+{
+    uint16_t _count;
+    bool _last_valid;
+    int32_t _offset;
+    int64_t _sum;
+    uint64_t _sum_squares;
+    int32_t _min;
+    int32_t _max;
+    int32_t _last;
+
+} aggregate_t;
+
+void aggregate_init(aggregate_t *self);
+
+void aggregate_feed(aggregate_t *self, int32_t value);
+
+// Failed measurement, drops everything including the last value
+void aggregate_invalidate(aggregate_t *self);
+
+// Starts a new interval, the last value is kept
+void aggregate_reset(aggregate_t *self);
+
+int aggregate_get_count(aggregate_t *self);
+
+// Mean rounded to the nearest integer
+bool aggregate_get_mean(aggregate_t *self, int32_t *result);
+
+bool aggregate_get_min(aggregate_t *self, int32_t *result);
+
+bool aggregate_get_max(aggregate_t *self, int32_t *result);
+
+// Population standard deviation rounded down
+bool aggregate_get_stddev(aggregate_t *self, int32_t *result);
+
+// Last value fed, also from the previous intervals
+bool aggregate_get_last(aggregate_t *self, int32_t *result);
+
+#endif // _AGGREGATE_H
@@ -0,0 +1,49 @@
+#ifndef _AIRTIME_H
+#define _AIRTIME_H
+
+#include <twr_cmwx1zzabz.h>
+
+// Default budget, the EU868 1 % duty cycle
+#define AIRTIME_BUDGET_DEFAULT 36000
+
+typedef struct
+{
+    // Time on air [ms] and number of uplinks since boot
+    uint32_t used;
+    uint32_t uplinks;
+    // Transmissions postponed to stay within the budget
+    uint32_t deferred;
+
+} airtime_stats_t;
+
+// Accounts the time on air of every uplink at the current band and data rate. Each uplink has to respect
+// the duty cycle off-time of the previous one (EU868) and draw its time on air from a token bucket
+// refilled by the hourly budget, so the module is never asked to transmit when it would refuse.
+void airtime_init(twr_cmwx1zzabz_t *lora);
+
+// Time on air [ms] of an uplink with the application payload of the given length, repetitions included
+uint32_t airtime_get(size_t length);
+
+// Ticks until an uplink of the given length fits the budget, zero if it can be sent now
+twr_tick_t airtime_get_delay(size_t length);
+
+// Call after every uplink, link checks have the length zero
+void airtime_sent(size_t length, bool confirmed);
+
+// Call on every retry of a confirmed uplink
+void airtime_retransmitted(void);
+
+// Call when a transmission is postponed by the delay
+void airtime_deferred(void);
+
+// Time on air [ms] allowed per hour, also the size of the bucket
+void airtime_set_budget(uint32_t budget);
+
+uint32_t airtime_get_budget(void);
+
+// Time on air [ms] available now
+uint32_t airtime_get_available(void);
+
+void airtime_get_stats(airtime_stats_t *stats);
+
+#endif // _AIRTIME_H
@@ -0,0 +1,25 @@
+#ifndef _BACKFILL_H
+#define _BACKFILL_H
+
+#include <payload.h>
+#include <twr_cmwx1zzabz.h>
+
+#define BACKFILL_HEADER_SIZE 4
+#define BACKFILL_RECORD_SIZE 8
+
+// Logs every send interval into the EEPROM ring log and checks the link periodically,
+// records missed during an outage are resent in frames of the given header once a link check succeeds
+void backfill_init(twr_cmwx1zzabz_t *lora, uint8_t header, uint32_t address, size_t size);
+
+// Logs the aggregates of one send interval of the given length
+void backfill_push(const payload_t *payload, twr_tick_t interval);
+
+// Feed with the result of every link check
+void backfill_link_check(bool ok);
+
+// Number of records waiting to be resent
+int backfill_get_pending(void);
+
+bool backfill_is_online(void);
+
+#endif // _BACKFILL_H
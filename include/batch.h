@@ -0,0 +1,45 @@
+#ifndef _BATCH_H
+#define _BATCH_H
+
+#include <payload.h>
+#include <twr_tick.h>
+
+#define BATCH_MAX_SNAPSHOTS 16
+
+#define BATCH_HEADER_SIZE 8
+#define BATCH_SNAPSHOT_SIZE 7
+#define BATCH_MAX_SIZE (BATCH_HEADER_SIZE + BATCH_MAX_SNAPSHOTS * BATCH_SNAPSHOT_SIZE)
+
+// One measurement interval, values in the units of the standard frame,
+// fields uses PAYLOAD_FIELD_TEMPERATURE, PAYLOAD_FIELD_HUMIDITY and PAYLOAD_FIELD_CO2
+typedef struct
+{
+    twr_tick_t tick;
+    uint8_t fields;
+    int16_t temperature;
+    uint8_t humidity;
+    uint16_t co2;
+    uint32_t pir_motion_count;
+
+} batch_snapshot_t;
+
+void batch_init(void);
+
+// Number of snapshots per uplink, 1 disables batching, the first snapshot counts the motions from pir_motion_count on
+void batch_set_size(uint8_t size, uint32_t pir_motion_count);
+
+uint8_t batch_get_size(void);
+
+bool batch_is_enabled(void);
+
+void batch_push(const batch_snapshot_t *snapshot);
+
+int batch_get_count(void);
+
+// Batch is complete when it has the configured number of snapshots or no more fit into frame_size bytes
+bool batch_is_full(size_t frame_size);
+
+// Encode the oldest snapshots which fit into size bytes and drop them, returns length of the frame
+size_t batch_encode(const payload_t *payload, uint8_t *buffer, size_t size);
+
+#endif // _BATCH_H
@@ -0,0 +1,29 @@
+#ifndef _BATTERY_H
+#define _BATTERY_H
+
+#include <twr_tick.h>
+
+// Nominal capacity of the four AAA alkaline cells [mAh]
+#define BATTERY_CAPACITY 1000
+
+// Battery model of the pack. The voltage is tracked at rest and under the load of a transmission, the state of
+// charge is read off the discharge curve at rest and counted down by the charge the energy profile accounts.
+// The lower of the two holds, so the estimate only falls until the cells are replaced.
+void battery_init(void);
+
+// Call with every measured voltage, loaded if it was measured during a transmission
+void battery_feed(float voltage, bool loaded);
+
+// Filtered voltage [mV] at rest or under load, false before the first measurement of the kind
+bool battery_get_voltage(bool loaded, int *millivolts);
+
+// State of charge [%], false before the first measurement
+bool battery_get_charge(int *percentage);
+
+// Remaining capacity [mAh]
+uint32_t battery_get_remaining(void);
+
+// Days until empty at the average current since boot, false if unknown
+bool battery_get_days(uint32_t *days);
+
+#endif // _BATTERY_H
@@ -0,0 +1,30 @@
+#ifndef _CO2_SAMPLING_H
+#define _CO2_SAMPLING_H
+
+#include <twr_tick.h>
+
+#define CO2_SAMPLING_INTERVAL_LIMIT_MIN (1 * 60 * 1000)
+#define CO2_SAMPLING_INTERVAL_LIMIT_MAX (60 * 60 * 1000)
+
+// Adaptive CO2 measurement interval: doubled while the room is empty and CO2 is flat,
+// dropped to the minimum when motion starts or CO2 moves fast. Measurements run on the wake grid.
+void co2_sampling_init(twr_tick_t interval_min, twr_tick_t interval_max);
+
+void co2_sampling_set_bounds(twr_tick_t interval_min, twr_tick_t interval_max);
+
+twr_tick_t co2_sampling_get_interval_min(void);
+
+twr_tick_t co2_sampling_get_interval_max(void);
+
+twr_tick_t co2_sampling_get_interval(void);
+
+// Restart from the minimum interval and apply it to the CO2 module
+void co2_sampling_reset(void);
+
+// Call with every new CO2 concentration
+void co2_sampling_feed(int32_t ppm);
+
+// Call with every PIR motion event
+void co2_sampling_motion(void);
+
+#endif // _CO2_SAMPLING_H
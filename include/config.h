@@ -0,0 +1,81 @@
+#ifndef _CONFIG_H
+#define _CONFIG_H
+
+#include <twr_tick.h>
+
+// Items are stored in this order, new items are only ever appended
+typedef enum
+{
+    CONFIG_SEND_INTERVAL = 0,
+    CONFIG_MEASURE_INTERVAL = 1,
+    CONFIG_MEASURE_INTERVAL_BAROMETER = 2,
+    CONFIG_MEASURE_INTERVAL_CO2_MIN = 3,
+    CONFIG_MEASURE_INTERVAL_CO2_MAX = 4,
+    CONFIG_SEND_JITTER = 5,
+    CONFIG_MEASURE_TOLERANCE = 6,
+
+    // Plain numbers from here on, read and set by config_get_value and config_set_value
+    CONFIG_FLAGS = 7,
+    CONFIG_KEYFRAME_INTERVAL = 8,
+    CONFIG_BATCH_SIZE = 9,
+    CONFIG_AIRTIME_BUDGET = 10,
+    CONFIG_REPORT_HEARTBEAT = 11,
+    CONFIG_DEADBAND_TEMPERATURE = 12,
+    CONFIG_DEADBAND_HUMIDITY = 13,
+    CONFIG_DEADBAND_ILLUMINANCE = 14,
+    CONFIG_DEADBAND_PRESSURE = 15,
+    CONFIG_DEADBAND_MOTION = 16,
+    CONFIG_DEADBAND_CO2 = 17,
+    CONFIG_FILTER_TEMPERATURE = 18,
+    CONFIG_FILTER_HUMIDITY = 19,
+    CONFIG_FILTER_ILLUMINANCE = 20,
+    CONFIG_FILTER_PRESSURE = 21,
+    CONFIG_FILTER_CO2 = 22,
+    CONFIG_THRESHOLD_CO2_LEVEL_1 = 23,
+    CONFIG_THRESHOLD_CO2_LEVEL_2 = 24,
+    CONFIG_THRESHOLD_TEMPERATURE = 25,
+    CONFIG_THRESHOLD_MOTION_QUIET = 26,
+
+    CONFIG_COUNT
+
+} config_item_t;
+
+// Bits of CONFIG_FLAGS
+#define CONFIG_FLAG_COMPACT 0x01
+#define CONFIG_FLAG_STATS 0x02
+#define CONFIG_FLAG_POLICY 0x04
+#define CONFIG_FLAG_ADAPTIVE_DATARATE 0x08
+#define CONFIG_FLAG_REPORT 0x10
+
+// CONFIG_FILTER_* items, Hampel threshold in the high byte, window and mode in the nibbles of the low byte
+#define CONFIG_FILTER(mode, window, threshold) ((threshold) << 8 | (window) << 4 | (mode))
+#define CONFIG_FILTER_MODE(value) ((value) & 0x0f)
+#define CONFIG_FILTER_WINDOW(value) (((value) >> 4) & 0x0f)
+#define CONFIG_FILTER_THRESHOLD(value) ((value) >> 8)
+
+// Loads the configuration from EEPROM at the address, missing or invalid items get their defaults
+void config_init(uint32_t address);
+
+twr_tick_t config_get(config_item_t item);
+
+// Checks the limits of the item, the value has a resolution of one second
+bool config_set(config_item_t item, twr_tick_t value);
+
+// Items kept as plain numbers, units as in the AT command that sets them
+uint16_t config_get_value(config_item_t item);
+
+// Checks the limits of the item
+bool config_set_value(config_item_t item, uint16_t value);
+
+bool config_get_flag(uint16_t flag);
+
+void config_set_flag(uint16_t flag, bool value);
+
+twr_tick_t config_get_min(config_item_t item);
+
+twr_tick_t config_get_max(config_item_t item);
+
+// Writes the configuration to EEPROM if it differs from the stored one
+bool config_save(void);
+
+#endif // _CONFIG_H
@@ -0,0 +1,47 @@
+#ifndef _DOWNLINK_H
+#define _DOWNLINK_H
+
+#include <twr_common.h>
+
+// Port of the command downlinks
+#define DOWNLINK_PORT 10
+
+// Acknowledgement appended to the next uplink: sequence number and status
+#define DOWNLINK_ACK_SIZE 2
+
+// The status carries the index of the failing command in 4 bits
+#define DOWNLINK_COMMANDS_MAX 16
+
+typedef enum
+{
+    DOWNLINK_STATUS_OK = 0,
+    DOWNLINK_STATUS_UNKNOWN_OPCODE = 1,
+    DOWNLINK_STATUS_BAD_LENGTH = 2,
+    DOWNLINK_STATUS_BAD_VALUE = 3
+
+} downlink_status_t;
+
+typedef struct
+{
+    uint8_t opcode;
+    // Number of argument bytes following the opcode
+    uint8_t length;
+    // Returns false if the arguments are out of range
+    bool (*handler)(const uint8_t *args);
+
+} downlink_command_t;
+
+// Downlink: sequence number followed by one or more commands of opcode and arguments
+void downlink_init(const downlink_command_t *commands, size_t length);
+
+void downlink_process(uint8_t port, const uint8_t *data, size_t length);
+
+bool downlink_is_ack_pending(void);
+
+// True if an acknowledgement waits for the next uplink, fills DOWNLINK_ACK_SIZE bytes
+bool downlink_get_ack(uint8_t *buffer);
+
+// Call once the acknowledgement went out
+void downlink_ack_sent(void);
+
+#endif // _DOWNLINK_H
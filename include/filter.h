@@ -0,0 +1,62 @@
+#ifndef _FILTER_H
+#define _FILTER_H
+
+#include <twr_common.h>
+
+#define FILTER_WINDOW_MAX 9
+
+// Default Hampel limit in tenths of the scaled median absolute deviation
+#define FILTER_THRESHOLD_DEFAULT 30
+
+typedef enum
+{
+    // Every sample passes unchanged
+    FILTER_MODE_NONE = 0,
+
+    // Median of the window
+    FILTER_MODE_MEDIAN = 1,
+
+    // Sample passes unchanged unless it is further from the median of the window than the threshold times
+    // the median absolute deviation, the rejected sample still enters the window so a real step gets through
+    FILTER_MODE_HAMPEL = 2,
+
+    // Mean of the window without its lowest and highest sample
+    FILTER_MODE_TRIMMED_MEAN = 3
+
+} filter_mode_t;
+
+// Filter stage in front of an aggregate, a window of the last samples in a ring, insertion is O(1)
+// and every evaluation sorts at most FILTER_WINDOW_MAX values
+typedef struct
+{
+    filter_mode_t _mode;
+    uint8_t _window;
+    uint8_t _threshold;
+    uint8_t _count;
+    uint8_t _index;
+    int32_t _floor;
+    int32_t _buffer[FILTER_WINDOW_MAX];
+    uint32_t _rejected;
+
+} filter_t;
+
+// Window of 3 up to FILTER_WINDOW_MAX samples, the filter passes samples unchanged until the window is full.
+// Floor is the smallest Hampel limit in the unit of the samples, a step that small passes a flat window.
+void filter_init(filter_t *self, filter_mode_t mode, uint8_t window, uint8_t threshold, int32_t floor);
+
+// False if the sample is rejected, otherwise the result is the value to aggregate
+bool filter_feed(filter_t *self, int32_t value, int32_t *result);
+
+// Failed measurement, drops the window
+void filter_invalidate(filter_t *self);
+
+filter_mode_t filter_get_mode(filter_t *self);
+
+uint8_t filter_get_window(filter_t *self);
+
+uint8_t filter_get_threshold(filter_t *self);
+
+// Samples rejected since init
+uint32_t filter_get_rejected(filter_t *self);
+
+#endif // _FILTER_H
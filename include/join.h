@@ -0,0 +1,44 @@
+#ifndef _JOIN_H
+#define _JOIN_H
+
+#include <twr_cmwx1zzabz.h>
+
+typedef enum
+{
+    // Module in ABP mode, nothing to join
+    JOIN_STATE_ABP = 0,
+    JOIN_STATE_JOINING = 1,
+    JOIN_STATE_JOINED = 2
+
+} join_state_t;
+
+// Joins the network automatically when the module is in OTAA mode. Failed attempts back off exponentially
+// with a random spread, step the data rate down at random and keep the join duty cycle of LoRaWAN.
+// The session is noted in the EEPROM, a reboot with the same credentials resumes it instead of joining again
+// once a link check confirmed the module still has it.
+void join_init(twr_cmwx1zzabz_t *lora, uint32_t address);
+
+// Feed with the result of every join, JOIN_SUCCESS or JOIN_ERROR
+void join_feed_result(bool ok);
+
+// Feed with the result of every link check, a session failing all of them is joined again
+void join_feed_link_check(bool ok);
+
+// Feed with every error of the module, uplinks and link checks fail with it once the module lost its session
+void join_feed_error(void);
+
+// Drops the session and joins again
+void join_restart(void);
+
+join_state_t join_get_state(void);
+
+// True if uplinks can be sent, always in ABP mode
+bool join_is_joined(void);
+
+// Attempts of the join in progress
+uint32_t join_get_attempts(void);
+
+// Ticks until the next attempt, zero if none is planned
+twr_tick_t join_get_delay(void);
+
+#endif // _JOIN_H
@@ -0,0 +1,61 @@
+#ifndef _LINK_H
+#define _LINK_H
+
+#include <twr_cmwx1zzabz.h>
+
+typedef enum
+{
+    LINK_CLASS_PERIODIC = 0,
+    // Button and threshold uplinks
+    LINK_CLASS_ALARM = 1
+
+} link_class_t;
+
+typedef enum
+{
+    LINK_QUALITY_GOOD = 0,
+    LINK_QUALITY_FAIR = 1,
+    LINK_QUALITY_POOR = 2
+
+} link_quality_t;
+
+// Tracks the link margin from the SNR of received downlinks and link checks, acknowledgements of confirmed
+// uplinks and radio errors, and picks per message class confirmed or unconfirmed uplinks, the repetitions
+// and, with ADR disabled, the data rate
+void link_init(twr_cmwx1zzabz_t *lora);
+
+// Disabled leaves the repetitions to $REPU and $REPC and sends everything unconfirmed
+void link_set_enabled(bool enabled);
+
+bool link_is_enabled(void);
+
+// Steps the data rate by the margin, only while ADR is disabled
+void link_set_adaptive_datarate(bool enabled);
+
+bool link_get_adaptive_datarate(void);
+
+// SNR [dB] of a received downlink
+void link_feed_snr(int32_t snr);
+
+// Result of a link check with the margin [dB] reported by the network
+void link_feed_link_check(bool ok, uint8_t margin);
+
+void link_feed_confirmed(bool ok);
+
+void link_feed_error(void);
+
+link_quality_t link_get_quality(void);
+
+// Average margin above the demodulation floor in tenths of dB, false before the first sample
+bool link_get_margin(int32_t *margin);
+
+// Acknowledged confirmed uplinks [%]
+uint8_t link_get_delivery(void);
+
+// Repetitions no more than those of a link of the given quality, LINK_QUALITY_POOR lifts the limit
+void link_set_repeat_limit(link_quality_t quality);
+
+// Sets the repetitions of the message class, true if it has to be sent confirmed
+bool link_apply(link_class_t link_class);
+
+#endif // _LINK_H
@@ -0,0 +1,20 @@
+#ifndef _LORAWAN_H
+#define _LORAWAN_H
+
+#include <twr_cmwx1zzabz.h>
+
+// Maximum application payload (FRMPayload without FOpts) for the band and data rate
+size_t lorawan_get_max_payload(twr_cmwx1zzabz_config_band_t band, uint8_t datarate);
+
+// LoRaWAN MAC overhead of an uplink: MHDR, DevAddr, FCtrl, FCnt, FPort and MIC
+#define LORAWAN_MAC_OVERHEAD 13
+
+// Time on air in milliseconds of an uplink with the application payload of the given length
+uint32_t lorawan_get_airtime(twr_cmwx1zzabz_config_band_t band, uint8_t datarate, size_t length);
+
+// Lowest SNR the gateway demodulates at the data rate, in tenths of dB
+int32_t lorawan_get_snr_floor(twr_cmwx1zzabz_config_band_t band, uint8_t datarate);
+
+uint8_t lorawan_get_max_datarate(twr_cmwx1zzabz_config_band_t band);
+
+#endif // _LORAWAN_H
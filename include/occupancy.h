@@ -0,0 +1,36 @@
+#ifndef _OCCUPANCY_H
+#define _OCCUPANCY_H
+
+#include <twr_tick.h>
+
+// Bins of the bitmap, the width of one bin is the interval divided by them rounded up to whole minutes
+#define OCCUPANCY_BINS 16
+
+typedef struct
+{
+    // Minutes of the interval with at least one motion
+    uint16_t minutes;
+
+    // Minutes since the start of the interval of the first and the last motion, zero without motion
+    uint16_t first;
+    uint16_t last;
+
+    // Width of one bin [min], bit 0 is the first bin of the interval
+    uint8_t bin;
+    uint16_t bitmap;
+
+} occupancy_t;
+
+// Bins the PIR motions of the send interval into occupied minutes, so a room busy for five minutes can be
+// told from five single triggers at the cost of the cumulative motion counter
+void occupancy_init(twr_tick_t interval);
+
+// Starts a new interval of the given length
+void occupancy_start(twr_tick_t interval);
+
+// Call on every PIR motion
+void occupancy_motion(void);
+
+void occupancy_get(occupancy_t *occupancy);
+
+#endif // _OCCUPANCY_H
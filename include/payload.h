@@ -0,0 +1,104 @@
+#ifndef _PAYLOAD_H
+#define _PAYLOAD_H
+
+#include <twr_common.h>
+#include <occupancy.h>
+
+// Size of the fixed frame, also the upper bound of the compact frame
+#define PAYLOAD_STANDARD_SIZE 16
+#define PAYLOAD_COMPACT_MAX_SIZE 26
+
+// Interval statistics appended to the standard frame
+#define PAYLOAD_STATS_SIZE 11
+
+// Occupancy closing the standard frame, after the statistics
+#define PAYLOAD_OCCUPANCY_SIZE 4
+
+// Compact frame header: bit 7 compact, bit 6 keyframe, bits 5-4 keyframe sequence, bit 3 free for flags, bits 2-0 header
+#define PAYLOAD_HEADER_COMPACT 0x80
+#define PAYLOAD_HEADER_KEYFRAME 0x40
+#define PAYLOAD_HEADER_SEQUENCE_SHIFT 4
+#define PAYLOAD_HEADER_SEQUENCE_MASK 0x30
+#define PAYLOAD_HEADER_MASK 0x07
+
+// Orientation bit 7, the unit was moved since the last uplink
+#define PAYLOAD_ORIENTATION_TAMPER 0x80
+
+typedef enum
+{
+    PAYLOAD_FIELD_VOLTAGE = 0x01,
+    PAYLOAD_FIELD_ORIENTATION = 0x02,
+    PAYLOAD_FIELD_TEMPERATURE = 0x04,
+    PAYLOAD_FIELD_HUMIDITY = 0x08,
+    PAYLOAD_FIELD_ILLUMINANCE = 0x10,
+    PAYLOAD_FIELD_PRESSURE = 0x20,
+    PAYLOAD_FIELD_PIR_MOTION_COUNT = 0x40,
+    PAYLOAD_FIELD_CO2 = 0x80
+
+} payload_field_t;
+
+typedef enum
+{
+    PAYLOAD_FORMAT_STANDARD = 0,
+    PAYLOAD_FORMAT_COMPACT = 1
+
+} payload_format_t;
+
+// Values in the units of the standard frame, see README
+typedef struct
+{
+    uint8_t header;
+    // Power tier, see power.h, compact keyframes carry it after the values unless it is normal
+    uint8_t tier;
+    uint8_t fields;
+    uint8_t voltage;
+    uint8_t orientation;
+    int16_t temperature;
+    uint8_t humidity;
+    uint16_t illuminance;
+    uint16_t pressure;
+    // Cumulative counter, the standard frame also carries the occupancy of the interval
+    uint32_t pir_motion_count;
+    occupancy_t occupancy;
+    uint16_t co2;
+
+    // Interval statistics, temperature in tenths, standard deviation of temperature in hundredths of degree
+    int16_t temperature_min;
+    int16_t temperature_max;
+    uint8_t temperature_stddev;
+    uint16_t co2_min;
+    uint16_t co2_max;
+    uint16_t co2_stddev;
+
+} payload_t;
+
+void payload_init(void);
+
+void payload_set_format(payload_format_t format);
+
+payload_format_t payload_get_format(void);
+
+// Append the interval statistics to the standard frames
+void payload_set_stats(bool stats);
+
+bool payload_get_stats(void);
+
+// Number of frames between two compact keyframes, keyframe included
+void payload_set_keyframe_interval(uint8_t interval);
+
+uint8_t payload_get_keyframe_interval(void);
+
+// Force the next compact frame to be a keyframe
+void payload_request_keyframe(void);
+
+// Temperature [0.1 °C] of a value in hundredths, -0.1 °C is sent as -0.2 °C as it would read as missing
+int16_t payload_get_temperature(int32_t value);
+
+// Encode in the configured format, returns length of the frame
+size_t payload_encode(const payload_t *payload, uint8_t *buffer, size_t size);
+
+size_t payload_encode_standard(const payload_t *payload, uint8_t *buffer, size_t size);
+
+size_t payload_encode_compact(const payload_t *payload, uint8_t *buffer, size_t size);
+
+#endif // _PAYLOAD_H
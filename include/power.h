@@ -0,0 +1,26 @@
+#ifndef _POWER_H
+#define _POWER_H
+
+#include <twr_tick.h>
+
+typedef enum
+{
+    POWER_TIER_NORMAL = 0,
+    // Intervals doubled, CO2 at its longest interval, LED off, fewer repetitions
+    POWER_TIER_ECO = 1,
+    // Intervals four times as long, CO2 off, LED off, no repetitions beyond those of a good link
+    POWER_TIER_SURVIVAL = 2
+
+} power_tier_t;
+
+// Steps down through the tiers as the battery depletes, so the device keeps reporting instead of browning out under
+// the load of the CO2 sensor and the radio. A tier is entered when the state of charge or the voltage under load
+// falls to its threshold and left only once both are clearly above it again, after the cells were replaced.
+void power_init(void);
+
+// Call after every battery measurement, true if the tier changed
+bool power_update(void);
+
+power_tier_t power_get_tier(void);
+
+#endif // _POWER_H
@@ -0,0 +1,65 @@
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+#include <twr_tick.h>
+
+typedef enum
+{
+    PROFILE_SOURCE_APPLICATION_TASK = 0,
+    PROFILE_SOURCE_BATTERY_MEASURE_TASK = 1,
+    PROFILE_SOURCE_CALIBRATION_TASK = 2,
+    PROFILE_SOURCE_BUTTON = 3,
+    PROFILE_SOURCE_PIR = 4,
+    PROFILE_SOURCE_CO2 = 5,
+    PROFILE_SOURCE_CLIMATE = 6,
+    PROFILE_SOURCE_BATTERY = 7,
+    PROFILE_SOURCE_LIS2DH12 = 8,
+    PROFILE_SOURCE_LORA = 9,
+    PROFILE_SOURCE_MEASURE = 10,
+
+    PROFILE_SOURCE_COUNT
+
+} profile_source_t;
+
+typedef enum
+{
+    PROFILE_PERIPHERAL_THERMOMETER = 0,
+    PROFILE_PERIPHERAL_HYGROMETER = 1,
+    PROFILE_PERIPHERAL_LUX_METER = 2,
+    PROFILE_PERIPHERAL_BAROMETER = 3,
+    PROFILE_PERIPHERAL_CO2 = 4,
+    PROFILE_PERIPHERAL_LIS2DH12 = 5,
+    PROFILE_PERIPHERAL_BATTERY = 6,
+    PROFILE_PERIPHERAL_RADIO = 7,
+
+    PROFILE_PERIPHERAL_COUNT
+
+} profile_peripheral_t;
+
+void profile_init(void);
+
+// Mark the beginning and the end of MCU activity caused by the source, calls may be nested and the time of
+// a nested source is charged to it only, not to the sources around it
+void profile_begin(profile_source_t source);
+void profile_end(profile_source_t source);
+
+// Charge one operation of the peripheral with its typical active time to the source
+void profile_charge(profile_source_t source, profile_peripheral_t peripheral);
+
+// Charge the peripheral for a measured active time to the source
+void profile_charge_ticks(profile_source_t source, profile_peripheral_t peripheral, twr_tick_t active);
+
+// Average current since boot in microamperes
+uint32_t profile_get_average_current(void);
+
+// Charge drawn since boot in microcoulombs, sleep included
+uint64_t profile_get_charge(void);
+
+// Exits from stop mode, activity starting at a later tick than the previous one ended, since boot and in the last hour
+uint32_t profile_get_exits(void);
+
+uint32_t profile_get_exits_last_hour(void);
+
+void profile_print(void);
+
+#endif // _PROFILE_H
@@ -0,0 +1,33 @@
+#ifndef _REPORT_H
+#define _REPORT_H
+
+#include <payload.h>
+#include <twr_tick.h>
+
+#define REPORT_FIELD_COUNT 8
+
+// Report by exception: a periodic update is sent only when some field left its deadband
+// around the last transmitted frame, or when the heartbeat interval has elapsed
+void report_init(void);
+
+void report_set_enabled(bool enabled);
+
+bool report_is_enabled(void);
+
+// Longest time without an uplink
+void report_set_heartbeat(twr_tick_t heartbeat);
+
+twr_tick_t report_get_heartbeat(void);
+
+// Deadband of a single field in the units of the standard frame, see README
+void report_set_deadband(payload_field_t field, uint32_t deadband);
+
+uint32_t report_get_deadband(payload_field_t field);
+
+// True if the periodic update has to be transmitted
+bool report_is_needed(const payload_t *payload);
+
+// Values of the uplink become the references of the deadbands, the heartbeat restarts
+void report_sent(const payload_t *payload);
+
+#endif // _REPORT_H
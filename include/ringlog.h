@@ -0,0 +1,52 @@
+#ifndef _RINGLOG_H
+#define _RINGLOG_H
+
+#include <twr_common.h>
+
+// Packed record in EEPROM: sequence, fields, temperature, humidity, CO2, PIR motions, interval and check byte
+#define RINGLOG_RECORD_SIZE 12
+
+// Control block in front of the records holding the backfill mark
+#define RINGLOG_CONTROL_SIZE 4
+
+// Aggregate of one send interval, values in the units of the standard frame,
+// fields uses PAYLOAD_FIELD_TEMPERATURE, PAYLOAD_FIELD_HUMIDITY and PAYLOAD_FIELD_CO2
+typedef struct
+{
+    uint16_t sequence;
+    uint8_t fields;
+    int16_t temperature;
+    uint8_t humidity;
+    uint16_t co2;
+    uint8_t pir_motion_count;
+    // Minutes the record covers, the send interval changes with the power tier
+    uint16_t interval;
+
+} ringlog_record_t;
+
+// Log in the EEPROM area at address of the given size, the write position is recovered from the records
+void ringlog_init(uint32_t address, size_t size);
+
+// Number of records the area holds
+int ringlog_get_capacity(void);
+
+// Sequence number the next record gets
+uint16_t ringlog_get_sequence(void);
+
+// Appends the record, its sequence number is assigned
+bool ringlog_append(ringlog_record_t *record);
+
+// Reads the record of the sequence number if it is still in the log
+bool ringlog_read(uint16_t sequence, ringlog_record_t *record);
+
+// Oldest sequence number still in the log
+uint16_t ringlog_get_oldest(void);
+
+// Persistent mark of the first record not known to be delivered
+void ringlog_set_mark(uint16_t sequence);
+
+bool ringlog_get_mark(uint16_t *sequence);
+
+void ringlog_clear_mark(void);
+
+#endif // _RINGLOG_H
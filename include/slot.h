@@ -0,0 +1,28 @@
+#ifndef _SLOT_H
+#define _SLOT_H
+
+#include <twr_cmwx1zzabz.h>
+
+// Places the periodic uplinks of every device into its own slot of the send interval. The offset of the slot
+// is derived from the DevEUI, so devices powered on together do not transmit together, and every cycle
+// adds a random jitter on top of it, so two devices sharing a slot do not collide every time.
+void slot_init(twr_cmwx1zzabz_t *lora);
+
+// Longest random delay added to every slot
+void slot_set_jitter(twr_tick_t jitter);
+
+twr_tick_t slot_get_jitter(void);
+
+// Offset of the slot within the interval
+twr_tick_t slot_get_offset(twr_tick_t interval);
+
+// Random delay up to the jitter
+twr_tick_t slot_get_random(void);
+
+// Random delay up to the range, drawn from the same sequence
+twr_tick_t slot_get_random_range(twr_tick_t range);
+
+// Ticks until the next slot of the interval, jitter included
+twr_tick_t slot_get_delay(twr_tick_t interval);
+
+#endif // _SLOT_H
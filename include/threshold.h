@@ -0,0 +1,39 @@
+#ifndef _THRESHOLD_H
+#define _THRESHOLD_H
+
+#include <payload.h>
+#include <twr_tick.h>
+
+#define THRESHOLD_CO2_LEVELS 2
+
+// Evaluates the measurements in the event handlers and requests an immediate uplink through
+// the callback when a CO2 level is crossed, temperature moves away from the last sent value
+// or motion starts after a quiet period. Requests are rate limited by a token bucket.
+void threshold_init(void (*callback)(void));
+
+// CO2 levels in ppm, zero disables the level
+void threshold_set_co2_levels(uint16_t level_1, uint16_t level_2);
+
+void threshold_get_co2_levels(uint16_t *level_1, uint16_t *level_2);
+
+// Temperature change in tenths of degree, zero disables
+void threshold_set_temperature_delta(uint16_t delta);
+
+uint16_t threshold_get_temperature_delta(void);
+
+// Quiet period before a motion starts an uplink, zero disables
+void threshold_set_motion_quiet(twr_tick_t quiet);
+
+twr_tick_t threshold_get_motion_quiet(void);
+
+void threshold_feed_co2(int32_t ppm);
+
+// Temperature in hundredths of degree
+void threshold_feed_temperature(int32_t temperature);
+
+void threshold_feed_motion(void);
+
+// Temperature of the uplink becomes the reference of the delta, the next threshold frame waits the minimum gap
+void threshold_sent(const payload_t *payload);
+
+#endif // _THRESHOLD_H
@@ -0,0 +1,35 @@
+#ifndef _UPLINK_H
+#define _UPLINK_H
+
+#include <twr_cmwx1zzabz.h>
+#include <twr_scheduler.h>
+
+// Lower value has higher priority
+typedef enum
+{
+    UPLINK_CLASS_JOIN = 0,
+    UPLINK_CLASS_ALARM = 1,
+    UPLINK_CLASS_PERIODIC = 2,
+    UPLINK_CLASS_BACKFILL = 3,
+
+    UPLINK_CLASS_COUNT
+
+} uplink_class_t;
+
+// Hands the radio to the tasks sending uplinks. A task that finds the radio busy, or a task of a higher class
+// waiting, returns and is planned again once the radio is free, so nothing polls the radio.
+void uplink_init(twr_cmwx1zzabz_t *lora);
+
+// Task planned when the class gets the radio, several classes may share a task
+void uplink_register(uplink_class_t uplink_class, twr_scheduler_task_id_t task_id);
+
+// True if the radio is free for the class now, otherwise the task of the class is planned later
+bool uplink_acquire(uplink_class_t uplink_class);
+
+// Call when the task acquired the radio and is done, whether it sent or not
+void uplink_release(void);
+
+// Call on every event of the radio
+void uplink_kick(void);
+
+#endif // _UPLINK_H
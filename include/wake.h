@@ -0,0 +1,31 @@
+#ifndef _WAKE_H
+#define _WAKE_H
+
+#include <twr_scheduler.h>
+
+#define WAKE_JOBS 6
+
+// Runs the periodic measurements on a shared grid of ticks instead of a timer each. Every job due at a grid tick,
+// or less than the tolerance after it, runs at that tick back-to-back with the others, so the MCU leaves stop mode
+// once for all of them. Intervals that are not a multiple of the grid are stretched to the next grid tick.
+// The jobs of a tick share one bus session, the system clock the I2C transfers run on is held up until the driver
+// tasks they planned have started their conversions, instead of every transfer starting and stopping it.
+void wake_init(twr_tick_t grid, twr_tick_t tolerance);
+
+// Restarts the grid from now, the jobs keep their last run
+void wake_set_grid(twr_tick_t grid, twr_tick_t tolerance);
+
+twr_tick_t wake_get_grid(void);
+
+twr_tick_t wake_get_tolerance(void);
+
+// Job runs first at the next grid tick, returns its id or -1 if there is no room
+int wake_register(void (*job)(void *), void *param, twr_tick_t interval);
+
+// Interval counts from the last run of the job, TWR_TICK_INFINITY stops it
+void wake_set_interval(int id, twr_tick_t interval);
+
+// Job runs once more at the first grid tick at least the delay from now
+void wake_schedule(int id, twr_tick_t delay);
+
+#endif // _WAKE_H
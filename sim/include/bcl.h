@@ -0,0 +1,6 @@
+#ifndef _BCL_H
+#define _BCL_H
+
+#include <twr.h>
+
+#endif // _BCL_H
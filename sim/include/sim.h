@@ -0,0 +1,195 @@
+#ifndef _SIM_H
+#define _SIM_H
+
+#include <twr.h>
+
+#define SIM_DAY (24ULL * 60 * 60 * 1000)
+
+typedef struct
+{
+    void (*task)(void *);
+    const char *name;
+    uint64_t calls;
+    uint64_t cpu_ns;
+
+} sim_task_stats_t;
+
+typedef struct
+{
+    uint64_t uplinks;
+    uint64_t confirmed_uplinks;
+    uint64_t payload_bytes;
+    uint64_t phy_bytes;
+    uint64_t airtime_ms;
+    uint64_t downlinks;
+    uint64_t joins;
+    uint64_t lost_uplinks;
+    uint64_t link_checks;
+    uint64_t refused_uplinks;
+
+} sim_radio_stats_t;
+
+#define SIM_I2C_CHANNELS 2
+
+typedef struct
+{
+    uint64_t transfers;
+    // Starts of the bus clock, transfers while it is held up share one
+    uint64_t sessions;
+
+} sim_i2c_stats_t;
+
+// Scheduler and virtual clock
+
+void sim_scheduler_run_until(twr_tick_t tick);
+
+void sim_scheduler_set_tick(twr_tick_t tick);
+
+uint64_t sim_scheduler_get_wakeups(void);
+
+int sim_scheduler_get_task_stats(sim_task_stats_t *stats, int length);
+
+void sim_scheduler_set_task_name(twr_scheduler_task_id_t task_id, const char *name);
+
+// Generic periodic sensor driver: start conversion, wait, deliver result
+
+typedef struct
+{
+    const char *name;
+    twr_tick_t interval;
+    twr_tick_t conversion;
+    twr_tick_t start;
+    bool measuring;
+    twr_scheduler_task_id_t task_id;
+    // Bus the conversion is started and read out on, -1 if none
+    int i2c_channel;
+    void (*done)(void *param);
+    void *param;
+
+} sim_sensor_t;
+
+void sim_sensor_init(sim_sensor_t *self, const char *name, twr_tick_t conversion, void (*done)(void *), void *param);
+
+void sim_sensor_set_update_interval(sim_sensor_t *self, twr_tick_t interval);
+
+bool sim_sensor_measure(sim_sensor_t *self);
+
+void sim_sensor_set_i2c_channel(sim_sensor_t *self, twr_i2c_channel_t channel);
+
+// I2C bus, one call per transfer
+
+void sim_i2c_transfer(twr_i2c_channel_t channel);
+
+void sim_i2c_get_stats(twr_i2c_channel_t channel, sim_i2c_stats_t *stats);
+
+// Environment model
+
+void sim_env_init(uint32_t seed);
+
+uint32_t sim_env_rand(void);
+
+// Spurious CO2 readings and illuminance drops per thousand samples
+void sim_env_set_glitch(uint32_t permille);
+
+float sim_env_get_temperature(twr_tick_t tick);
+
+float sim_env_get_humidity(twr_tick_t tick);
+
+float sim_env_get_illuminance(twr_tick_t tick);
+
+float sim_env_get_pressure(twr_tick_t tick);
+
+float sim_env_get_co2(twr_tick_t tick);
+
+float sim_env_get_voltage(twr_tick_t tick);
+
+bool sim_env_is_occupied(twr_tick_t tick);
+
+// Recorded trace replayed instead of the synthetic room, streams it lacks keep the model
+
+typedef enum
+{
+    SIM_TRACE_TEMPERATURE = 0,
+    SIM_TRACE_HUMIDITY = 1,
+    SIM_TRACE_ILLUMINANCE = 2,
+    SIM_TRACE_PRESSURE = 3,
+    SIM_TRACE_CO2 = 4,
+    SIM_TRACE_VOLTAGE = 5,
+    // Events, PIR motion and the unit turned over
+    SIM_TRACE_MOTION = 6,
+    SIM_TRACE_MOVE = 7,
+    SIM_TRACE_STREAMS = 8
+
+} sim_trace_stream_t;
+
+bool sim_trace_load(const char *path);
+
+bool sim_trace_is_loaded(void);
+
+// End of the last row of the trace
+twr_tick_t sim_trace_get_end(void);
+
+// Value of the stream recorded last at or before the tick, false if the trace has none
+bool sim_trace_get(sim_trace_stream_t stream, twr_tick_t tick, float *value);
+
+// First event of the stream at or after the tick
+twr_tick_t sim_trace_next_event(sim_trace_stream_t stream, twr_tick_t tick);
+
+// Peripherals
+
+void sim_button_event(twr_button_event_t event);
+
+// Turns the unit from the wall onto its back or back, raises the alarm if one is set
+void sim_accelerometer_move(void);
+
+uint32_t sim_radio_airtime(uint8_t datarate, size_t length);
+
+void sim_radio_get_stats(sim_radio_stats_t *stats);
+
+// True while an uplink is on air
+bool sim_radio_is_transmitting(void);
+
+void sim_radio_queue_downlink(uint8_t port, const uint8_t *data, size_t length);
+
+// Print every uplink with its port as it goes on air
+void sim_radio_set_verbose(bool verbose);
+
+// Network outage, uplinks are lost and link checks fail between start and end
+void sim_radio_set_outage(twr_tick_t start, twr_tick_t end);
+
+// Mean SNR [dB] at the gateway, a transmission is lost below the demodulation floor of its data rate
+void sim_radio_set_snr(int32_t snr);
+
+bool sim_atci_execute(const char *line);
+
+void sim_atci_set_quiet(bool quiet);
+
+void sim_print_tick(FILE *stream, twr_tick_t tick);
+
+// Reset of the MCU, the process starts over at the current tick. The EEPROM, the environment and the radio module
+// keep their state, a brownout also costs the module its session.
+void sim_reboot(bool brownout);
+
+// State kept over a reboot, loaded in the order it was saved
+
+void sim_system_save(FILE *file);
+
+bool sim_system_load(FILE *file);
+
+void sim_scheduler_save(FILE *file);
+
+bool sim_scheduler_load(FILE *file);
+
+void sim_env_save(FILE *file);
+
+bool sim_env_load(FILE *file);
+
+void sim_accelerometer_save(FILE *file);
+
+bool sim_accelerometer_load(FILE *file);
+
+void sim_radio_save(FILE *file, bool brownout);
+
+bool sim_radio_load(FILE *file);
+
+#endif // _SIM_H
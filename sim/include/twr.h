@@ -0,0 +1,28 @@
+#ifndef _TWR_H
+#define _TWR_H
+
+// Host simulation replacement of the HARDWARIO TOWER SDK umbrella header.
+// Only the parts of the SDK used by this firmware are provided.
+
+#include <twr_common.h>
+#include <twr_tick.h>
+#include <twr_scheduler.h>
+#include <twr_system.h>
+#include <twr_timer.h>
+#include <twr_eeprom.h>
+#include <twr_data_stream.h>
+#include <twr_gpio.h>
+#include <twr_i2c.h>
+#include <twr_uart.h>
+#include <twr_led.h>
+#include <twr_button.h>
+#include <twr_module_climate.h>
+#include <twr_module_co2.h>
+#include <twr_module_pir.h>
+#include <twr_module_battery.h>
+#include <twr_lis2dh12.h>
+#include <twr_dice.h>
+#include <twr_cmwx1zzabz.h>
+#include <twr_atci.h>
+
+#endif // _TWR_H
@@ -0,0 +1,29 @@
+#ifndef _TWR_BUTTON_H
+#define _TWR_BUTTON_H
+
+#include <twr_gpio.h>
+
+typedef enum
+{
+    TWR_BUTTON_EVENT_PRESS = 0,
+    TWR_BUTTON_EVENT_RELEASE = 1,
+    TWR_BUTTON_EVENT_CLICK = 2,
+    TWR_BUTTON_EVENT_HOLD = 3
+
+} twr_button_event_t;
+
+typedef struct twr_button_t twr_button_t;
+
+struct twr_button_t
+{
+    twr_gpio_channel_t _channel;
+    void (*_event_handler)(twr_button_t *, twr_button_event_t, void *);
+    void *_event_param;
+
+};
+
+void twr_button_init(twr_button_t *self, twr_gpio_channel_t gpio_channel, twr_gpio_pull_t gpio_pull, int idle_state);
+
+void twr_button_set_event_handler(twr_button_t *self, void (*event_handler)(twr_button_t *, twr_button_event_t, void *), void *event_param);
+
+#endif // _TWR_BUTTON_H
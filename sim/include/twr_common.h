@@ -0,0 +1,14 @@
+#ifndef _TWR_COMMON_H
+#define _TWR_COMMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define TWR_ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+#endif // _TWR_COMMON_H
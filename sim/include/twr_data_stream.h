@@ -0,0 +1,75 @@
+#ifndef _TWR_DATA_STREAM_H
+#define _TWR_DATA_STREAM_H
+
+#include <twr_common.h>
+
+#define TWR_DATA_STREAM_FLOAT_BUFFER(NAME, NUMBER_OF_SAMPLES) \
+    float NAME##_feed[NUMBER_OF_SAMPLES]; \
+    float NAME##_sort[NUMBER_OF_SAMPLES]; \
+    twr_data_stream_buffer_t NAME = { \
+        .feed = NAME##_feed, \
+        .sort = NAME##_sort, \
+        .number_of_samples = NUMBER_OF_SAMPLES, \
+        .type = TWR_DATA_STREAM_TYPE_FLOAT };
+
+#define TWR_DATA_STREAM_INT_BUFFER(NAME, NUMBER_OF_SAMPLES) \
+    int NAME##_feed[NUMBER_OF_SAMPLES]; \
+    int NAME##_sort[NUMBER_OF_SAMPLES]; \
+    twr_data_stream_buffer_t NAME = { \
+        .feed = NAME##_feed, \
+        .sort = NAME##_sort, \
+        .number_of_samples = NUMBER_OF_SAMPLES, \
+        .type = TWR_DATA_STREAM_TYPE_INT };
+
+typedef enum
+{
+    TWR_DATA_STREAM_TYPE_FLOAT = 0,
+    TWR_DATA_STREAM_TYPE_INT = 1
+
+} twr_data_stream_type_t;
+
+typedef struct
+{
+    void *feed;
+    void *sort;
+    int number_of_samples;
+    twr_data_stream_type_t type;
+
+} twr_data_stream_buffer_t;
+
+typedef struct
+{
+    twr_data_stream_buffer_t *_buffer;
+    int _counter;
+    int _feed_head;
+    int _min_number_of_samples;
+
+} twr_data_stream_t;
+
+void twr_data_stream_init(twr_data_stream_t *self, int min_number_of_samples, twr_data_stream_buffer_t *buffer);
+
+void twr_data_stream_feed(twr_data_stream_t *self, void *data);
+
+void twr_data_stream_reset(twr_data_stream_t *self);
+
+int twr_data_stream_get_counter(twr_data_stream_t *self);
+
+int twr_data_stream_get_length(twr_data_stream_t *self);
+
+twr_data_stream_type_t twr_data_stream_get_type(twr_data_stream_t *self);
+
+int twr_data_stream_get_number_of_samples(twr_data_stream_t *self);
+
+bool twr_data_stream_get_average(twr_data_stream_t *self, void *result);
+
+bool twr_data_stream_get_median(twr_data_stream_t *self, void *result);
+
+bool twr_data_stream_get_first(twr_data_stream_t *self, void *result);
+
+bool twr_data_stream_get_last(twr_data_stream_t *self, void *result);
+
+bool twr_data_stream_get_max(twr_data_stream_t *self, void *result);
+
+bool twr_data_stream_get_min(twr_data_stream_t *self, void *result);
+
+#endif // _TWR_DATA_STREAM_H
@@ -0,0 +1,33 @@
+#ifndef _TWR_DICE_H
+#define _TWR_DICE_H
+
+#include <twr_common.h>
+
+typedef enum
+{
+    TWR_DICE_FACE_UNKNOWN = 0,
+    TWR_DICE_FACE_1 = 1,
+    TWR_DICE_FACE_2 = 2,
+    TWR_DICE_FACE_3 = 3,
+    TWR_DICE_FACE_4 = 4,
+    TWR_DICE_FACE_5 = 5,
+    TWR_DICE_FACE_6 = 6
+
+} twr_dice_face_t;
+
+typedef struct
+{
+    twr_dice_face_t _face;
+    float _threshold;
+
+} twr_dice_t;
+
+void twr_dice_init(twr_dice_t *self, twr_dice_face_t start);
+
+void twr_dice_set_threshold(twr_dice_t *self, float threshold);
+
+void twr_dice_feed_vectors(twr_dice_t *self, float x_axis, float y_axis, float z_axis);
+
+twr_dice_face_t twr_dice_get_face(twr_dice_t *self);
+
+#endif // _TWR_DICE_H
@@ -0,0 +1,12 @@
+#ifndef _TWR_EEPROM_H
+#define _TWR_EEPROM_H
+
+#include <twr_common.h>
+
+bool twr_eeprom_write(uint32_t address, const void *buffer, size_t length);
+
+bool twr_eeprom_read(uint32_t address, void *buffer, size_t length);
+
+size_t twr_eeprom_get_size(void);
+
+#endif // _TWR_EEPROM_H
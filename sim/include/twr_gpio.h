@@ -0,0 +1,25 @@
+#ifndef _TWR_GPIO_H
+#define _TWR_GPIO_H
+
+#include <twr_common.h>
+
+typedef enum
+{
+    TWR_GPIO_P0 = 0,
+    TWR_GPIO_P1, TWR_GPIO_P2, TWR_GPIO_P3, TWR_GPIO_P4, TWR_GPIO_P5, TWR_GPIO_P6, TWR_GPIO_P7,
+    TWR_GPIO_P8, TWR_GPIO_P9, TWR_GPIO_P10, TWR_GPIO_P11, TWR_GPIO_P12, TWR_GPIO_P13, TWR_GPIO_P14,
+    TWR_GPIO_P15, TWR_GPIO_P16, TWR_GPIO_P17,
+    TWR_GPIO_LED,
+    TWR_GPIO_BUTTON
+
+} twr_gpio_channel_t;
+
+typedef enum
+{
+    TWR_GPIO_PULL_NONE = 0,
+    TWR_GPIO_PULL_UP = 1,
+    TWR_GPIO_PULL_DOWN = 2
+
+} twr_gpio_pull_t;
+
+#endif // _TWR_GPIO_H
@@ -0,0 +1,14 @@
+#ifndef _TWR_I2C_H
+#define _TWR_I2C_H
+
+#include <twr_common.h>
+
+typedef enum
+{
+    TWR_I2C_I2C0 = 0,
+    TWR_I2C_I2C1 = 1,
+    TWR_I2C_I2C_1W = 2
+
+} twr_i2c_channel_t;
+
+#endif // _TWR_I2C_H
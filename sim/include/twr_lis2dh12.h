@@ -0,0 +1,86 @@
+#ifndef _TWR_LIS2DH12_H
+#define _TWR_LIS2DH12_H
+
+#include <twr_i2c.h>
+#include <twr_tick.h>
+
+typedef enum
+{
+    TWR_LIS2DH12_EVENT_ERROR = 0,
+    TWR_LIS2DH12_EVENT_UPDATE = 1,
+    TWR_LIS2DH12_EVENT_ALARM = 2
+
+} twr_lis2dh12_event_t;
+
+typedef enum
+{
+    TWR_LIS2DH12_RESOLUTION_8BIT = 0,
+    TWR_LIS2DH12_RESOLUTION_10BIT = 1,
+    TWR_LIS2DH12_RESOLUTION_12BIT = 2
+
+} twr_lis2dh12_resolution_t;
+
+typedef enum
+{
+    TWR_LIS2DH12_SCALE_2G = 0,
+    TWR_LIS2DH12_SCALE_4G = 1,
+    TWR_LIS2DH12_SCALE_8G = 2,
+    TWR_LIS2DH12_SCALE_16G = 3
+
+} twr_lis2dh12_scale_t;
+
+typedef struct
+{
+    float x_axis;
+    float y_axis;
+    float z_axis;
+
+} twr_lis2dh12_result_g_t;
+
+typedef struct
+{
+    float threshold;
+    twr_tick_t duration;
+    bool x_low;
+    bool x_high;
+    bool y_low;
+    bool y_high;
+    bool z_low;
+    bool z_high;
+
+} twr_lis2dh12_alarm_t;
+
+typedef struct twr_lis2dh12_t twr_lis2dh12_t;
+
+struct twr_lis2dh12_t
+{
+    twr_i2c_channel_t _i2c_channel;
+    uint8_t _i2c_address;
+    void (*_event_handler)(twr_lis2dh12_t *, twr_lis2dh12_event_t, void *);
+    void *_event_param;
+    twr_tick_t _update_interval;
+    twr_lis2dh12_resolution_t _resolution;
+    twr_lis2dh12_scale_t _scale;
+    bool _alarm_active;
+    twr_lis2dh12_alarm_t _alarm;
+    size_t _task_id;
+
+};
+
+bool twr_lis2dh12_init(twr_lis2dh12_t *self, twr_i2c_channel_t i2c_channel, uint8_t i2c_address);
+
+void twr_lis2dh12_set_event_handler(twr_lis2dh12_t *self, void (*event_handler)(twr_lis2dh12_t *, twr_lis2dh12_event_t, void *), void *event_param);
+
+void twr_lis2dh12_set_update_interval(twr_lis2dh12_t *self, twr_tick_t interval);
+
+bool twr_lis2dh12_measure(twr_lis2dh12_t *self);
+
+bool twr_lis2dh12_get_result_g(twr_lis2dh12_t *self, twr_lis2dh12_result_g_t *result_g);
+
+bool twr_lis2dh12_set_alarm(twr_lis2dh12_t *self, twr_lis2dh12_alarm_t *alarm);
+
+bool twr_lis2dh12_set_resolution(twr_lis2dh12_t *self, twr_lis2dh12_resolution_t resolution);
+
+bool twr_lis2dh12_set_scale(twr_lis2dh12_t *self, twr_lis2dh12_scale_t scale);
+
+#endif // _TWR_LIS2DH12_H
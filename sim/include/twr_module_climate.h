@@ -0,0 +1,51 @@
+#ifndef _TWR_MODULE_CLIMATE_H
+#define _TWR_MODULE_CLIMATE_H
+
+#include <twr_tick.h>
+
+typedef enum
+{
+    TWR_MODULE_CLIMATE_EVENT_ERROR_THERMOMETER = 0,
+    TWR_MODULE_CLIMATE_EVENT_UPDATE_THERMOMETER = 1,
+    TWR_MODULE_CLIMATE_EVENT_ERROR_HYGROMETER = 2,
+    TWR_MODULE_CLIMATE_EVENT_UPDATE_HYGROMETER = 3,
+    TWR_MODULE_CLIMATE_EVENT_ERROR_LUX_METER = 4,
+    TWR_MODULE_CLIMATE_EVENT_UPDATE_LUX_METER = 5,
+    TWR_MODULE_CLIMATE_EVENT_ERROR_BAROMETER = 6,
+    TWR_MODULE_CLIMATE_EVENT_UPDATE_BAROMETER = 7
+
+} twr_module_climate_event_t;
+
+bool twr_module_climate_init(void);
+
+void twr_module_climate_set_event_handler(void (*event_handler)(twr_module_climate_event_t, void *), void *event_param);
+
+void twr_module_climate_set_update_interval(twr_tick_t interval);
+
+void twr_module_climate_set_update_interval_thermometer(twr_tick_t interval);
+
+void twr_module_climate_set_update_interval_hygrometer(twr_tick_t interval);
+
+void twr_module_climate_set_update_interval_lux_meter(twr_tick_t interval);
+
+void twr_module_climate_set_update_interval_barometer(twr_tick_t interval);
+
+bool twr_module_climate_measure_all_sensors(void);
+
+bool twr_module_climate_measure_thermometer(void);
+
+bool twr_module_climate_measure_hygrometer(void);
+
+bool twr_module_climate_measure_lux_meter(void);
+
+bool twr_module_climate_measure_barometer(void);
+
+bool twr_module_climate_get_temperature_celsius(float *celsius);
+
+bool twr_module_climate_get_humidity_percentage(float *percentage);
+
+bool twr_module_climate_get_illuminance_lux(float *lux);
+
+bool twr_module_climate_get_pressure_pascal(float *pascal);
+
+#endif // _TWR_MODULE_CLIMATE_H
@@ -0,0 +1,34 @@
+#ifndef _TWR_MODULE_CO2_H
+#define _TWR_MODULE_CO2_H
+
+#include <twr_tick.h>
+
+typedef enum
+{
+    TWR_LP8_CALIBRATION_ABC_RF = 0x70,
+    TWR_LP8_CALIBRATION_ABC = 0x72,
+    TWR_LP8_CALIBRATION_BACKGROUND_FILTERED = 0x7c,
+    TWR_LP8_CALIBRATION_BACKGROUND_UNFILTERED = 0x7d
+
+} twr_lp8_calibration_t;
+
+typedef enum
+{
+    TWR_MODULE_CO2_EVENT_ERROR = 0,
+    TWR_MODULE_CO2_EVENT_UPDATE = 1
+
+} twr_module_co2_event_t;
+
+void twr_module_co2_init(void);
+
+void twr_module_co2_set_event_handler(void (*event_handler)(twr_module_co2_event_t, void *), void *event_param);
+
+void twr_module_co2_set_update_interval(twr_tick_t interval);
+
+void twr_module_co2_measure(void);
+
+bool twr_module_co2_get_concentration_ppm(float *ppm);
+
+void twr_module_co2_calibration(twr_lp8_calibration_t calibration);
+
+#endif // _TWR_MODULE_CO2_H
@@ -0,0 +1,38 @@
+#ifndef _TWR_MODULE_PIR_H
+#define _TWR_MODULE_PIR_H
+
+#include <twr_common.h>
+
+typedef enum
+{
+    TWR_MODULE_PIR_EVENT_ERROR = 0,
+    TWR_MODULE_PIR_EVENT_MOTION = 1
+
+} twr_module_pir_event_t;
+
+typedef enum
+{
+    TWR_MODULE_PIR_SENSITIVITY_LOW = 0,
+    TWR_MODULE_PIR_SENSITIVITY_MEDIUM = 1,
+    TWR_MODULE_PIR_SENSITIVITY_HIGH = 2,
+    TWR_MODULE_PIR_SENSITIVITY_VERY_HIGH = 3
+
+} twr_module_pir_sensitivity_t;
+
+typedef struct twr_module_pir_t twr_module_pir_t;
+
+struct twr_module_pir_t
+{
+    void (*_event_handler)(twr_module_pir_t *, twr_module_pir_event_t, void *);
+    void *_event_param;
+    twr_module_pir_sensitivity_t _sensitivity;
+
+};
+
+void twr_module_pir_init(twr_module_pir_t *self);
+
+void twr_module_pir_set_event_handler(twr_module_pir_t *self, void (*event_handler)(twr_module_pir_t *, twr_module_pir_event_t, void *), void *event_param);
+
+void twr_module_pir_set_sensitivity(twr_module_pir_t *self, twr_module_pir_sensitivity_t sensitivity);
+
+#endif // _TWR_MODULE_PIR_H
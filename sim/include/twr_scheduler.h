@@ -0,0 +1,44 @@
+#ifndef _TWR_SCHEDULER_H
+#define _TWR_SCHEDULER_H
+
+#include <twr_tick.h>
+
+#ifndef TWR_SCHEDULER_MAX_TASKS
+#define TWR_SCHEDULER_MAX_TASKS 32
+#endif
+
+typedef size_t twr_scheduler_task_id_t;
+
+void twr_scheduler_init(void);
+
+void twr_scheduler_run(void);
+
+twr_scheduler_task_id_t twr_scheduler_register(void (*task)(void *), void *param, twr_tick_t tick);
+
+void twr_scheduler_unregister(twr_scheduler_task_id_t task_id);
+
+twr_scheduler_task_id_t twr_scheduler_get_current_task_id(void);
+
+twr_tick_t twr_scheduler_get_spin_tick(void);
+
+void twr_scheduler_disable_sleep(void);
+
+void twr_scheduler_enable_sleep(void);
+
+void twr_scheduler_plan_now(twr_scheduler_task_id_t task_id);
+
+void twr_scheduler_plan_absolute(twr_scheduler_task_id_t task_id, twr_tick_t tick);
+
+void twr_scheduler_plan_relative(twr_scheduler_task_id_t task_id, twr_tick_t tick);
+
+void twr_scheduler_plan_from_now(twr_scheduler_task_id_t task_id, twr_tick_t tick);
+
+void twr_scheduler_plan_current_now(void);
+
+void twr_scheduler_plan_current_absolute(twr_tick_t tick);
+
+void twr_scheduler_plan_current_relative(twr_tick_t tick);
+
+void twr_scheduler_plan_current_from_now(twr_tick_t tick);
+
+#endif // _TWR_SCHEDULER_H
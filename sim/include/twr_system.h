@@ -0,0 +1,14 @@
+#ifndef _TWR_SYSTEM_H
+#define _TWR_SYSTEM_H
+
+#include <twr_common.h>
+
+void twr_system_init(void);
+
+void twr_system_reset(void);
+
+void twr_system_pll_enable(void);
+
+void twr_system_pll_disable(void);
+
+#endif // _TWR_SYSTEM_H
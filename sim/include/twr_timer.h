@@ -0,0 +1,14 @@
+#ifndef _TWR_TIMER_H
+#define _TWR_TIMER_H
+
+#include <twr_common.h>
+
+void twr_timer_init(void);
+
+void twr_timer_start(void);
+
+uint16_t twr_timer_get_microseconds(void);
+
+void twr_timer_stop(void);
+
+#endif // _TWR_TIMER_H
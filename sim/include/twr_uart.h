@@ -0,0 +1,14 @@
+#ifndef _TWR_UART_H
+#define _TWR_UART_H
+
+#include <twr_common.h>
+
+typedef enum
+{
+    TWR_UART_UART0 = 0,
+    TWR_UART_UART1 = 1,
+    TWR_UART_UART2 = 2
+
+} twr_uart_channel_t;
+
+#endif // _TWR_UART_H
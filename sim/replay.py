@@ -0,0 +1,446 @@
+#!/usr/bin/env python3
+"""Replays recorded sensor traces through the firmware in the simulation.
+
+Every uplink is decoded with decode.py and ttn.js, the two have to agree and the
+decoded values have to fall within what the trace recorded since the previous update.
+Synthetic frames cover the values the traces do not reach, a synthetic step the filter, a reset and a brownout the resumed session.
+The uplinks, bytes, airtime and wake-ups per day of the default configuration are compared
+with the baseline next to the trace, more than the tolerance above it fails the run.
+Options after the traces go to the simulation, e.g. -c 0:AT$PAYLOAD=1 to check another format.
+"""
+import csv
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SIM = os.environ.get('SIM', os.path.join(ROOT, 'sim', 'out', 'sim'))
+
+sys.path.insert(0, ROOT)
+
+import decode  # noqa: E402
+
+# Relative increase of a baseline metric that fails the run
+TOLERANCE = 0.02
+
+# Fields checked against the trace: trace column, resolution of the encoding, minutes the
+# filter and the aggregation can look back before the previous update
+RANGES = (
+    ('temperature', 'temperature', 0.1, 10),
+    ('humidity', 'humidity', 0.5, 10),
+    ('illuminance', 'illuminance', 1, 10),
+    ('pressure', 'pressure', 2, 60),
+    ('co2', 'co2', 1, 120),
+    ('voltage', 'voltage', 0.1, 60),
+)
+
+# The trace holds the voltage at rest, uplinks carry the one measured during the transmission
+LOAD_DROP = {'voltage': 0.5}
+
+# Fields compared between decode.py and ttn.js
+SHARED = ('header', 'tier', 'voltage', 'orientation', 'tamper', 'temperature', 'humidity', 'illuminance', 'pressure', 'co2',
+          'pir_motion_count', 'occupancy', 'sequence', 'snapshots', 'records', 'ack')
+
+METRICS = ('uplinks', 'payload bytes', 'airtime ms', 'wake-ups')
+
+# Frames with values no trace reaches in the same frame, negative, zero and missing temperatures, standard frames with
+# and without the occupancy of the earlier firmware: data and the temperature of the frame or of its snapshots
+FRAMES = (
+    ('013c01fff6640000c1be0000002a019003010006', (-1.0,)),
+    ('013c010000640000c1be000500000190', (0.0,)),
+    ('013c01ffff640000c1be000500000190', (None,)),
+    ('043c010000c1be03' '0afff664019000' '05000064019000' '00ffff64019000', (-1.0, 0.0, None)),
+)
+
+TTN_HARNESS = """
+var vm = require('vm');
+var fs = require('fs');
+var context = {};
+vm.runInNewContext(fs.readFileSync(process.argv[1], 'utf8'), context);
+var frames = JSON.parse(fs.readFileSync(0, 'utf8'));
+console.log(JSON.stringify(frames.map(function (f) {
+  var bytes = [];
+  for (var i = 0; i < f[1].length; i += 2) {
+    bytes.push(parseInt(f[1].substr(i, 2), 16));
+  }
+  return context.Decoder(bytes, f[0]);
+})));
+"""
+
+TICK = re.compile(r'^\[\s*(\d+)d (\d+):(\d+):(\d+)\.(\d+)\] ')
+
+
+def parse_minute(line):
+    m = TICK.match(line)
+    if m is None:
+        return None
+    days, hours, minutes, seconds, millis = (int(v) for v in m.groups())
+    return ((days * 24 + hours) * 60 + minutes) + (seconds + millis / 1000.0) / 60.0
+
+
+def load_trace(path):
+    levels = {}
+    motions = []
+    moves = []
+
+    with open(path) as f:
+        for row in csv.DictReader(f):
+            minute = float(row['minute'])
+            for column, value in row.items():
+                if column == 'minute' or value in (None, ''):
+                    continue
+                if column == 'motion':
+                    # Spread over the minute like the simulation does
+                    motions.extend(minute + (2 * i + 1) / (2.0 * int(value)) for i in range(int(value)))
+                elif column == 'move':
+                    moves.append(minute)
+                else:
+                    levels.setdefault(column, []).append((minute, float(value)))
+
+    return levels, motions, moves
+
+
+def level_range(samples, start, end):
+    # Value held at the start and every value recorded until the end
+    values = [v for m, v in samples if start < m <= end]
+    held = [v for m, v in samples if m <= start]
+    if held:
+        values.append(held[-1])
+    if not values:
+        return None
+    return min(values), max(values)
+
+
+def run_sim(trace, args):
+    output = subprocess.check_output([SIM, '-q', '-u', '-t', trace] + args, universal_newlines=True)
+
+    uplinks = []
+    report = {}
+    tasks = {}
+    in_tasks = False
+
+    for line in output.splitlines():
+        minute = parse_minute(line)
+        if minute is not None:
+            fields = line[line.index('] ') + 2:].split()
+            if fields[0] == 'UPLINK':
+                uplinks.append({'minute': minute, 'port': int(fields[1]), 'data': fields[2],
+                                'lost': len(fields) > 3})
+            continue
+
+        if line.startswith('task '):
+            in_tasks = True
+            continue
+
+        fields = line.rsplit(None, 4) if in_tasks else re.split(r'\s{2,}', line.strip())
+
+        if in_tasks and len(fields) == 5:
+            tasks[fields[0].strip()] = {'calls': int(fields[1]), 'cpu_us': float(fields[3])}
+        elif not in_tasks and len(fields) >= 3 and fields[0] in METRICS:
+            report[fields[0]] = float(fields[2].split()[0])
+
+    return uplinks, report, tasks
+
+
+def decode_uplinks(uplinks):
+    keyframes = {}
+
+    for uplink in uplinks:
+        data = uplink['data']
+        header = int(data[0:2], 16)
+        keyframe = None
+
+        if header & decode.HEADER_COMPACT:
+            sequence = (header >> 4) & 0x03
+            if header & decode.HEADER_KEYFRAME:
+                keyframes[sequence] = data
+            keyframe = keyframes.get(sequence)
+
+        uplink['decoded'] = decode.decode(data, keyframe)
+
+
+def decode_ttn(uplinks):
+    node = shutil.which('node') or shutil.which('nodejs')
+
+    if node is None:
+        return None
+
+    frames = json.dumps([[u['port'], u['data']] for u in uplinks])
+
+    output = subprocess.check_output([node, '-e', TTN_HARNESS, os.path.join(ROOT, 'ttn.js')],
+                                     input=frames, universal_newlines=True)
+
+    return json.loads(output)
+
+
+def same(a, b):
+    if isinstance(a, dict) and isinstance(b, dict):
+        return all(same(a[k], b.get(k)) for k in a)
+    if isinstance(a, list) and isinstance(b, list):
+        return len(a) == len(b) and all(same(x, y) for x, y in zip(a, b))
+    if isinstance(a, (int, float)) and isinstance(b, (int, float)) and not isinstance(a, bool):
+        return abs(a - b) < 1e-6
+    return a == b
+
+
+def check_ttn(uplinks, decoded, errors):
+    for uplink, ttn in zip(uplinks, decoded):
+        ours = uplink['decoded']
+
+        # Delta frames of the compact format are left to the application in ttn.js
+        if int(uplink['data'][0:2], 16) & decode.HEADER_COMPACT:
+            if not int(uplink['data'][0:2], 16) & decode.HEADER_KEYFRAME:
+                continue
+            ours = dict(ours, header=int(uplink['data'][0:2], 16) & 0x07)
+        elif 'header' in ours:
+            ours = dict(ours, header=int(uplink["data"][0:2], 16) & ~(decode.HEADER_ACK | decode.HEADER_TIER))
+
+        for name in SHARED:
+            if name in ours and not same(ours[name], ttn.get(name)):
+                errors.append('%s: %s differs, decode.py %r, ttn.js %r' % (
+                    uplink['data'], name, ours[name], ttn.get(name)))
+
+
+def check_values(uplinks, levels, motions, moves, errors):
+    previous = 0.0
+
+    for uplink in uplinks:
+        decoded = uplink['decoded']
+        header = decoded.get('header')
+
+        if 'snapshots' in decoded or 'records' in decoded or header not in ('UPDATE', 'THRESHOLD', 'BUTTON_CLICK',
+                                                                             'BUTTON_HOLD'):
+            continue
+
+        end = uplink['minute']
+
+        for field, column, resolution, lookback in RANGES:
+            value = decoded.get(field)
+            if value is None or column not in levels:
+                continue
+            bounds = level_range(levels[column], previous - lookback, end)
+            if bounds is None:
+                continue
+            if not bounds[0] - resolution - LOAD_DROP.get(field, 0) <= value <= bounds[1] + resolution:
+                errors.append('%s at minute %.1f: %s %s outside the trace range %s - %s' % (
+                    uplink['data'], end, field, value, bounds[0], bounds[1]))
+
+        occupancy = decoded.get('occupancy')
+        if occupancy is not None:
+            # Every occupied minute of the interval holds at least one motion
+            count = sum(1 for m in motions if previous < m <= end)
+            if occupancy['minutes'] > count or (occupancy['minutes'] == 0) != (occupancy['bitmap'] == 0):
+                errors.append('%s at minute %.1f: %d occupied minutes, bitmap %04x, the trace has %d motions' % (
+                    uplink['data'], end, occupancy['minutes'], occupancy['bitmap'], count))
+
+        if decoded.get('tamper') and not any(previous - 1 < m <= end for m in moves):
+            errors.append('%s at minute %.1f: tamper without a move in the trace' % (uplink['data'], end))
+
+        if header == 'UPDATE':
+            previous = end
+
+
+def check_baseline(path, metrics, update, errors):
+    if update or not os.path.exists(path):
+        with open(path, 'w') as f:
+            json.dump(metrics, f, indent=4, sort_keys=True)
+            f.write('\n')
+        print('baseline written to %s' % os.path.relpath(path, ROOT))
+        return
+
+    with open(path) as f:
+        baseline = json.load(f)
+
+    for name, value in sorted(metrics.items()):
+        reference = baseline.get(name)
+        if reference is None:
+            continue
+        change = (value - reference) / reference if reference else 0.0
+        print('%-24s %10.1f  baseline %10.1f  %+6.1f %%' % (name, value, reference, change * 100))
+        if change > TOLERANCE:
+            errors.append('%s %.1f exceeds the baseline %.1f' % (name, value, reference))
+
+
+def check_frames():
+    print('# synthetic frames')
+
+    uplinks = [{'port': 2, 'data': data} for data, _ in FRAMES]
+    errors = []
+
+    for uplink, (data, expected) in zip(uplinks, FRAMES):
+        decoded = uplink['decoded'] = decode.decode(data)
+        found = tuple(s['temperature'] for s in decoded['snapshots']) if 'snapshots' in decoded else (
+            decoded['temperature'],)
+        # Also tells 0 from 0.0
+        if repr(found) != repr(expected):
+            errors.append('%s: temperature %r, expected %r' % (data, found, expected))
+
+    ttn = decode_ttn(uplinks)
+    if ttn is None:
+        print('node not found, ttn.js not checked')
+    else:
+        check_ttn(uplinks, ttn, errors)
+
+    for error in errors:
+        print('FAIL %s' % error)
+
+    print('%s, %d frames, %d errors\n' % ('ok' if not errors else 'FAIL', len(uplinks), len(errors)))
+
+    return not errors
+
+
+def read_filters(output):
+    rejected = {}
+
+    for line in output.splitlines():
+        if '$FILTER: ' in line:
+            fields = line.split('$FILTER: ')[1].split(',')
+            rejected[int(fields[0])] = int(fields[4])
+
+    return rejected
+
+
+def check_filter():
+    print('# filter')
+
+    errors = []
+
+    # Flat temperature and CO2 with a step within the noise of the sensors, Hampel on both has no deviation to go by
+    with tempfile.NamedTemporaryFile('w', suffix='.csv') as trace:
+        trace.write('minute,temperature,co2\n')
+        for minute in range(240):
+            trace.write('%d,%s,%d\n' % (minute, '21.00' if minute < 120 else '21.30', 990 if minute < 120 else 1005))
+        trace.flush()
+
+        output = subprocess.check_output([SIM, '-d', '0.2', '-t', trace.name, '-c', '0:AT$FILTER=0,2,3',
+                                          '-c', 'AT$FILTER?'], universal_newlines=True)
+
+    rejected = read_filters(output)
+    for stream, name in ((0, 'temperature'), (4, 'co2')):
+        print('%-24s %10d  rejected on a step after flat samples' % (name, rejected.get(stream, -1)))
+        if rejected.get(stream) != 0:
+            errors.append('%s: step after flat samples rejected' % name)
+
+    # Spurious CO2 readings are still caught
+    output = subprocess.check_output([SIM, '-d', '1', '-g', '20', '-c', 'AT$FILTER?'], universal_newlines=True)
+
+    rejected = read_filters(output)
+    print('%-24s %10d  rejected of the spurious readings' % ('co2', rejected.get(4, 0)))
+    if not rejected.get(4):
+        errors.append('co2: no spurious reading rejected')
+
+    for error in errors:
+        print('FAIL %s' % error)
+
+    print('%s, %d errors\n' % ('ok' if not errors else 'FAIL', len(errors)))
+
+    return not errors
+
+
+def check_reboot():
+    print('# reboot')
+
+    # OTAA from the start, a reset by downlink keeps the session of the module, a brownout loses it,
+    # the settings in the EEPROM survive both
+    cases = [('reset', ['-l', '200:10:0106'], False), ('brownout', ['-b', '180'], True)]
+    errors = []
+
+    for name, args, rejoin in cases:
+        output = subprocess.check_output([SIM, '-u', '-d', '0.5', '-c', '0.1:AT$MODE=1', '-c', '0.2:AT$THRCO2=800,1200',
+                                          '-c', '600:AT$THRCO2?'] + args, universal_newlines=True)
+        events = [(parse_minute(line), line[line.index('] ') + 2:]) for line in output.splitlines()
+                  if parse_minute(line) is not None]
+
+        reboot = next((m for m, e in events if e.startswith(('$SIM: "SYSTEM RESET"', '$SIM: "BROWNOUT"'))), None)
+        if reboot is None:
+            errors.append('%s: no reboot' % name)
+            continue
+
+        if not any(m > reboot and e == '$THRCO2: 800,1200' for m, e in events):
+            errors.append('%s: CO2 thresholds lost' % name)
+
+        joins = [m for m, e in events if e == '$JOIN_OK' and m > reboot]
+        uplinks = [m for m, e in events if e.startswith('UPLINK') and m > reboot]
+
+        if bool(joins) != rejoin:
+            errors.append('%s: %d joins after the reboot, expected %s' % (name, len(joins), 'some' if rejoin else 'none'))
+        if not uplinks or uplinks[0] > reboot + 30:
+            errors.append('%s: no uplink within 30 minutes of the reboot' % name)
+        else:
+            print('%-24s %10.1f  min to the first uplink%s' % (name, uplinks[0] - reboot, ', joined again' if joins else ''))
+
+    for error in errors:
+        print('FAIL %s' % error)
+
+    print('%s, %d reboots, %d errors\n' % ('ok' if not errors else 'FAIL', len(cases), len(errors)))
+
+    return not errors
+
+
+def replay(trace, args, update):
+    print('# %s' % os.path.relpath(trace, ROOT))
+
+    levels, motions, moves = load_trace(trace)
+    uplinks, report, tasks = run_sim(trace, args)
+    errors = []
+
+    try:
+        decode_uplinks(uplinks)
+    except Exception as e:
+        print('FAIL decode.py: %s' % e)
+        return False
+
+    ttn = decode_ttn(uplinks)
+    if ttn is None:
+        print('node not found, ttn.js not checked')
+    else:
+        check_ttn(uplinks, ttn, errors)
+
+    check_values(uplinks, levels, motions, moves, errors)
+
+    days = (max(m for m, _ in levels['temperature']) + 1) / (24 * 60) if 'temperature' in levels else 1.0
+    metrics = dict((name.replace(' ', '_') + '_per_day', report[name]) for name in METRICS if name in report)
+
+    # Samples are the conversions of the sensors, the MCU cost is the time of every task on the host
+    samples = sum(t['calls'] for name, t in tasks.items() if name.startswith(('climate/', 'co2', 'lis2dh12', 'pir')))
+    cpu_us = sum(t['cpu_us'] for t in tasks.values())
+
+    print('%-24s %10d  %.1f / day' % ('uplinks decoded', len(uplinks), len(uplinks) / days))
+    print('%-24s %10d' % ('sensor samples', samples))
+    print('%-24s %10.3f' % ('host cpu us / sample', cpu_us / samples if samples else 0.0))
+
+    # The baseline holds for the default configuration only
+    if args:
+        for name, value in sorted(metrics.items()):
+            print('%-24s %10.1f' % (name, value))
+    else:
+        check_baseline(os.path.splitext(trace)[0] + '.json', metrics, update, errors)
+
+    for error in errors:
+        print('FAIL %s' % error)
+
+    print('%s, %d uplinks, %d errors\n' % ('ok' if not errors else 'FAIL', len(uplinks), len(errors)))
+
+    return not errors
+
+
+if __name__ == '__main__':
+    args = sys.argv[1:]
+    update = '--update' in args
+    args = [a for a in args if a != '--update']
+
+    traces = [a for a in args if a.endswith('.csv')]
+    sim_args = [a for a in args if not a.endswith('.csv')]
+
+    if not traces or '-h' in args or '--help' in args:
+        print('usage: python3 replay.py [--update] trace.csv... [sim options]')
+        print('example: python3 replay.py traces/office.csv')
+        exit(1)
+
+    ok = all([check_frames(), check_filter(), check_reboot()] + [replay(os.path.abspath(trace), sim_args, update) for trace in traces])
+
+    exit(0 if ok else 1)
@@ -0,0 +1,424 @@
+#include <sim.h>
+#include <application.h>
+#include <getopt.h>
+#include <unistd.h>
+
+#define _SIM_MAX_COMMANDS 64
+
+static struct
+{
+    int argc;
+    char **argv;
+
+    // First command not executed yet, a reboot continues with it
+    int command;
+
+} _sim;
+
+void application_init(void);
+void application_task(void);
+
+static void _sim_application_task(void *param)
+{
+    (void) param;
+
+    application_task();
+}
+
+static void _sim_usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-d days] [-r datarate] [-s seed] [-q] [-u] [-t trace.csv] [-n snr] [-o minute:minutes] [-g permille] [-c [minute:]AT$CMD] [-l minute:port:hex] [-m minute] [-b minute]...\n"
+            "  -d days      simulated time, fractions allowed (default 1 or the length of the trace)\n"
+            "  -r datarate  LoRa data rate applied after boot (default 5)\n"
+            "  -s seed      environment random seed\n"
+            "  -q           do not print the AT console output\n"
+            "  -u           print every uplink as port and hex when it goes on air\n"
+            "  -t trace     replay the recorded environment instead of the synthetic room\n"
+            "  -n snr       mean SNR of the channel [dB], fading of +-6 dB (default 2)\n"
+            "  -o outage    network outage starting at the minute for the given minutes\n"
+            "  -g permille  spurious CO2 and illuminance readings per thousand samples\n"
+            "  -c command   AT command executed at the given minute or at the end\n"
+            "  -l downlink  downlink queued at the minute, delivered after the next uplink\n"
+            "  -m minute    unit taken off the wall at the minute, again to put it back\n"
+            "  -b minute    brownout at the minute, the MCU reboots and the radio module loses its session\n",
+            name);
+}
+
+// Downlink as port:hex
+static void _sim_downlink(const char *line)
+{
+    char *end;
+
+    uint8_t port = strtoul(line, &end, 10);
+
+    if (*end != ':')
+    {
+        return;
+    }
+
+    uint8_t data[TWR_CMWX1ZZABZ_RX_MAX_PACKET_SIZE];
+    size_t length = 0;
+
+    for (const char *p = end + 1; p[0] != 0 && p[1] != 0 && length < sizeof(data); p += 2)
+    {
+        char byte[3] = { p[0], p[1], 0 };
+
+        data[length++] = strtoul(byte, NULL, 16);
+    }
+
+    sim_radio_queue_downlink(port, data, length);
+}
+
+void sim_reboot(bool brownout)
+{
+    char path[] = "/tmp/sim-XXXXXX";
+
+    int fd = mkstemp(path);
+
+    FILE *file = fd >= 0 ? fdopen(fd, "wb") : NULL;
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "sim: cannot save the state for the reboot\n");
+
+        exit(1);
+    }
+
+    fwrite(&_sim.command, sizeof(_sim.command), 1, file);
+
+    sim_system_save(file);
+    sim_scheduler_save(file);
+    sim_env_save(file);
+    sim_accelerometer_save(file);
+    sim_radio_save(file, brownout);
+
+    fclose(file);
+
+    // Same options, the state of a previous reboot replaced
+    char *argv[_sim.argc + 3];
+    int argc = 0;
+
+    argv[argc++] = _sim.argv[0];
+    argv[argc++] = "-R";
+    argv[argc++] = path;
+
+    for (int i = 1; i < _sim.argc; i++)
+    {
+        if (strcmp(_sim.argv[i], "-R") == 0 && i + 1 < _sim.argc)
+        {
+            i++;
+
+            continue;
+        }
+
+        argv[argc++] = _sim.argv[i];
+    }
+
+    argv[argc] = NULL;
+
+    fflush(stdout);
+    fflush(stderr);
+
+    execv("/proc/self/exe", argv);
+
+    perror("sim: reboot");
+
+    exit(1);
+}
+
+static bool _sim_restore(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    bool ok = fread(&_sim.command, sizeof(_sim.command), 1, file) == 1 &&
+              sim_system_load(file) &&
+              sim_scheduler_load(file) &&
+              sim_env_load(file) &&
+              sim_accelerometer_load(file) &&
+              sim_radio_load(file);
+
+    fclose(file);
+
+    unlink(path);
+
+    return ok;
+}
+
+static void _sim_report(twr_tick_t end)
+{
+    double days = (double) end / SIM_DAY;
+
+    sim_radio_stats_t radio;
+
+    sim_radio_get_stats(&radio);
+
+    sim_i2c_stats_t i2c;
+
+    sim_i2c_get_stats(TWR_I2C_I2C0, &i2c);
+
+    printf("\n# Simulated %.2f days\n", days);
+    printf("wake-ups          %10llu  %10.1f / day\n", (unsigned long long) sim_scheduler_get_wakeups(), sim_scheduler_get_wakeups() / days);
+    printf("uplinks           %10llu  %10.1f / day\n", (unsigned long long) radio.uplinks, radio.uplinks / days);
+    printf("payload bytes     %10llu  %10.1f / day\n", (unsigned long long) radio.payload_bytes, radio.payload_bytes / days);
+    printf("bytes on air      %10llu  %10.1f / day\n", (unsigned long long) radio.phy_bytes, radio.phy_bytes / days);
+    printf("airtime ms        %10llu  %10.1f / day\n", (unsigned long long) radio.airtime_ms, radio.airtime_ms / days);
+    printf("downlinks         %10llu\n", (unsigned long long) radio.downlinks);
+    printf("lost uplinks      %10llu\n", (unsigned long long) radio.lost_uplinks);
+    printf("link checks       %10llu\n", (unsigned long long) radio.link_checks);
+    printf("join requests     %10llu\n", (unsigned long long) radio.joins);
+    printf("refused uplinks   %10llu\n", (unsigned long long) radio.refused_uplinks);
+    printf("i2c0 sessions     %10llu  %10.1f / day\n", (unsigned long long) i2c.sessions, i2c.sessions / days);
+    printf("i2c0 transfers    %10llu  %10.1f / day\n", (unsigned long long) i2c.transfers, i2c.transfers / days);
+
+    sim_task_stats_t stats[TWR_SCHEDULER_MAX_TASKS];
+
+    int count = sim_scheduler_get_task_stats(stats, TWR_SCHEDULER_MAX_TASKS);
+
+    printf("\n%-24s %10s %10s %12s %10s\n", "task", "calls", "calls/day", "host cpu us", "us/call");
+
+    for (int i = 0; i < count; i++)
+    {
+        printf("%-24s %10llu %10.1f %12.1f %10.3f\n",
+               stats[i].name,
+               (unsigned long long) stats[i].calls,
+               stats[i].calls / days,
+               stats[i].cpu_ns / 1000.0,
+               stats[i].calls ? stats[i].cpu_ns / 1000.0 / stats[i].calls : 0.0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    double days = 0;
+    int datarate = -1;
+    uint32_t seed = 1;
+    const char *restore = NULL;
+
+    _sim.argc = argc;
+    _sim.argv = argv;
+
+    struct
+    {
+        twr_tick_t tick;
+        const char *line;
+        char kind;
+
+    } commands[_SIM_MAX_COMMANDS];
+
+    int commands_length = 0;
+
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:r:s:qut:n:o:g:c:l:m:b:R:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'd':
+                days = atof(optarg);
+                break;
+            case 'r':
+                datarate = atoi(optarg);
+                break;
+            case 's':
+                seed = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            case 'q':
+                sim_atci_set_quiet(true);
+                break;
+            case 'u':
+                sim_radio_set_verbose(true);
+                break;
+            case 't':
+                if (!sim_trace_load(optarg))
+                {
+                    return 1;
+                }
+                break;
+            case 'n':
+                sim_radio_set_snr(atoi(optarg));
+                break;
+            case 'g':
+                sim_env_set_glitch(atoi(optarg));
+                break;
+            case 'o':
+            {
+                const char *colon = strchr(optarg, ':');
+                twr_tick_t start = (twr_tick_t) (atof(optarg) * 60 * 1000);
+
+                sim_radio_set_outage(start, colon != NULL ? start + (twr_tick_t) (atof(colon + 1) * 60 * 1000) : TWR_TICK_INFINITY);
+
+                break;
+            }
+            case 'c':
+            {
+                if (commands_length == _SIM_MAX_COMMANDS)
+                {
+                    break;
+                }
+
+                const char *colon = strchr(optarg, ':');
+
+                if (colon != NULL && strncmp(optarg, "AT", 2) != 0)
+                {
+                    commands[commands_length].tick = (twr_tick_t) (atof(optarg) * 60 * 1000);
+                    commands[commands_length].line = colon + 1;
+                }
+                else
+                {
+                    commands[commands_length].tick = TWR_TICK_INFINITY;
+                    commands[commands_length].line = optarg;
+                }
+
+                commands[commands_length].kind = 'c';
+
+                commands_length++;
+
+                break;
+            }
+            case 'l':
+            {
+                const char *colon = strchr(optarg, ':');
+
+                if (commands_length == _SIM_MAX_COMMANDS || colon == NULL)
+                {
+                    break;
+                }
+
+                commands[commands_length].tick = (twr_tick_t) (atof(optarg) * 60 * 1000);
+                commands[commands_length].line = colon + 1;
+                commands[commands_length].kind = 'l';
+
+                commands_length++;
+
+                break;
+            }
+            case 'm':
+            case 'b':
+            {
+                if (commands_length == _SIM_MAX_COMMANDS)
+                {
+                    break;
+                }
+
+                commands[commands_length].tick = (twr_tick_t) (atof(optarg) * 60 * 1000);
+                commands[commands_length].line = NULL;
+                commands[commands_length].kind = opt;
+
+                commands_length++;
+
+                break;
+            }
+            case 'R':
+                // State saved by the reboot
+                restore = optarg;
+                break;
+            default:
+                _sim_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (days <= 0)
+    {
+        days = sim_trace_is_loaded() ? (double) sim_trace_get_end() / SIM_DAY : 1;
+    }
+
+    twr_tick_t end = (twr_tick_t) (days * SIM_DAY);
+
+    // Recorded moves are turns of the unit like -m
+    for (twr_tick_t tick = sim_trace_next_event(SIM_TRACE_MOVE, 0); tick < end && commands_length < _SIM_MAX_COMMANDS;
+         tick = sim_trace_next_event(SIM_TRACE_MOVE, tick + 1))
+    {
+        commands[commands_length].tick = tick;
+        commands[commands_length].line = NULL;
+        commands[commands_length].kind = 'm';
+
+        commands_length++;
+    }
+
+    sim_env_init(seed);
+
+    twr_system_init();
+    twr_scheduler_init();
+
+    if (restore != NULL && !_sim_restore(restore))
+    {
+        fprintf(stderr, "sim: cannot restore the state of the reboot\n");
+
+        return 1;
+    }
+
+    sim_scheduler_set_task_name(twr_scheduler_register(_sim_application_task, NULL, 0), "application_task");
+
+    application_init();
+
+    // Applied once after the first boot like a command
+    if (datarate >= 0 && restore == NULL)
+    {
+        sim_atci_execute(datarate < 10 ? (char[]) {'A', 'T', '$', 'D', 'R', '=', '0' + datarate, 0} : "AT$DR=15");
+    }
+
+    for (int i = 0; i < commands_length; i++)
+    {
+        // Commands are executed in the order of their time, end-of-run commands last
+        int next = i;
+
+        for (int j = i + 1; j < commands_length; j++)
+        {
+            if (commands[j].tick < commands[next].tick)
+            {
+                next = j;
+            }
+        }
+
+        if (next != i)
+        {
+            typeof(commands[0]) tmp = commands[i];
+            commands[i] = commands[next];
+            commands[next] = tmp;
+        }
+
+        // Executed before the reboot
+        if (i < _sim.command)
+        {
+            continue;
+        }
+
+        _sim.command = i;
+
+        sim_scheduler_run_until(commands[i].tick < end ? commands[i].tick : end);
+
+        _sim.command = i + 1;
+
+        if (commands[i].kind == 'b')
+        {
+            twr_atci_printf("$SIM: \"BROWNOUT\"");
+
+            sim_reboot(true);
+        }
+        else if (commands[i].kind == 'l')
+        {
+            _sim_downlink(commands[i].line);
+        }
+        else if (commands[i].kind == 'm')
+        {
+            sim_accelerometer_move();
+        }
+        else
+        {
+            sim_atci_execute(commands[i].line);
+        }
+    }
+
+    sim_scheduler_run_until(end);
+
+    _sim_report(end);
+
+    return 0;
+}
@@ -0,0 +1,208 @@
+#include <sim.h>
+
+// Synthetic office room: occupied on weekdays 8:00 - 17:00 with an empty lunch hour,
+// day 0 of the simulation is a Monday. A loaded trace takes over the streams it records.
+
+#define _SIM_ENV_MINUTE (60ULL * 1000)
+#define _SIM_ENV_HOUR (60 * _SIM_ENV_MINUTE)
+
+static struct
+{
+    uint32_t rand_state;
+
+    // Spurious readings per thousand samples
+    uint32_t glitch;
+
+} _sim_env;
+
+void sim_env_init(uint32_t seed)
+{
+    _sim_env.rand_state = seed != 0 ? seed : 0x12345678;
+}
+
+void sim_env_save(FILE *file)
+{
+    fwrite(&_sim_env.rand_state, sizeof(_sim_env.rand_state), 1, file);
+}
+
+bool sim_env_load(FILE *file)
+{
+    return fread(&_sim_env.rand_state, sizeof(_sim_env.rand_state), 1, file) == 1;
+}
+
+void sim_env_set_glitch(uint32_t permille)
+{
+    _sim_env.glitch = permille;
+}
+
+static bool _sim_env_is_glitch(void)
+{
+    return _sim_env.glitch != 0 && sim_env_rand() % 1000 < _sim_env.glitch;
+}
+
+uint32_t sim_env_rand(void)
+{
+    uint32_t x = _sim_env.rand_state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    _sim_env.rand_state = x;
+
+    return x;
+}
+
+static float _sim_env_day_phase(twr_tick_t tick)
+{
+    return (float) (tick % SIM_DAY) / SIM_DAY;
+}
+
+static bool _sim_env_is_weekday(twr_tick_t tick)
+{
+    return (tick / SIM_DAY) % 7 < 5;
+}
+
+bool sim_env_is_occupied(twr_tick_t tick)
+{
+    if (!_sim_env_is_weekday(tick))
+    {
+        return false;
+    }
+
+    twr_tick_t time_of_day = tick % SIM_DAY;
+
+    if (time_of_day >= 12 * _SIM_ENV_HOUR && time_of_day < 13 * _SIM_ENV_HOUR)
+    {
+        return false;
+    }
+
+    return time_of_day >= 8 * _SIM_ENV_HOUR && time_of_day < 17 * _SIM_ENV_HOUR;
+}
+
+// Minutes of continuous occupancy (positive) or vacancy (negative) preceding the tick
+static float _sim_env_occupancy_minutes(twr_tick_t tick)
+{
+    bool occupied = sim_env_is_occupied(tick);
+    twr_tick_t start = tick - (tick % _SIM_ENV_MINUTE);
+    int minutes = 0;
+
+    while (start >= _SIM_ENV_MINUTE && minutes < 24 * 60 && sim_env_is_occupied(start - _SIM_ENV_MINUTE) == occupied)
+    {
+        start -= _SIM_ENV_MINUTE;
+        minutes++;
+    }
+
+    return occupied ? minutes : -minutes;
+}
+
+float sim_env_get_temperature(twr_tick_t tick)
+{
+    float value;
+
+    if (sim_trace_get(SIM_TRACE_TEMPERATURE, tick, &value))
+    {
+        return value;
+    }
+
+    value = 21.f + 1.5f * sinf(2.f * (float) M_PI * (_sim_env_day_phase(tick) - 0.375f));
+
+    if (sim_env_is_occupied(tick))
+    {
+        value += 0.8f;
+    }
+
+    return value + (float) (sim_env_rand() % 21) / 100.f - 0.1f;
+}
+
+float sim_env_get_humidity(twr_tick_t tick)
+{
+    float value;
+
+    if (sim_trace_get(SIM_TRACE_HUMIDITY, tick, &value))
+    {
+        return value;
+    }
+
+    return 42.f - 6.f * sinf(2.f * (float) M_PI * (_sim_env_day_phase(tick) - 0.375f)) + (float) (sim_env_rand() % 11) / 10.f;
+}
+
+float sim_env_get_illuminance(twr_tick_t tick)
+{
+    float value;
+
+    if (sim_trace_get(SIM_TRACE_ILLUMINANCE, tick, &value))
+    {
+        return value;
+    }
+
+    float daylight = sinf(2.f * (float) M_PI * (_sim_env_day_phase(tick) - 0.25f));
+
+    value = daylight > 0 ? 350.f * daylight : 0.f;
+
+    if (sim_env_is_occupied(tick))
+    {
+        value += 300.f;
+    }
+
+    // Shadow of someone passing by
+    if (_sim_env_is_glitch())
+    {
+        value *= 0.2f;
+    }
+
+    return value;
+}
+
+float sim_env_get_pressure(twr_tick_t tick)
+{
+    float value;
+
+    if (sim_trace_get(SIM_TRACE_PRESSURE, tick, &value))
+    {
+        return value;
+    }
+
+    return 98500.f + 400.f * sinf(2.f * (float) M_PI * (float) tick / (5.f * SIM_DAY)) + (float) (sim_env_rand() % 20);
+}
+
+float sim_env_get_co2(twr_tick_t tick)
+{
+    float value;
+
+    if (sim_trace_get(SIM_TRACE_CO2, tick, &value))
+    {
+        return value;
+    }
+
+    float minutes = _sim_env_occupancy_minutes(tick);
+
+    if (minutes > 0)
+    {
+        value = 450.f + 900.f * (1.f - expf(-minutes / 90.f));
+    }
+    else
+    {
+        value = 430.f + 500.f * expf(minutes / 45.f);
+    }
+
+    // Spurious reading of the NDIR sensor
+    if (_sim_env_is_glitch())
+    {
+        value += 400.f + (float) (sim_env_rand() % 400);
+    }
+
+    return value + (float) (sim_env_rand() % 15);
+}
+
+float sim_env_get_voltage(twr_tick_t tick)
+{
+    float value;
+
+    if (sim_trace_get(SIM_TRACE_VOLTAGE, tick, &value))
+    {
+        return value;
+    }
+
+    return 6.2f - 0.002f * (float) tick / SIM_DAY;
+}
@@ -0,0 +1,87 @@
+#include <sim.h>
+
+static void _sim_sensor_task(void *param)
+{
+    sim_sensor_t *self = param;
+
+    if (!self->measuring)
+    {
+        self->measuring = true;
+        self->start = twr_tick_get();
+
+        if (self->i2c_channel >= 0)
+        {
+            sim_i2c_transfer(self->i2c_channel);
+        }
+
+        twr_scheduler_plan_current_relative(self->conversion);
+
+        return;
+    }
+
+    self->measuring = false;
+
+    if (self->i2c_channel >= 0)
+    {
+        sim_i2c_transfer(self->i2c_channel);
+    }
+
+    if (self->interval != TWR_TICK_INFINITY)
+    {
+        twr_scheduler_plan_current_absolute(self->start + self->interval);
+    }
+
+    self->done(self->param);
+}
+
+void sim_sensor_init(sim_sensor_t *self, const char *name, twr_tick_t conversion, void (*done)(void *), void *param)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->name = name;
+    self->conversion = conversion;
+    self->done = done;
+    self->param = param;
+    self->interval = TWR_TICK_INFINITY;
+    self->i2c_channel = -1;
+
+    self->task_id = twr_scheduler_register(_sim_sensor_task, self, TWR_TICK_INFINITY);
+
+    sim_scheduler_set_task_name(self->task_id, name);
+}
+
+void sim_sensor_set_update_interval(sim_sensor_t *self, twr_tick_t interval)
+{
+    self->interval = interval;
+
+    if (self->measuring)
+    {
+        return;
+    }
+
+    if (interval == TWR_TICK_INFINITY)
+    {
+        twr_scheduler_plan_absolute(self->task_id, TWR_TICK_INFINITY);
+    }
+    else
+    {
+        twr_scheduler_plan_from_now(self->task_id, interval);
+    }
+}
+
+void sim_sensor_set_i2c_channel(sim_sensor_t *self, twr_i2c_channel_t channel)
+{
+    self->i2c_channel = channel;
+}
+
+bool sim_sensor_measure(sim_sensor_t *self)
+{
+    if (self->measuring)
+    {
+        return false;
+    }
+
+    twr_scheduler_plan_now(self->task_id);
+
+    return true;
+}
@@ -0,0 +1,282 @@
+#include <sim.h>
+
+// Recorded environment in CSV: a header row naming the columns, then rows in time order.
+// The minute column is the time since the start, level columns hold their value until the next row
+// that sets them, motion is the number of PIR motions within the minute, move turns the unit.
+
+#define _SIM_TRACE_LINE_MAX 256
+#define _SIM_TRACE_COLUMNS_MAX 16
+#define _SIM_TRACE_MINUTE (60ULL * 1000)
+
+typedef struct
+{
+    twr_tick_t tick;
+    float value;
+
+} _sim_trace_sample_t;
+
+typedef struct
+{
+    _sim_trace_sample_t *samples;
+    size_t length;
+    size_t size;
+
+} _sim_trace_series_t;
+
+static const char *_sim_trace_columns[SIM_TRACE_STREAMS] = {
+    [SIM_TRACE_TEMPERATURE] = "temperature",
+    [SIM_TRACE_HUMIDITY] = "humidity",
+    [SIM_TRACE_ILLUMINANCE] = "illuminance",
+    [SIM_TRACE_PRESSURE] = "pressure",
+    [SIM_TRACE_CO2] = "co2",
+    [SIM_TRACE_VOLTAGE] = "voltage",
+    [SIM_TRACE_MOTION] = "motion",
+    [SIM_TRACE_MOVE] = "move",
+};
+
+static struct
+{
+    bool loaded;
+    twr_tick_t end;
+    _sim_trace_series_t series[SIM_TRACE_STREAMS];
+
+} _sim_trace;
+
+static bool _sim_trace_append(_sim_trace_series_t *series, twr_tick_t tick, float value)
+{
+    if (series->length == series->size)
+    {
+        size_t size = series->size != 0 ? series->size * 2 : 256;
+
+        _sim_trace_sample_t *samples = realloc(series->samples, size * sizeof(*samples));
+
+        if (samples == NULL)
+        {
+            return false;
+        }
+
+        series->samples = samples;
+        series->size = size;
+    }
+
+    series->samples[series->length].tick = tick;
+    series->samples[series->length].value = value;
+    series->length++;
+
+    return true;
+}
+
+static bool _sim_trace_is_event(sim_trace_stream_t stream)
+{
+    return stream == SIM_TRACE_MOTION || stream == SIM_TRACE_MOVE;
+}
+
+// Splits the line at commas in place, returns the number of fields
+static int _sim_trace_split(char *line, char **fields, int length)
+{
+    int count = 0;
+
+    line[strcspn(line, "\r\n")] = 0;
+
+    while (count < length)
+    {
+        fields[count++] = line;
+
+        char *comma = strchr(line, ',');
+
+        if (comma == NULL)
+        {
+            break;
+        }
+
+        *comma = 0;
+        line = comma + 1;
+    }
+
+    return count;
+}
+
+bool sim_trace_load(const char *path)
+{
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "trace: cannot open %s\n", path);
+
+        return false;
+    }
+
+    char line[_SIM_TRACE_LINE_MAX];
+    char *fields[_SIM_TRACE_COLUMNS_MAX];
+
+    // Column of the minute and of every stream, -1 if the trace has none
+    int minute_column = -1;
+    int columns[SIM_TRACE_STREAMS];
+
+    if (fgets(line, sizeof(line), file) == NULL)
+    {
+        fclose(file);
+
+        return false;
+    }
+
+    int count = _sim_trace_split(line, fields, _SIM_TRACE_COLUMNS_MAX);
+
+    for (int i = 0; i < SIM_TRACE_STREAMS; i++)
+    {
+        columns[i] = -1;
+    }
+
+    for (int c = 0; c < count; c++)
+    {
+        if (strcmp(fields[c], "minute") == 0)
+        {
+            minute_column = c;
+        }
+
+        for (int i = 0; i < SIM_TRACE_STREAMS; i++)
+        {
+            if (strcmp(fields[c], _sim_trace_columns[i]) == 0)
+            {
+                columns[i] = c;
+            }
+        }
+    }
+
+    if (minute_column < 0)
+    {
+        fprintf(stderr, "trace: %s has no minute column\n", path);
+
+        fclose(file);
+
+        return false;
+    }
+
+    int row = 1;
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        row++;
+
+        count = _sim_trace_split(line, fields, _SIM_TRACE_COLUMNS_MAX);
+
+        if (count <= minute_column || fields[minute_column][0] == 0)
+        {
+            continue;
+        }
+
+        twr_tick_t tick = (twr_tick_t) (atof(fields[minute_column]) * _SIM_TRACE_MINUTE);
+
+        if (tick < _sim_trace.end)
+        {
+            fprintf(stderr, "trace: %s row %d goes back in time\n", path, row);
+
+            fclose(file);
+
+            return false;
+        }
+
+        _sim_trace.end = tick;
+
+        for (int i = 0; i < SIM_TRACE_STREAMS; i++)
+        {
+            if (columns[i] < 0 || columns[i] >= count || fields[columns[i]][0] == 0)
+            {
+                continue;
+            }
+
+            float value = atof(fields[columns[i]]);
+
+            if (!_sim_trace_is_event(i))
+            {
+                _sim_trace_append(&_sim_trace.series[i], tick, value);
+
+                continue;
+            }
+
+            // Events of the minute are spread evenly over it
+            int events = (int) value;
+
+            for (int e = 0; e < events; e++)
+            {
+                _sim_trace_append(&_sim_trace.series[i], tick + (2 * e + 1) * _SIM_TRACE_MINUTE / (2 * events), 1.f);
+            }
+        }
+    }
+
+    fclose(file);
+
+    // The last row covers its minute
+    _sim_trace.end += _SIM_TRACE_MINUTE;
+    _sim_trace.loaded = true;
+
+    return true;
+}
+
+bool sim_trace_is_loaded(void)
+{
+    return _sim_trace.loaded;
+}
+
+twr_tick_t sim_trace_get_end(void)
+{
+    return _sim_trace.end;
+}
+
+bool sim_trace_get(sim_trace_stream_t stream, twr_tick_t tick, float *value)
+{
+    _sim_trace_series_t *series = &_sim_trace.series[stream];
+
+    if (!_sim_trace.loaded || series->length == 0)
+    {
+        return false;
+    }
+
+    // Last sample at or before the tick, the first one also covers the time before it
+    size_t low = 0;
+    size_t high = series->length;
+
+    while (high - low > 1)
+    {
+        size_t middle = (low + high) / 2;
+
+        if (series->samples[middle].tick <= tick)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    *value = series->samples[low].value;
+
+    return true;
+}
+
+twr_tick_t sim_trace_next_event(sim_trace_stream_t stream, twr_tick_t tick)
+{
+    _sim_trace_series_t *series = &_sim_trace.series[stream];
+
+    size_t low = 0;
+    size_t high = series->length;
+
+    // First event at or after the tick
+    while (low < high)
+    {
+        size_t middle = (low + high) / 2;
+
+        if (series->samples[middle].tick < tick)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low < series->length ? series->samples[low].tick : TWR_TICK_INFINITY;
+}
@@ -0,0 +1,178 @@
+#include <sim.h>
+#include <stdarg.h>
+
+static struct
+{
+    const twr_atci_command_t *commands;
+    int commands_length;
+    bool quiet;
+
+} _twr_atci;
+
+void sim_print_tick(FILE *stream, twr_tick_t tick)
+{
+    twr_tick_t day = tick / SIM_DAY;
+    twr_tick_t rest = tick % SIM_DAY;
+
+    fprintf(stream, "[%3llud %02llu:%02llu:%02llu.%03llu] ",
+            (unsigned long long) day,
+            (unsigned long long) (rest / 3600000),
+            (unsigned long long) (rest / 60000 % 60),
+            (unsigned long long) (rest / 1000 % 60),
+            (unsigned long long) (rest % 1000));
+}
+
+void sim_atci_set_quiet(bool quiet)
+{
+    _twr_atci.quiet = quiet;
+}
+
+void twr_atci_init(const twr_atci_command_t *commands, int length)
+{
+    _twr_atci.commands = commands;
+    _twr_atci.commands_length = length;
+}
+
+static void _twr_atci_vprintf(const char *format, va_list ap)
+{
+    if (_twr_atci.quiet)
+    {
+        return;
+    }
+
+    sim_print_tick(stdout, twr_tick_get());
+
+    vprintf(format, ap);
+
+    putchar('\n');
+}
+
+void twr_atci_printf(const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    _twr_atci_vprintf(format, ap);
+    va_end(ap);
+}
+
+void twr_atci_printfln(const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    _twr_atci_vprintf(format, ap);
+    va_end(ap);
+}
+
+bool twr_atci_clac_action(void)
+{
+    for (int i = 0; i < _twr_atci.commands_length; i++)
+    {
+        twr_atci_printf("AT%s", _twr_atci.commands[i].command);
+    }
+
+    return true;
+}
+
+bool twr_atci_help_action(void)
+{
+    for (int i = 0; i < _twr_atci.commands_length; i++)
+    {
+        twr_atci_printf("AT%s %s", _twr_atci.commands[i].command, _twr_atci.commands[i].hint);
+    }
+
+    return true;
+}
+
+bool twr_atci_get_uint(twr_atci_param_t *param, uint32_t *value)
+{
+    char c;
+
+    *value = 0;
+
+    if (param->offset >= param->length || param->txt[param->offset] < '0' || param->txt[param->offset] > '9')
+    {
+        return false;
+    }
+
+    while (param->offset < param->length)
+    {
+        c = param->txt[param->offset];
+
+        if (c < '0' || c > '9')
+        {
+            break;
+        }
+
+        *value = *value * 10 + (uint32_t) (c - '0');
+
+        param->offset++;
+    }
+
+    return true;
+}
+
+bool twr_atci_is_comma(twr_atci_param_t *param)
+{
+    return param->offset < param->length && param->txt[param->offset++] == ',';
+}
+
+bool sim_atci_execute(const char *line)
+{
+    static char buffer[128];
+
+    if (strncmp(line, "AT", 2) != 0 || strlen(line) >= sizeof(buffer))
+    {
+        twr_atci_printf("ERROR");
+
+        return false;
+    }
+
+    strcpy(buffer, line + 2);
+
+    char *separator = strpbrk(buffer, "=?");
+    char type = separator != NULL ? *separator : '\0';
+
+    if (separator != NULL)
+    {
+        *separator++ = '\0';
+    }
+
+    bool ret = false;
+
+    for (int i = 0; i < _twr_atci.commands_length; i++)
+    {
+        const twr_atci_command_t *command = &_twr_atci.commands[i];
+
+        if (strcmp(command->command, buffer) != 0)
+        {
+            continue;
+        }
+
+        if (type == '\0' && command->action != NULL)
+        {
+            ret = command->action();
+        }
+        else if (type == '?' && command->read != NULL)
+        {
+            ret = command->read();
+        }
+        else if (type == '=' && strcmp(separator, "?") == 0 && command->help != NULL)
+        {
+            ret = command->help();
+        }
+        else if (type == '=' && command->set != NULL)
+        {
+            twr_atci_param_t param = { .txt = separator, .length = strlen(separator), .offset = 0 };
+
+            ret = command->set(&param);
+        }
+
+        break;
+    }
+
+    twr_atci_printf(ret ? "OK" : "ERROR");
+
+    return ret;
+}
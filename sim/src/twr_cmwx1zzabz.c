@@ -0,0 +1,678 @@
+#include <sim.h>
+
+// LoRaWAN MAC overhead: MHDR, DevAddr, FCtrl, FCnt, FPort and MIC
+#define _TWR_CMWX1ZZABZ_MAC_OVERHEAD 13
+#define _TWR_CMWX1ZZABZ_BOOT_DELAY 1000
+#define _TWR_CMWX1ZZABZ_RX_WINDOWS 2000
+#define _TWR_CMWX1ZZABZ_JOIN_DELAY 6000
+// Join request: MHDR, AppEUI, DevEUI, DevNonce and MIC
+#define _TWR_CMWX1ZZABZ_JOIN_REQUEST 23
+#define _TWR_CMWX1ZZABZ_DOWNLINK_QUEUE 8
+// EU868 1 % duty cycle, the module refuses to transmit during the off-time of the last uplink
+#define _TWR_CMWX1ZZABZ_DUTY_CYCLE_FACTOR 100
+
+typedef enum
+{
+    _TWR_CMWX1ZZABZ_STATE_BOOT = 0,
+    _TWR_CMWX1ZZABZ_STATE_IDLE = 1,
+    _TWR_CMWX1ZZABZ_STATE_SEND_START = 2,
+    _TWR_CMWX1ZZABZ_STATE_SEND_DONE = 3,
+    _TWR_CMWX1ZZABZ_STATE_JOIN = 4,
+    _TWR_CMWX1ZZABZ_STATE_FRAME_COUNTER = 5,
+    _TWR_CMWX1ZZABZ_STATE_LINK_CHECK = 6,
+    _TWR_CMWX1ZZABZ_STATE_RFQ = 7,
+    _TWR_CMWX1ZZABZ_STATE_FACTORY_RESET = 8
+
+} _twr_cmwx1zzabz_state_t;
+
+static struct
+{
+    sim_radio_stats_t stats;
+
+    struct
+    {
+        uint8_t port;
+        uint8_t data[TWR_CMWX1ZZABZ_RX_MAX_PACKET_SIZE];
+        size_t length;
+
+    } downlink[_TWR_CMWX1ZZABZ_DOWNLINK_QUEUE];
+
+    int downlink_count;
+
+    twr_tick_t outage_start;
+    twr_tick_t outage_end;
+
+    twr_tick_t off_time_end;
+
+    // End of the transmission on air
+    twr_tick_t transmit_end;
+
+    // Mean SNR of the channel [dB], every transmission fades around it
+    int32_t snr_mean;
+
+    bool received;
+    uint8_t retransmissions;
+
+    // OTAA session, uplinks and link checks are refused without it
+    bool joined;
+
+    // Kept by the module over a reset of the MCU
+    twr_cmwx1zzabz_config_mode_t mode;
+
+    bool verbose;
+
+} _twr_cmwx1zzabz = {
+        .snr_mean = 2
+};
+
+static bool _twr_cmwx1zzabz_is_outage(void)
+{
+    twr_tick_t now = twr_tick_get();
+
+    return now >= _twr_cmwx1zzabz.outage_start && now < _twr_cmwx1zzabz.outage_end;
+}
+
+bool sim_radio_is_transmitting(void)
+{
+    return twr_tick_get() < _twr_cmwx1zzabz.transmit_end;
+}
+
+uint32_t sim_radio_airtime(uint8_t datarate, size_t length)
+{
+    // EU868: DR0 - DR5 are SF12 - SF7 at 125 kHz, DR6 is SF7 at 250 kHz
+    int sf = datarate <= 5 ? 12 - datarate : 7;
+    float bw = datarate == 6 ? 250000.f : 125000.f;
+    int de = (sf >= 11 && datarate != 6) ? 1 : 0;
+
+    float t_sym = (float) (1 << sf) / bw * 1000.f;
+    float t_preamble = (8 + 4.25f) * t_sym;
+
+    float symbols = ceilf((8.f * length - 4.f * sf + 28 + 16) / (4.f * (sf - 2 * de))) * 5;
+
+    if (symbols < 0)
+    {
+        symbols = 0;
+    }
+
+    return (uint32_t) ceilf(t_preamble + (8 + symbols) * t_sym);
+}
+
+// Demodulation floor of the data rate in tenths of dB
+static int32_t _twr_cmwx1zzabz_snr_floor(uint8_t datarate)
+{
+    int sf = datarate <= 5 ? 12 - datarate : 7;
+
+    return -75 - 25 * (sf - 7);
+}
+
+// One transmission over the channel, true if the network received it
+static bool _twr_cmwx1zzabz_transmit(twr_cmwx1zzabz_t *self)
+{
+    self->_snr = _twr_cmwx1zzabz.snr_mean + 6 - (int32_t) (sim_env_rand() % 13);
+    self->_rssi = -105 + self->_snr - (int32_t) (sim_env_rand() % 5);
+
+    return !_twr_cmwx1zzabz_is_outage() && self->_snr * 10 >= _twr_cmwx1zzabz_snr_floor(self->_datarate);
+}
+
+static void _twr_cmwx1zzabz_event(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_event_t event)
+{
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(self, event, self->_event_param);
+    }
+}
+
+static void _twr_cmwx1zzabz_task(void *param)
+{
+    twr_cmwx1zzabz_t *self = param;
+
+    switch (self->_state)
+    {
+        case _TWR_CMWX1ZZABZ_STATE_BOOT:
+        {
+            self->_state = _TWR_CMWX1ZZABZ_STATE_IDLE;
+            self->_ready = true;
+
+            _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_READY);
+
+            return;
+        }
+        case _TWR_CMWX1ZZABZ_STATE_SEND_START:
+        {
+            size_t phy_length = self->_message_length + _TWR_CMWX1ZZABZ_MAC_OVERHEAD;
+
+            bool joined = _twr_cmwx1zzabz.joined || self->_mode != TWR_CMWX1ZZABZ_CONFIG_MODE_OTAA;
+
+            if (twr_tick_get() < _twr_cmwx1zzabz.off_time_end || !joined)
+            {
+                _twr_cmwx1zzabz.stats.refused_uplinks++;
+
+                self->_state = _TWR_CMWX1ZZABZ_STATE_IDLE;
+                self->_ready = true;
+
+                _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_ERROR);
+
+                return;
+            }
+
+            // Unconfirmed uplinks are repeated blindly, confirmed ones until acknowledged
+            uint8_t repeat = self->_message_confirmed ? self->_repeat_confirmed : self->_repeat_unconfirmed;
+            uint8_t transmissions = 0;
+
+            _twr_cmwx1zzabz.received = false;
+
+            while (transmissions < (repeat > 0 ? repeat : 1) && !(self->_message_confirmed && _twr_cmwx1zzabz.received))
+            {
+                _twr_cmwx1zzabz.received |= _twr_cmwx1zzabz_transmit(self);
+
+                transmissions++;
+            }
+
+            _twr_cmwx1zzabz.retransmissions = self->_message_confirmed ? transmissions - 1 : 0;
+
+            uint32_t airtime = sim_radio_airtime(self->_datarate, phy_length) * transmissions;
+
+            _twr_cmwx1zzabz.off_time_end = twr_tick_get() + (twr_tick_t) airtime * _TWR_CMWX1ZZABZ_DUTY_CYCLE_FACTOR;
+
+            _twr_cmwx1zzabz.stats.uplinks++;
+            _twr_cmwx1zzabz.stats.confirmed_uplinks += self->_message_confirmed ? 1 : 0;
+            _twr_cmwx1zzabz.stats.payload_bytes += self->_message_length;
+            _twr_cmwx1zzabz.stats.phy_bytes += phy_length * transmissions;
+            _twr_cmwx1zzabz.stats.airtime_ms += airtime;
+            _twr_cmwx1zzabz.stats.lost_uplinks += _twr_cmwx1zzabz.received ? 0 : 1;
+
+            if (_twr_cmwx1zzabz.verbose)
+            {
+                sim_print_tick(stdout, twr_tick_get());
+
+                printf("UPLINK %d ", self->_message_port);
+
+                for (size_t i = 0; i < self->_message_length; i++)
+                {
+                    printf("%02x", self->_message_buffer[i]);
+                }
+
+                printf(_twr_cmwx1zzabz.received ? "\n" : " lost\n");
+            }
+
+            self->_frame_counter_up++;
+            self->_state = _TWR_CMWX1ZZABZ_STATE_SEND_DONE;
+
+            _twr_cmwx1zzabz.transmit_end = twr_tick_get() + airtime;
+
+            twr_scheduler_plan_current_relative(airtime + _TWR_CMWX1ZZABZ_RX_WINDOWS * transmissions);
+
+            _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_SEND_MESSAGE_START);
+
+            return;
+        }
+        case _TWR_CMWX1ZZABZ_STATE_SEND_DONE:
+        {
+            self->_state = _TWR_CMWX1ZZABZ_STATE_IDLE;
+            self->_ready = true;
+
+            bool confirmed = self->_message_confirmed;
+
+            for (int i = 0; i < _twr_cmwx1zzabz.retransmissions; i++)
+            {
+                _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_MESSAGE_RETRANSMISSION);
+            }
+
+            _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_SEND_MESSAGE_DONE);
+
+            if (confirmed)
+            {
+                _twr_cmwx1zzabz_event(self, _twr_cmwx1zzabz.received ? TWR_CMWX1ZZABZ_EVENT_MESSAGE_CONFIRMED : TWR_CMWX1ZZABZ_EVENT_MESSAGE_NOT_CONFIRMED);
+            }
+
+            if (_twr_cmwx1zzabz.downlink_count > 0 && _twr_cmwx1zzabz.received)
+            {
+                self->_rx_port = _twr_cmwx1zzabz.downlink[0].port;
+                self->_rx_length = _twr_cmwx1zzabz.downlink[0].length;
+                memcpy(self->_rx_buffer, _twr_cmwx1zzabz.downlink[0].data, self->_rx_length);
+
+                _twr_cmwx1zzabz.downlink_count--;
+                memmove(&_twr_cmwx1zzabz.downlink[0], &_twr_cmwx1zzabz.downlink[1], _twr_cmwx1zzabz.downlink_count * sizeof(_twr_cmwx1zzabz.downlink[0]));
+
+                self->_frame_counter_down++;
+                _twr_cmwx1zzabz.stats.downlinks++;
+
+                _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_MESSAGE_RECEIVED);
+            }
+
+            return;
+        }
+        case _TWR_CMWX1ZZABZ_STATE_JOIN:
+        {
+            self->_state = _TWR_CMWX1ZZABZ_STATE_IDLE;
+            self->_ready = true;
+
+            // Join accept is lost like any downlink, a failed join leaves the module without a session
+            _twr_cmwx1zzabz.joined = _twr_cmwx1zzabz.received && self->_mode == TWR_CMWX1ZZABZ_CONFIG_MODE_OTAA;
+
+            if (_twr_cmwx1zzabz.joined)
+            {
+                self->_frame_counter_up = 0;
+                self->_frame_counter_down = 0;
+            }
+
+            _twr_cmwx1zzabz_event(self, _twr_cmwx1zzabz.joined ? TWR_CMWX1ZZABZ_EVENT_JOIN_SUCCESS : TWR_CMWX1ZZABZ_EVENT_JOIN_ERROR);
+
+            return;
+        }
+        case _TWR_CMWX1ZZABZ_STATE_FRAME_COUNTER:
+        {
+            self->_state = _TWR_CMWX1ZZABZ_STATE_IDLE;
+            self->_ready = true;
+
+            _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_FRAME_COUNTER);
+
+            return;
+        }
+        case _TWR_CMWX1ZZABZ_STATE_LINK_CHECK:
+        {
+            self->_state = _TWR_CMWX1ZZABZ_STATE_IDLE;
+            self->_ready = true;
+
+            if (!_twr_cmwx1zzabz.joined && self->_mode == TWR_CMWX1ZZABZ_CONFIG_MODE_OTAA)
+            {
+                _twr_cmwx1zzabz.stats.refused_uplinks++;
+
+                _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_ERROR);
+
+                return;
+            }
+
+            bool received = _twr_cmwx1zzabz_transmit(self);
+
+            // Margin above the demodulation floor as reported by the network
+            int32_t margin = (self->_snr * 10 - _twr_cmwx1zzabz_snr_floor(self->_datarate)) / 10;
+
+            self->_link_check_margin = margin > 0 ? margin : 0;
+            self->_link_check_gateway_count = 1 + sim_env_rand() % 3;
+
+            _twr_cmwx1zzabz.stats.link_checks++;
+
+            _twr_cmwx1zzabz_event(self, received ? TWR_CMWX1ZZABZ_EVENT_LINK_CHECK_OK : TWR_CMWX1ZZABZ_EVENT_LINK_CHECK_NOK);
+
+            return;
+        }
+        case _TWR_CMWX1ZZABZ_STATE_RFQ:
+        {
+            self->_state = _TWR_CMWX1ZZABZ_STATE_IDLE;
+            self->_ready = true;
+
+            _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_RFQ);
+
+            return;
+        }
+        case _TWR_CMWX1ZZABZ_STATE_FACTORY_RESET:
+        {
+            self->_state = _TWR_CMWX1ZZABZ_STATE_IDLE;
+            self->_ready = true;
+
+            _twr_cmwx1zzabz_event(self, TWR_CMWX1ZZABZ_EVENT_MODEM_FACTORY_RESET);
+
+            return;
+        }
+        case _TWR_CMWX1ZZABZ_STATE_IDLE:
+        default:
+        {
+            return;
+        }
+    }
+}
+
+static bool _twr_cmwx1zzabz_start(twr_cmwx1zzabz_t *self, int state, twr_tick_t delay)
+{
+    if (!self->_ready)
+    {
+        return false;
+    }
+
+    self->_ready = false;
+    self->_state = state;
+
+    twr_scheduler_plan_from_now(self->_task_id, delay);
+
+    return true;
+}
+
+void twr_cmwx1zzabz_init(twr_cmwx1zzabz_t *self, twr_uart_channel_t uart_channel)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_uart_channel = uart_channel;
+    self->_band = TWR_CMWX1ZZABZ_CONFIG_BAND_EU868;
+    self->_port = 2;
+    self->_datarate = 5;
+    self->_nwk_public = true;
+    self->_repeat_unconfirmed = 1;
+    self->_repeat_confirmed = 4;
+
+    strcpy(self->_deveui, "0011223344556677");
+    strcpy(self->_devaddr, "26011D00");
+    strcpy(self->_nwkskey, "00000000000000000000000000000000");
+    strcpy(self->_appskey, "00000000000000000000000000000000");
+    strcpy(self->_appkey, "00000000000000000000000000000000");
+    strcpy(self->_appeui, "0000000000000000");
+
+    self->_mode = _twr_cmwx1zzabz.mode;
+
+    self->_state = _TWR_CMWX1ZZABZ_STATE_BOOT;
+    self->_task_id = twr_scheduler_register(_twr_cmwx1zzabz_task, self, _TWR_CMWX1ZZABZ_BOOT_DELAY);
+
+    sim_scheduler_set_task_name(self->_task_id, "cmwx1zzabz");
+}
+
+void twr_cmwx1zzabz_set_event_handler(twr_cmwx1zzabz_t *self, void (*event_handler)(twr_cmwx1zzabz_t *, twr_cmwx1zzabz_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+bool twr_cmwx1zzabz_is_ready(twr_cmwx1zzabz_t *self)
+{
+    return self->_ready;
+}
+
+static bool _twr_cmwx1zzabz_send(twr_cmwx1zzabz_t *self, const void *buffer, size_t length, bool confirmed)
+{
+    if (length > TWR_CMWX1ZZABZ_TX_MAX_PACKET_SIZE || !self->_ready)
+    {
+        return false;
+    }
+
+    memcpy(self->_message_buffer, buffer, length);
+    self->_message_length = length;
+    self->_message_confirmed = confirmed;
+    self->_message_port = self->_port;
+
+    return _twr_cmwx1zzabz_start(self, _TWR_CMWX1ZZABZ_STATE_SEND_START, 0);
+}
+
+bool twr_cmwx1zzabz_send_message(twr_cmwx1zzabz_t *self, const void *buffer, size_t length)
+{
+    return _twr_cmwx1zzabz_send(self, buffer, length, false);
+}
+
+bool twr_cmwx1zzabz_send_message_confirmed(twr_cmwx1zzabz_t *self, const void *buffer, size_t length)
+{
+    return _twr_cmwx1zzabz_send(self, buffer, length, true);
+}
+
+uint32_t twr_cmwx1zzabz_get_received_message_length(twr_cmwx1zzabz_t *self)
+{
+    return self->_rx_length;
+}
+
+uint8_t twr_cmwx1zzabz_get_received_message_port(twr_cmwx1zzabz_t *self)
+{
+    return self->_rx_port;
+}
+
+uint32_t twr_cmwx1zzabz_get_received_message_data(twr_cmwx1zzabz_t *self, uint8_t *buffer, uint32_t buffer_size)
+{
+    if (self->_rx_length > buffer_size)
+    {
+        return 0;
+    }
+
+    memcpy(buffer, self->_rx_buffer, self->_rx_length);
+
+    return self->_rx_length;
+}
+
+void sim_radio_get_stats(sim_radio_stats_t *stats)
+{
+    *stats = _twr_cmwx1zzabz.stats;
+}
+
+void sim_radio_queue_downlink(uint8_t port, const uint8_t *data, size_t length)
+{
+    if (_twr_cmwx1zzabz.downlink_count == _TWR_CMWX1ZZABZ_DOWNLINK_QUEUE || length > TWR_CMWX1ZZABZ_RX_MAX_PACKET_SIZE)
+    {
+        return;
+    }
+
+    _twr_cmwx1zzabz.downlink[_twr_cmwx1zzabz.downlink_count].port = port;
+    _twr_cmwx1zzabz.downlink[_twr_cmwx1zzabz.downlink_count].length = length;
+    memcpy(_twr_cmwx1zzabz.downlink[_twr_cmwx1zzabz.downlink_count].data, data, length);
+
+    _twr_cmwx1zzabz.downlink_count++;
+}
+
+void sim_radio_save(FILE *file, bool brownout)
+{
+    bool joined = _twr_cmwx1zzabz.joined && !brownout;
+
+    fwrite(&_twr_cmwx1zzabz.stats, sizeof(_twr_cmwx1zzabz.stats), 1, file);
+    fwrite(_twr_cmwx1zzabz.downlink, sizeof(_twr_cmwx1zzabz.downlink), 1, file);
+    fwrite(&_twr_cmwx1zzabz.downlink_count, sizeof(_twr_cmwx1zzabz.downlink_count), 1, file);
+    fwrite(&_twr_cmwx1zzabz.off_time_end, sizeof(_twr_cmwx1zzabz.off_time_end), 1, file);
+    fwrite(&joined, sizeof(joined), 1, file);
+    fwrite(&_twr_cmwx1zzabz.mode, sizeof(_twr_cmwx1zzabz.mode), 1, file);
+}
+
+bool sim_radio_load(FILE *file)
+{
+    return fread(&_twr_cmwx1zzabz.stats, sizeof(_twr_cmwx1zzabz.stats), 1, file) == 1 &&
+           fread(_twr_cmwx1zzabz.downlink, sizeof(_twr_cmwx1zzabz.downlink), 1, file) == 1 &&
+           fread(&_twr_cmwx1zzabz.downlink_count, sizeof(_twr_cmwx1zzabz.downlink_count), 1, file) == 1 &&
+           fread(&_twr_cmwx1zzabz.off_time_end, sizeof(_twr_cmwx1zzabz.off_time_end), 1, file) == 1 &&
+           fread(&_twr_cmwx1zzabz.joined, sizeof(_twr_cmwx1zzabz.joined), 1, file) == 1 &&
+           fread(&_twr_cmwx1zzabz.mode, sizeof(_twr_cmwx1zzabz.mode), 1, file) == 1;
+}
+
+void sim_radio_set_snr(int32_t snr)
+{
+    _twr_cmwx1zzabz.snr_mean = snr;
+}
+
+void sim_radio_set_verbose(bool verbose)
+{
+    _twr_cmwx1zzabz.verbose = verbose;
+}
+
+void sim_radio_set_outage(twr_tick_t start, twr_tick_t end)
+{
+    _twr_cmwx1zzabz.outage_start = start;
+    _twr_cmwx1zzabz.outage_end = end;
+}
+
+#define _TWR_CMWX1ZZABZ_STRING_PROPERTY(NAME) \
+    void twr_cmwx1zzabz_set_##NAME(twr_cmwx1zzabz_t *self, char *NAME) \
+    { \
+        strncpy(self->_##NAME, NAME, sizeof(self->_##NAME) - 1); \
+    } \
+    void twr_cmwx1zzabz_get_##NAME(twr_cmwx1zzabz_t *self, char *NAME) \
+    { \
+        strcpy(NAME, self->_##NAME); \
+    }
+
+_TWR_CMWX1ZZABZ_STRING_PROPERTY(deveui)
+_TWR_CMWX1ZZABZ_STRING_PROPERTY(devaddr)
+_TWR_CMWX1ZZABZ_STRING_PROPERTY(nwkskey)
+_TWR_CMWX1ZZABZ_STRING_PROPERTY(appskey)
+_TWR_CMWX1ZZABZ_STRING_PROPERTY(appkey)
+_TWR_CMWX1ZZABZ_STRING_PROPERTY(appeui)
+
+void twr_cmwx1zzabz_set_band(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_config_band_t band)
+{
+    self->_band = band;
+}
+
+twr_cmwx1zzabz_config_band_t twr_cmwx1zzabz_get_band(twr_cmwx1zzabz_t *self)
+{
+    return self->_band;
+}
+
+void twr_cmwx1zzabz_set_mode(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_config_mode_t mode)
+{
+    self->_mode = mode;
+
+    _twr_cmwx1zzabz.mode = mode;
+}
+
+twr_cmwx1zzabz_config_mode_t twr_cmwx1zzabz_get_mode(twr_cmwx1zzabz_t *self)
+{
+    return self->_mode;
+}
+
+void twr_cmwx1zzabz_set_class(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_config_class_t class)
+{
+    self->_class = class;
+}
+
+twr_cmwx1zzabz_config_class_t twr_cmwx1zzabz_get_class(twr_cmwx1zzabz_t *self)
+{
+    return self->_class;
+}
+
+void twr_cmwx1zzabz_set_port(twr_cmwx1zzabz_t *self, uint8_t port)
+{
+    self->_port = port;
+}
+
+uint8_t twr_cmwx1zzabz_get_port(twr_cmwx1zzabz_t *self)
+{
+    return self->_port;
+}
+
+void twr_cmwx1zzabz_set_nwk_public(twr_cmwx1zzabz_t *self, uint8_t public)
+{
+    self->_nwk_public = public;
+}
+
+uint8_t twr_cmwx1zzabz_get_nwk_public(twr_cmwx1zzabz_t *self)
+{
+    return self->_nwk_public;
+}
+
+void twr_cmwx1zzabz_set_adaptive_datarate(twr_cmwx1zzabz_t *self, bool enable)
+{
+    self->_adaptive_datarate = enable;
+}
+
+bool twr_cmwx1zzabz_get_adaptive_datarate(twr_cmwx1zzabz_t *self)
+{
+    return self->_adaptive_datarate;
+}
+
+void twr_cmwx1zzabz_set_datarate(twr_cmwx1zzabz_t *self, uint8_t datarate)
+{
+    self->_datarate = datarate;
+}
+
+uint8_t twr_cmwx1zzabz_get_datarate(twr_cmwx1zzabz_t *self)
+{
+    return self->_datarate;
+}
+
+void twr_cmwx1zzabz_set_repeat_unconfirmed(twr_cmwx1zzabz_t *self, uint8_t repeat)
+{
+    self->_repeat_unconfirmed = repeat;
+}
+
+uint8_t twr_cmwx1zzabz_get_repeat_unconfirmed(twr_cmwx1zzabz_t *self)
+{
+    return self->_repeat_unconfirmed;
+}
+
+void twr_cmwx1zzabz_set_repeat_confirmed(twr_cmwx1zzabz_t *self, uint8_t repeat)
+{
+    self->_repeat_confirmed = repeat;
+}
+
+uint8_t twr_cmwx1zzabz_get_repeat_confirmed(twr_cmwx1zzabz_t *self)
+{
+    return self->_repeat_confirmed;
+}
+
+void twr_cmwx1zzabz_join(twr_cmwx1zzabz_t *self)
+{
+    if (!self->_ready)
+    {
+        return;
+    }
+
+    uint32_t airtime = sim_radio_airtime(self->_datarate, _TWR_CMWX1ZZABZ_JOIN_REQUEST);
+
+    if (twr_tick_get() < _twr_cmwx1zzabz.off_time_end)
+    {
+        _twr_cmwx1zzabz.stats.refused_uplinks++;
+
+        _twr_cmwx1zzabz.received = false;
+    }
+    else
+    {
+        _twr_cmwx1zzabz.off_time_end = twr_tick_get() + (twr_tick_t) airtime * _TWR_CMWX1ZZABZ_DUTY_CYCLE_FACTOR;
+
+        _twr_cmwx1zzabz.stats.joins++;
+        _twr_cmwx1zzabz.stats.airtime_ms += airtime;
+
+        _twr_cmwx1zzabz.received = _twr_cmwx1zzabz_transmit(self);
+    }
+
+    _twr_cmwx1zzabz_start(self, _TWR_CMWX1ZZABZ_STATE_JOIN, _TWR_CMWX1ZZABZ_JOIN_DELAY);
+}
+
+bool twr_cmwx1zzabz_frame_counter(twr_cmwx1zzabz_t *self)
+{
+    return _twr_cmwx1zzabz_start(self, _TWR_CMWX1ZZABZ_STATE_FRAME_COUNTER, 50);
+}
+
+bool twr_cmwx1zzabz_get_frame_counter(twr_cmwx1zzabz_t *self, uint32_t *uplink, uint32_t *downlink)
+{
+    *uplink = self->_frame_counter_up;
+    *downlink = self->_frame_counter_down;
+
+    return true;
+}
+
+bool twr_cmwx1zzabz_link_check(twr_cmwx1zzabz_t *self)
+{
+    uint32_t airtime = sim_radio_airtime(self->_datarate, _TWR_CMWX1ZZABZ_MAC_OVERHEAD);
+
+    if (twr_tick_get() < _twr_cmwx1zzabz.off_time_end)
+    {
+        _twr_cmwx1zzabz.stats.refused_uplinks++;
+
+        return false;
+    }
+
+    _twr_cmwx1zzabz.off_time_end = twr_tick_get() + (twr_tick_t) airtime * _TWR_CMWX1ZZABZ_DUTY_CYCLE_FACTOR;
+
+    return _twr_cmwx1zzabz_start(self, _TWR_CMWX1ZZABZ_STATE_LINK_CHECK, airtime + _TWR_CMWX1ZZABZ_RX_WINDOWS);
+}
+
+bool twr_cmwx1zzabz_get_link_check(twr_cmwx1zzabz_t *self, uint8_t *margin, uint8_t *gateway_count)
+{
+    *margin = self->_link_check_margin;
+    *gateway_count = self->_link_check_gateway_count;
+
+    return true;
+}
+
+bool twr_cmwx1zzabz_rfq(twr_cmwx1zzabz_t *self)
+{
+    return _twr_cmwx1zzabz_start(self, _TWR_CMWX1ZZABZ_STATE_RFQ, 50);
+}
+
+bool twr_cmwx1zzabz_get_rfq(twr_cmwx1zzabz_t *self, int32_t *rssi, int32_t *snr)
+{
+    *rssi = self->_rssi;
+    *snr = self->_snr;
+
+    return true;
+}
+
+bool twr_cmwx1zzabz_factory_reset(twr_cmwx1zzabz_t *self)
+{
+    return _twr_cmwx1zzabz_start(self, _TWR_CMWX1ZZABZ_STATE_FACTORY_RESET, 500);
+}
+
+char *twr_cmwx1zzabz_get_fw_version(twr_cmwx1zzabz_t *self)
+{
+    return "sim";
+}
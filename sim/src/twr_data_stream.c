@@ -0,0 +1,232 @@
+#include <twr_data_stream.h>
+
+static int _twr_data_stream_compare_float(const void *a, const void *b);
+static int _twr_data_stream_compare_int(const void *a, const void *b);
+
+void twr_data_stream_init(twr_data_stream_t *self, int min_number_of_samples, twr_data_stream_buffer_t *buffer)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_buffer = buffer;
+    self->_min_number_of_samples = min_number_of_samples;
+}
+
+void twr_data_stream_feed(twr_data_stream_t *self, void *data)
+{
+    if (data == NULL)
+    {
+        twr_data_stream_reset(self);
+
+        return;
+    }
+
+    if (self->_buffer->type == TWR_DATA_STREAM_TYPE_FLOAT)
+    {
+        float value = *(float *) data;
+
+        if (isnan(value) || isinf(value))
+        {
+            twr_data_stream_reset(self);
+
+            return;
+        }
+
+        ((float *) self->_buffer->feed)[self->_feed_head] = value;
+    }
+    else
+    {
+        ((int *) self->_buffer->feed)[self->_feed_head] = *(int *) data;
+    }
+
+    self->_counter++;
+
+    if (++self->_feed_head == self->_buffer->number_of_samples)
+    {
+        self->_feed_head = 0;
+    }
+}
+
+void twr_data_stream_reset(twr_data_stream_t *self)
+{
+    self->_counter = 0;
+    self->_feed_head = 0;
+}
+
+int twr_data_stream_get_counter(twr_data_stream_t *self)
+{
+    return self->_counter;
+}
+
+int twr_data_stream_get_length(twr_data_stream_t *self)
+{
+    return self->_counter > self->_buffer->number_of_samples ? self->_buffer->number_of_samples : self->_counter;
+}
+
+twr_data_stream_type_t twr_data_stream_get_type(twr_data_stream_t *self)
+{
+    return self->_buffer->type;
+}
+
+int twr_data_stream_get_number_of_samples(twr_data_stream_t *self)
+{
+    return self->_buffer->number_of_samples;
+}
+
+bool twr_data_stream_get_average(twr_data_stream_t *self, void *result)
+{
+    if (self->_counter < self->_min_number_of_samples || self->_counter == 0)
+    {
+        return false;
+    }
+
+    int length = twr_data_stream_get_length(self);
+
+    if (self->_buffer->type == TWR_DATA_STREAM_TYPE_FLOAT)
+    {
+        float sum = 0;
+
+        for (int i = 0; i < length; i++)
+        {
+            sum += ((float *) self->_buffer->feed)[i];
+        }
+
+        *(float *) result = sum / length;
+    }
+    else
+    {
+        int64_t sum = 0;
+
+        for (int i = 0; i < length; i++)
+        {
+            sum += ((int *) self->_buffer->feed)[i];
+        }
+
+        *(int *) result = sum / length;
+    }
+
+    return true;
+}
+
+bool twr_data_stream_get_median(twr_data_stream_t *self, void *result)
+{
+    if (self->_counter < self->_min_number_of_samples || self->_counter == 0)
+    {
+        return false;
+    }
+
+    int length = twr_data_stream_get_length(self);
+
+    if (self->_buffer->type == TWR_DATA_STREAM_TYPE_FLOAT)
+    {
+        float *sort = self->_buffer->sort;
+
+        memcpy(sort, self->_buffer->feed, length * sizeof(float));
+        qsort(sort, length, sizeof(float), _twr_data_stream_compare_float);
+
+        *(float *) result = (length % 2 == 1) ? sort[length / 2] : (sort[length / 2 - 1] + sort[length / 2]) / 2.f;
+    }
+    else
+    {
+        int *sort = self->_buffer->sort;
+
+        memcpy(sort, self->_buffer->feed, length * sizeof(int));
+        qsort(sort, length, sizeof(int), _twr_data_stream_compare_int);
+
+        *(int *) result = (length % 2 == 1) ? sort[length / 2] : (sort[length / 2 - 1] + sort[length / 2]) / 2;
+    }
+
+    return true;
+}
+
+static bool _twr_data_stream_get_at(twr_data_stream_t *self, int position, void *result)
+{
+    if (self->_counter < self->_min_number_of_samples || self->_counter == 0)
+    {
+        return false;
+    }
+
+    if (self->_buffer->type == TWR_DATA_STREAM_TYPE_FLOAT)
+    {
+        *(float *) result = ((float *) self->_buffer->feed)[position];
+    }
+    else
+    {
+        *(int *) result = ((int *) self->_buffer->feed)[position];
+    }
+
+    return true;
+}
+
+bool twr_data_stream_get_first(twr_data_stream_t *self, void *result)
+{
+    int position = self->_counter > self->_buffer->number_of_samples ? self->_feed_head : 0;
+
+    return _twr_data_stream_get_at(self, position, result);
+}
+
+bool twr_data_stream_get_last(twr_data_stream_t *self, void *result)
+{
+    int position = self->_feed_head == 0 ? self->_buffer->number_of_samples - 1 : self->_feed_head - 1;
+
+    return _twr_data_stream_get_at(self, position, result);
+}
+
+static bool _twr_data_stream_get_extreme(twr_data_stream_t *self, void *result, int sign)
+{
+    if (!_twr_data_stream_get_at(self, 0, result))
+    {
+        return false;
+    }
+
+    int length = twr_data_stream_get_length(self);
+
+    for (int i = 1; i < length; i++)
+    {
+        if (self->_buffer->type == TWR_DATA_STREAM_TYPE_FLOAT)
+        {
+            float value = ((float *) self->_buffer->feed)[i];
+
+            if ((value - *(float *) result) * sign > 0)
+            {
+                *(float *) result = value;
+            }
+        }
+        else
+        {
+            int value = ((int *) self->_buffer->feed)[i];
+
+            if ((value - *(int *) result) * sign > 0)
+            {
+                *(int *) result = value;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool twr_data_stream_get_max(twr_data_stream_t *self, void *result)
+{
+    return _twr_data_stream_get_extreme(self, result, 1);
+}
+
+bool twr_data_stream_get_min(twr_data_stream_t *self, void *result)
+{
+    return _twr_data_stream_get_extreme(self, result, -1);
+}
+
+static int _twr_data_stream_compare_float(const void *a, const void *b)
+{
+    float fa = *(const float *) a;
+    float fb = *(const float *) b;
+
+    return (fa > fb) - (fa < fb);
+}
+
+static int _twr_data_stream_compare_int(const void *a, const void *b)
+{
+    int ia = *(const int *) a;
+    int ib = *(const int *) b;
+
+    return (ia > ib) - (ia < ib);
+}
@@ -0,0 +1,45 @@
+#include <twr_dice.h>
+
+void twr_dice_init(twr_dice_t *self, twr_dice_face_t start)
+{
+    self->_face = start;
+    self->_threshold = 0.4f;
+}
+
+void twr_dice_set_threshold(twr_dice_t *self, float threshold)
+{
+    self->_threshold = threshold;
+}
+
+void twr_dice_feed_vectors(twr_dice_t *self, float x_axis, float y_axis, float z_axis)
+{
+    if (z_axis >= self->_threshold)
+    {
+        self->_face = TWR_DICE_FACE_1;
+    }
+    else if (x_axis <= -self->_threshold)
+    {
+        self->_face = TWR_DICE_FACE_2;
+    }
+    else if (y_axis >= self->_threshold)
+    {
+        self->_face = TWR_DICE_FACE_3;
+    }
+    else if (y_axis <= -self->_threshold)
+    {
+        self->_face = TWR_DICE_FACE_4;
+    }
+    else if (x_axis >= self->_threshold)
+    {
+        self->_face = TWR_DICE_FACE_5;
+    }
+    else if (z_axis <= -self->_threshold)
+    {
+        self->_face = TWR_DICE_FACE_6;
+    }
+}
+
+twr_dice_face_t twr_dice_get_face(twr_dice_t *self)
+{
+    return self->_face;
+}
@@ -0,0 +1,20 @@
+#include <sim.h>
+
+void twr_led_init(twr_led_t *self, twr_gpio_channel_t gpio_channel, bool open_drain_output, int idle_state)
+{
+    self->_channel = gpio_channel;
+    self->_mode = TWR_LED_MODE_OFF;
+}
+
+void twr_led_set_mode(twr_led_t *self, twr_led_mode_t mode)
+{
+    self->_mode = mode;
+}
+
+void twr_led_pulse(twr_led_t *self, twr_tick_t duration)
+{
+}
+
+void twr_led_blink(twr_led_t *self, int count)
+{
+}
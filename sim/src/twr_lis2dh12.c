@@ -0,0 +1,161 @@
+#include <sim.h>
+
+#define _TWR_LIS2DH12_CONVERSION 10
+// Interrupt line to the event, the driver reads the interrupt source first
+#define _TWR_LIS2DH12_ALARM_DELAY 5
+
+static struct
+{
+    twr_lis2dh12_t *self;
+    sim_sensor_t sensor;
+    twr_lis2dh12_result_g_t result;
+    bool valid;
+
+    // Taken off the wall and laid on its back
+    bool moved;
+    twr_scheduler_task_id_t alarm_task_id;
+
+} _twr_lis2dh12;
+
+static twr_lis2dh12_result_g_t _twr_lis2dh12_result_g(void)
+{
+    // Wall mounted unit, gravity along the negative Y axis plus a little noise
+    twr_lis2dh12_result_g_t g = {
+        .x_axis = (float) ((int) (sim_env_rand() % 5) - 2) / 100.f,
+        .y_axis = -1.f + (float) ((int) (sim_env_rand() % 5) - 2) / 100.f,
+        .z_axis = (float) ((int) (sim_env_rand() % 5) - 2) / 100.f,
+    };
+
+    if (_twr_lis2dh12.moved)
+    {
+        g.y_axis += 1.f;
+        g.z_axis -= 1.f;
+    }
+
+    return g;
+}
+
+static void _twr_lis2dh12_alarm_task(void *param)
+{
+    twr_lis2dh12_t *self = param;
+
+    sim_i2c_transfer(self->_i2c_channel);
+
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(self, TWR_LIS2DH12_EVENT_ALARM, self->_event_param);
+    }
+}
+
+void sim_accelerometer_move(void)
+{
+    _twr_lis2dh12.moved = !_twr_lis2dh12.moved;
+
+    // Any move exceeds the threshold of a motion alarm
+    if (_twr_lis2dh12.self != NULL && _twr_lis2dh12.self->_alarm_active)
+    {
+        twr_scheduler_plan_from_now(_twr_lis2dh12.alarm_task_id, _TWR_LIS2DH12_ALARM_DELAY);
+    }
+}
+
+void sim_accelerometer_save(FILE *file)
+{
+    fwrite(&_twr_lis2dh12.moved, sizeof(_twr_lis2dh12.moved), 1, file);
+}
+
+bool sim_accelerometer_load(FILE *file)
+{
+    return fread(&_twr_lis2dh12.moved, sizeof(_twr_lis2dh12.moved), 1, file) == 1;
+}
+
+static void _twr_lis2dh12_done(void *param)
+{
+    twr_lis2dh12_t *self = param;
+
+    _twr_lis2dh12.result = _twr_lis2dh12_result_g();
+    _twr_lis2dh12.valid = true;
+
+    if (self->_event_handler != NULL)
+    {
+        self->_event_handler(self, TWR_LIS2DH12_EVENT_UPDATE, self->_event_param);
+    }
+}
+
+bool twr_lis2dh12_init(twr_lis2dh12_t *self, twr_i2c_channel_t i2c_channel, uint8_t i2c_address)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_i2c_channel = i2c_channel;
+    self->_i2c_address = i2c_address;
+    self->_update_interval = TWR_TICK_INFINITY;
+
+    _twr_lis2dh12.self = self;
+
+    sim_sensor_init(&_twr_lis2dh12.sensor, "lis2dh12", _TWR_LIS2DH12_CONVERSION, _twr_lis2dh12_done, self);
+    sim_sensor_set_i2c_channel(&_twr_lis2dh12.sensor, i2c_channel);
+
+    _twr_lis2dh12.alarm_task_id = twr_scheduler_register(_twr_lis2dh12_alarm_task, self, TWR_TICK_INFINITY);
+
+    sim_scheduler_set_task_name(_twr_lis2dh12.alarm_task_id, "lis2dh12/alarm");
+
+    return true;
+}
+
+void twr_lis2dh12_set_event_handler(twr_lis2dh12_t *self, void (*event_handler)(twr_lis2dh12_t *, twr_lis2dh12_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void twr_lis2dh12_set_update_interval(twr_lis2dh12_t *self, twr_tick_t interval)
+{
+    self->_update_interval = interval;
+
+    sim_sensor_set_update_interval(&_twr_lis2dh12.sensor, interval);
+}
+
+bool twr_lis2dh12_measure(twr_lis2dh12_t *self)
+{
+    return sim_sensor_measure(&_twr_lis2dh12.sensor);
+}
+
+bool twr_lis2dh12_get_result_g(twr_lis2dh12_t *self, twr_lis2dh12_result_g_t *result_g)
+{
+    if (!_twr_lis2dh12.valid)
+    {
+        return false;
+    }
+
+    *result_g = _twr_lis2dh12.result;
+
+    return true;
+}
+
+bool twr_lis2dh12_set_alarm(twr_lis2dh12_t *self, twr_lis2dh12_alarm_t *alarm)
+{
+    if (alarm == NULL)
+    {
+        self->_alarm_active = false;
+
+        return true;
+    }
+
+    self->_alarm = *alarm;
+    self->_alarm_active = true;
+
+    return true;
+}
+
+bool twr_lis2dh12_set_resolution(twr_lis2dh12_t *self, twr_lis2dh12_resolution_t resolution)
+{
+    self->_resolution = resolution;
+
+    return true;
+}
+
+bool twr_lis2dh12_set_scale(twr_lis2dh12_t *self, twr_lis2dh12_scale_t scale)
+{
+    self->_scale = scale;
+
+    return true;
+}
@@ -0,0 +1,104 @@
+#include <sim.h>
+
+#define _TWR_MODULE_BATTERY_CONVERSION 20
+
+// Drop of the pack voltage under the transmit current, grows as the cells deplete
+#define _TWR_MODULE_BATTERY_SAG 0.15f
+#define _TWR_MODULE_BATTERY_SAG_DEPLETED 0.5f
+
+static struct
+{
+    void (*event_handler)(twr_module_battery_event_t, void *);
+    void *event_param;
+    sim_sensor_t sensor;
+    float voltage;
+    float level_low_threshold;
+    float level_critical_threshold;
+
+} _twr_module_battery;
+
+static void _twr_module_battery_done(void *param);
+
+void twr_module_battery_init(void)
+{
+    memset(&_twr_module_battery, 0, sizeof(_twr_module_battery));
+
+    _twr_module_battery.voltage = NAN;
+    _twr_module_battery.level_low_threshold = 5.4f;
+    _twr_module_battery.level_critical_threshold = 5.0f;
+
+    sim_sensor_init(&_twr_module_battery.sensor, "battery", _TWR_MODULE_BATTERY_CONVERSION, _twr_module_battery_done, NULL);
+}
+
+void twr_module_battery_set_event_handler(void (*event_handler)(twr_module_battery_event_t, void *), void *event_param)
+{
+    _twr_module_battery.event_handler = event_handler;
+    _twr_module_battery.event_param = event_param;
+}
+
+void twr_module_battery_set_update_interval(twr_tick_t interval)
+{
+    sim_sensor_set_update_interval(&_twr_module_battery.sensor, interval);
+}
+
+void twr_module_battery_set_threshold_levels(float level_low_threshold, float level_critical_threshold)
+{
+    _twr_module_battery.level_low_threshold = level_low_threshold;
+    _twr_module_battery.level_critical_threshold = level_critical_threshold;
+}
+
+bool twr_module_battery_measure(void)
+{
+    return sim_sensor_measure(&_twr_module_battery.sensor);
+}
+
+bool twr_module_battery_get_voltage(float *voltage)
+{
+    *voltage = _twr_module_battery.voltage;
+
+    return !isnan(*voltage);
+}
+
+bool twr_module_battery_get_charge_level(int *percentage)
+{
+    if (isnan(_twr_module_battery.voltage))
+    {
+        return false;
+    }
+
+    float level = (_twr_module_battery.voltage - 4.8f) / (6.4f - 4.8f) * 100.f;
+
+    *percentage = level < 0 ? 0 : (level > 100 ? 100 : (int) level);
+
+    return true;
+}
+
+static void _twr_module_battery_done(void *param)
+{
+    _twr_module_battery.voltage = sim_env_get_voltage(twr_tick_get());
+
+    if (sim_radio_is_transmitting())
+    {
+        float depletion = (6.2f - _twr_module_battery.voltage) / (6.2f - 4.0f);
+
+        depletion = depletion < 0.f ? 0.f : (depletion > 1.f ? 1.f : depletion);
+
+        _twr_module_battery.voltage -= _TWR_MODULE_BATTERY_SAG + depletion * (_TWR_MODULE_BATTERY_SAG_DEPLETED - _TWR_MODULE_BATTERY_SAG);
+    }
+
+    if (_twr_module_battery.event_handler == NULL)
+    {
+        return;
+    }
+
+    _twr_module_battery.event_handler(TWR_MODULE_BATTERY_EVENT_UPDATE, _twr_module_battery.event_param);
+
+    if (_twr_module_battery.voltage < _twr_module_battery.level_critical_threshold)
+    {
+        _twr_module_battery.event_handler(TWR_MODULE_BATTERY_EVENT_LEVEL_CRITICAL, _twr_module_battery.event_param);
+    }
+    else if (_twr_module_battery.voltage < _twr_module_battery.level_low_threshold)
+    {
+        _twr_module_battery.event_handler(TWR_MODULE_BATTERY_EVENT_LEVEL_LOW, _twr_module_battery.event_param);
+    }
+}
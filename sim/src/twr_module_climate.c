@@ -0,0 +1,179 @@
+#include <sim.h>
+
+// Conversion times of TMP112, SHT20, OPT3001 and MPL3115A2 respectively
+#define _TWR_MODULE_CLIMATE_CONVERSION_THERMOMETER 35
+#define _TWR_MODULE_CLIMATE_CONVERSION_HYGROMETER 30
+#define _TWR_MODULE_CLIMATE_CONVERSION_LUX_METER 800
+#define _TWR_MODULE_CLIMATE_CONVERSION_BAROMETER 520
+
+static struct
+{
+    void (*event_handler)(twr_module_climate_event_t, void *);
+    void *event_param;
+    sim_sensor_t thermometer;
+    sim_sensor_t hygrometer;
+    sim_sensor_t lux_meter;
+    sim_sensor_t barometer;
+    float temperature;
+    float humidity;
+    float illuminance;
+    float pressure;
+
+} _twr_module_climate;
+
+static void _twr_module_climate_thermometer_done(void *param);
+static void _twr_module_climate_hygrometer_done(void *param);
+static void _twr_module_climate_lux_meter_done(void *param);
+static void _twr_module_climate_barometer_done(void *param);
+
+bool twr_module_climate_init(void)
+{
+    memset(&_twr_module_climate, 0, sizeof(_twr_module_climate));
+
+    _twr_module_climate.temperature = NAN;
+    _twr_module_climate.humidity = NAN;
+    _twr_module_climate.illuminance = NAN;
+    _twr_module_climate.pressure = NAN;
+
+    sim_sensor_init(&_twr_module_climate.thermometer, "climate/thermometer", _TWR_MODULE_CLIMATE_CONVERSION_THERMOMETER, _twr_module_climate_thermometer_done, NULL);
+    sim_sensor_init(&_twr_module_climate.hygrometer, "climate/hygrometer", _TWR_MODULE_CLIMATE_CONVERSION_HYGROMETER, _twr_module_climate_hygrometer_done, NULL);
+    sim_sensor_init(&_twr_module_climate.lux_meter, "climate/lux_meter", _TWR_MODULE_CLIMATE_CONVERSION_LUX_METER, _twr_module_climate_lux_meter_done, NULL);
+    sim_sensor_init(&_twr_module_climate.barometer, "climate/barometer", _TWR_MODULE_CLIMATE_CONVERSION_BAROMETER, _twr_module_climate_barometer_done, NULL);
+
+    sim_sensor_set_i2c_channel(&_twr_module_climate.thermometer, TWR_I2C_I2C0);
+    sim_sensor_set_i2c_channel(&_twr_module_climate.hygrometer, TWR_I2C_I2C0);
+    sim_sensor_set_i2c_channel(&_twr_module_climate.lux_meter, TWR_I2C_I2C0);
+    sim_sensor_set_i2c_channel(&_twr_module_climate.barometer, TWR_I2C_I2C0);
+
+    return true;
+}
+
+void twr_module_climate_set_event_handler(void (*event_handler)(twr_module_climate_event_t, void *), void *event_param)
+{
+    _twr_module_climate.event_handler = event_handler;
+    _twr_module_climate.event_param = event_param;
+}
+
+void twr_module_climate_set_update_interval(twr_tick_t interval)
+{
+    twr_module_climate_set_update_interval_thermometer(interval);
+    twr_module_climate_set_update_interval_hygrometer(interval);
+    twr_module_climate_set_update_interval_lux_meter(interval);
+    twr_module_climate_set_update_interval_barometer(interval);
+}
+
+void twr_module_climate_set_update_interval_thermometer(twr_tick_t interval)
+{
+    sim_sensor_set_update_interval(&_twr_module_climate.thermometer, interval);
+}
+
+void twr_module_climate_set_update_interval_hygrometer(twr_tick_t interval)
+{
+    sim_sensor_set_update_interval(&_twr_module_climate.hygrometer, interval);
+}
+
+void twr_module_climate_set_update_interval_lux_meter(twr_tick_t interval)
+{
+    sim_sensor_set_update_interval(&_twr_module_climate.lux_meter, interval);
+}
+
+void twr_module_climate_set_update_interval_barometer(twr_tick_t interval)
+{
+    sim_sensor_set_update_interval(&_twr_module_climate.barometer, interval);
+}
+
+bool twr_module_climate_measure_all_sensors(void)
+{
+    bool ret = true;
+
+    ret &= twr_module_climate_measure_thermometer();
+    ret &= twr_module_climate_measure_hygrometer();
+    ret &= twr_module_climate_measure_lux_meter();
+    ret &= twr_module_climate_measure_barometer();
+
+    return ret;
+}
+
+bool twr_module_climate_measure_thermometer(void)
+{
+    return sim_sensor_measure(&_twr_module_climate.thermometer);
+}
+
+bool twr_module_climate_measure_hygrometer(void)
+{
+    return sim_sensor_measure(&_twr_module_climate.hygrometer);
+}
+
+bool twr_module_climate_measure_lux_meter(void)
+{
+    return sim_sensor_measure(&_twr_module_climate.lux_meter);
+}
+
+bool twr_module_climate_measure_barometer(void)
+{
+    return sim_sensor_measure(&_twr_module_climate.barometer);
+}
+
+bool twr_module_climate_get_temperature_celsius(float *celsius)
+{
+    *celsius = _twr_module_climate.temperature;
+
+    return !isnan(*celsius);
+}
+
+bool twr_module_climate_get_humidity_percentage(float *percentage)
+{
+    *percentage = _twr_module_climate.humidity;
+
+    return !isnan(*percentage);
+}
+
+bool twr_module_climate_get_illuminance_lux(float *lux)
+{
+    *lux = _twr_module_climate.illuminance;
+
+    return !isnan(*lux);
+}
+
+bool twr_module_climate_get_pressure_pascal(float *pascal)
+{
+    *pascal = _twr_module_climate.pressure;
+
+    return !isnan(*pascal);
+}
+
+static void _twr_module_climate_event(twr_module_climate_event_t event)
+{
+    if (_twr_module_climate.event_handler != NULL)
+    {
+        _twr_module_climate.event_handler(event, _twr_module_climate.event_param);
+    }
+}
+
+static void _twr_module_climate_thermometer_done(void *param)
+{
+    _twr_module_climate.temperature = sim_env_get_temperature(twr_tick_get());
+
+    _twr_module_climate_event(TWR_MODULE_CLIMATE_EVENT_UPDATE_THERMOMETER);
+}
+
+static void _twr_module_climate_hygrometer_done(void *param)
+{
+    _twr_module_climate.humidity = sim_env_get_humidity(twr_tick_get());
+
+    _twr_module_climate_event(TWR_MODULE_CLIMATE_EVENT_UPDATE_HYGROMETER);
+}
+
+static void _twr_module_climate_lux_meter_done(void *param)
+{
+    _twr_module_climate.illuminance = sim_env_get_illuminance(twr_tick_get());
+
+    _twr_module_climate_event(TWR_MODULE_CLIMATE_EVENT_UPDATE_LUX_METER);
+}
+
+static void _twr_module_climate_barometer_done(void *param)
+{
+    _twr_module_climate.pressure = sim_env_get_pressure(twr_tick_get());
+
+    _twr_module_climate_event(TWR_MODULE_CLIMATE_EVENT_UPDATE_BAROMETER);
+}
@@ -0,0 +1,70 @@
+#include <sim.h>
+
+// LP8 charge of the boost capacitor plus the measurement itself
+#define _TWR_MODULE_CO2_CONVERSION 8000
+
+static struct
+{
+    void (*event_handler)(twr_module_co2_event_t, void *);
+    void *event_param;
+    sim_sensor_t sensor;
+    float concentration;
+    twr_lp8_calibration_t calibration;
+    bool calibration_pending;
+
+} _twr_module_co2;
+
+static void _twr_module_co2_done(void *param);
+
+void twr_module_co2_init(void)
+{
+    memset(&_twr_module_co2, 0, sizeof(_twr_module_co2));
+
+    _twr_module_co2.concentration = NAN;
+
+    sim_sensor_init(&_twr_module_co2.sensor, "co2", _TWR_MODULE_CO2_CONVERSION, _twr_module_co2_done, NULL);
+
+    // LP8 behind the expander of the module
+    sim_sensor_set_i2c_channel(&_twr_module_co2.sensor, TWR_I2C_I2C0);
+}
+
+void twr_module_co2_set_event_handler(void (*event_handler)(twr_module_co2_event_t, void *), void *event_param)
+{
+    _twr_module_co2.event_handler = event_handler;
+    _twr_module_co2.event_param = event_param;
+}
+
+void twr_module_co2_set_update_interval(twr_tick_t interval)
+{
+    sim_sensor_set_update_interval(&_twr_module_co2.sensor, interval);
+}
+
+void twr_module_co2_measure(void)
+{
+    sim_sensor_measure(&_twr_module_co2.sensor);
+}
+
+bool twr_module_co2_get_concentration_ppm(float *ppm)
+{
+    *ppm = _twr_module_co2.concentration;
+
+    return !isnan(*ppm);
+}
+
+void twr_module_co2_calibration(twr_lp8_calibration_t calibration)
+{
+    _twr_module_co2.calibration = calibration;
+    _twr_module_co2.calibration_pending = true;
+}
+
+static void _twr_module_co2_done(void *param)
+{
+    _twr_module_co2.calibration_pending = false;
+
+    _twr_module_co2.concentration = sim_env_get_co2(twr_tick_get());
+
+    if (_twr_module_co2.event_handler != NULL)
+    {
+        _twr_module_co2.event_handler(TWR_MODULE_CO2_EVENT_UPDATE, _twr_module_co2.event_param);
+    }
+}
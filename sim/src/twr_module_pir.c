@@ -0,0 +1,88 @@
+#include <sim.h>
+
+// Mean time between motion interrupts in an occupied room and the blind time of the sensor
+#define _TWR_MODULE_PIR_MOTION_MEAN_INTERVAL (45 * 1000)
+#define _TWR_MODULE_PIR_BLIND_TIME (5 * 1000)
+#define _TWR_MODULE_PIR_IDLE_STEP (5 * 60 * 1000)
+
+static struct
+{
+    twr_module_pir_t *self;
+    twr_scheduler_task_id_t task_id;
+
+} _twr_module_pir;
+
+static twr_tick_t _twr_module_pir_next_interval(void)
+{
+    // Exponential distribution approximated with the inverse CDF
+    float u = (float) (sim_env_rand() % 10000 + 1) / 10001.f;
+
+    return _TWR_MODULE_PIR_BLIND_TIME + (twr_tick_t) (-logf(u) * _TWR_MODULE_PIR_MOTION_MEAN_INTERVAL);
+}
+
+// Models the motion interrupt line: the task only runs when the PIR would raise an interrupt
+static void _twr_module_pir_task(void *param)
+{
+    twr_module_pir_t *self = param;
+
+    twr_tick_t now = twr_tick_get();
+
+    if (sim_trace_is_loaded())
+    {
+        // Recorded motions, the task is planned exactly at each of them
+        if (sim_trace_next_event(SIM_TRACE_MOTION, now) == now && self->_event_handler != NULL)
+        {
+            self->_event_handler(self, TWR_MODULE_PIR_EVENT_MOTION, self->_event_param);
+        }
+
+        twr_scheduler_plan_current_absolute(sim_trace_next_event(SIM_TRACE_MOTION, now + 1));
+
+        return;
+    }
+
+    if (sim_env_is_occupied(now))
+    {
+        if (self->_event_handler != NULL)
+        {
+            self->_event_handler(self, TWR_MODULE_PIR_EVENT_MOTION, self->_event_param);
+        }
+
+        twr_scheduler_plan_current_absolute(now + _twr_module_pir_next_interval());
+
+        return;
+    }
+
+    // Skip forward to the next occupancy without waking the MCU
+    twr_tick_t next = now;
+
+    do
+    {
+        next += _TWR_MODULE_PIR_IDLE_STEP;
+    }
+    while (!sim_env_is_occupied(next) && next - now < 8 * SIM_DAY);
+
+    twr_scheduler_plan_current_absolute(next + sim_env_rand() % _TWR_MODULE_PIR_IDLE_STEP);
+}
+
+void twr_module_pir_init(twr_module_pir_t *self)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_sensitivity = TWR_MODULE_PIR_SENSITIVITY_HIGH;
+
+    _twr_module_pir.self = self;
+    _twr_module_pir.task_id = twr_scheduler_register(_twr_module_pir_task, self, 0);
+
+    sim_scheduler_set_task_name(_twr_module_pir.task_id, "pir");
+}
+
+void twr_module_pir_set_event_handler(twr_module_pir_t *self, void (*event_handler)(twr_module_pir_t *, twr_module_pir_event_t, void *), void *event_param)
+{
+    self->_event_handler = event_handler;
+    self->_event_param = event_param;
+}
+
+void twr_module_pir_set_sensitivity(twr_module_pir_t *self, twr_module_pir_sensitivity_t sensitivity)
+{
+    self->_sensitivity = sensitivity;
+}
@@ -0,0 +1,261 @@
+#define _GNU_SOURCE
+
+#include <sim.h>
+#include <time.h>
+#include <dlfcn.h>
+
+static struct
+{
+    struct
+    {
+        void (*task)(void *);
+        void *param;
+        const char *name;
+        twr_tick_t tick;
+        uint64_t calls;
+        uint64_t cpu_ns;
+
+    } pool[TWR_SCHEDULER_MAX_TASKS];
+
+    size_t max_task_id;
+    twr_scheduler_task_id_t current_task_id;
+    twr_tick_t tick;
+    twr_tick_t tick_spin;
+    uint64_t wakeups;
+
+    // Counted before the last reboot, the tasks register in the same order again
+    struct
+    {
+        uint64_t calls;
+        uint64_t cpu_ns;
+
+    } carried[TWR_SCHEDULER_MAX_TASKS];
+
+} _twr_scheduler;
+
+static uint64_t _twr_scheduler_host_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+twr_tick_t twr_tick_get(void)
+{
+    return _twr_scheduler.tick;
+}
+
+void twr_scheduler_init(void)
+{
+    memset(&_twr_scheduler, 0, sizeof(_twr_scheduler));
+}
+
+void twr_scheduler_run(void)
+{
+    sim_scheduler_run_until(TWR_TICK_INFINITY);
+}
+
+void sim_scheduler_run_until(twr_tick_t end)
+{
+    for (;;)
+    {
+        twr_tick_t next = TWR_TICK_INFINITY;
+
+        for (size_t i = 0; i <= _twr_scheduler.max_task_id; i++)
+        {
+            if (_twr_scheduler.pool[i].task != NULL && _twr_scheduler.pool[i].tick < next)
+            {
+                next = _twr_scheduler.pool[i].tick;
+            }
+        }
+
+        if (next == TWR_TICK_INFINITY || next > end)
+        {
+            if (end != TWR_TICK_INFINITY)
+            {
+                _twr_scheduler.tick = end;
+            }
+
+            return;
+        }
+
+        if (next > _twr_scheduler.tick)
+        {
+            // The MCU would sleep until the next planned task, every jump is one exit from stop mode
+            _twr_scheduler.tick = next;
+            _twr_scheduler.wakeups++;
+        }
+
+        _twr_scheduler.tick_spin = _twr_scheduler.tick;
+
+        for (_twr_scheduler.current_task_id = 0; _twr_scheduler.current_task_id <= _twr_scheduler.max_task_id; _twr_scheduler.current_task_id++)
+        {
+            size_t i = _twr_scheduler.current_task_id;
+
+            if (_twr_scheduler.pool[i].task != NULL && _twr_scheduler.pool[i].tick <= _twr_scheduler.tick_spin)
+            {
+                _twr_scheduler.pool[i].tick = TWR_TICK_INFINITY;
+
+                uint64_t start = _twr_scheduler_host_ns();
+
+                _twr_scheduler.pool[i].task(_twr_scheduler.pool[i].param);
+
+                _twr_scheduler.pool[i].cpu_ns += _twr_scheduler_host_ns() - start;
+                _twr_scheduler.pool[i].calls++;
+            }
+        }
+
+        _twr_scheduler.current_task_id = 0;
+    }
+}
+
+void sim_scheduler_set_tick(twr_tick_t tick)
+{
+    _twr_scheduler.tick = tick;
+}
+
+void sim_scheduler_save(FILE *file)
+{
+    for (size_t i = 0; i < TWR_SCHEDULER_MAX_TASKS; i++)
+    {
+        _twr_scheduler.carried[i].calls += _twr_scheduler.pool[i].calls;
+        _twr_scheduler.carried[i].cpu_ns += _twr_scheduler.pool[i].cpu_ns;
+    }
+
+    fwrite(&_twr_scheduler.tick, sizeof(_twr_scheduler.tick), 1, file);
+    fwrite(&_twr_scheduler.wakeups, sizeof(_twr_scheduler.wakeups), 1, file);
+    fwrite(_twr_scheduler.carried, sizeof(_twr_scheduler.carried), 1, file);
+}
+
+bool sim_scheduler_load(FILE *file)
+{
+    return fread(&_twr_scheduler.tick, sizeof(_twr_scheduler.tick), 1, file) == 1 &&
+           fread(&_twr_scheduler.wakeups, sizeof(_twr_scheduler.wakeups), 1, file) == 1 &&
+           fread(_twr_scheduler.carried, sizeof(_twr_scheduler.carried), 1, file) == 1;
+}
+
+uint64_t sim_scheduler_get_wakeups(void)
+{
+    return _twr_scheduler.wakeups;
+}
+
+int sim_scheduler_get_task_stats(sim_task_stats_t *stats, int length)
+{
+    int count = 0;
+
+    for (size_t i = 0; i <= _twr_scheduler.max_task_id && count < length; i++)
+    {
+        if (_twr_scheduler.pool[i].task == NULL)
+        {
+            continue;
+        }
+
+        Dl_info info;
+
+        stats[count].task = _twr_scheduler.pool[i].task;
+        stats[count].name = _twr_scheduler.pool[i].name != NULL ? _twr_scheduler.pool[i].name : (dladdr((void *) _twr_scheduler.pool[i].task, &info) && info.dli_sname) ? info.dli_sname : "?";
+        stats[count].calls = _twr_scheduler.pool[i].calls + _twr_scheduler.carried[i].calls;
+        stats[count].cpu_ns = _twr_scheduler.pool[i].cpu_ns + _twr_scheduler.carried[i].cpu_ns;
+
+        count++;
+    }
+
+    return count;
+}
+
+void sim_scheduler_set_task_name(twr_scheduler_task_id_t task_id, const char *name)
+{
+    _twr_scheduler.pool[task_id].name = name;
+}
+
+twr_scheduler_task_id_t twr_scheduler_register(void (*task)(void *), void *param, twr_tick_t tick)
+{
+    for (size_t i = 0; i < TWR_SCHEDULER_MAX_TASKS; i++)
+    {
+        if (_twr_scheduler.pool[i].task == NULL)
+        {
+            _twr_scheduler.pool[i].task = task;
+            _twr_scheduler.pool[i].param = param;
+            _twr_scheduler.pool[i].name = NULL;
+            _twr_scheduler.pool[i].tick = tick;
+            _twr_scheduler.pool[i].calls = 0;
+            _twr_scheduler.pool[i].cpu_ns = 0;
+
+            if (_twr_scheduler.max_task_id < i)
+            {
+                _twr_scheduler.max_task_id = i;
+            }
+
+            return i;
+        }
+    }
+
+    fprintf(stderr, "sim: scheduler pool exhausted\n");
+
+    abort();
+}
+
+void twr_scheduler_unregister(twr_scheduler_task_id_t task_id)
+{
+    _twr_scheduler.pool[task_id].task = NULL;
+}
+
+twr_scheduler_task_id_t twr_scheduler_get_current_task_id(void)
+{
+    return _twr_scheduler.current_task_id;
+}
+
+twr_tick_t twr_scheduler_get_spin_tick(void)
+{
+    return _twr_scheduler.tick_spin;
+}
+
+void twr_scheduler_disable_sleep(void)
+{
+}
+
+void twr_scheduler_enable_sleep(void)
+{
+}
+
+void twr_scheduler_plan_now(twr_scheduler_task_id_t task_id)
+{
+    _twr_scheduler.pool[task_id].tick = 0;
+}
+
+void twr_scheduler_plan_absolute(twr_scheduler_task_id_t task_id, twr_tick_t tick)
+{
+    _twr_scheduler.pool[task_id].tick = tick;
+}
+
+void twr_scheduler_plan_relative(twr_scheduler_task_id_t task_id, twr_tick_t tick)
+{
+    _twr_scheduler.pool[task_id].tick = _twr_scheduler.tick_spin + tick;
+}
+
+void twr_scheduler_plan_from_now(twr_scheduler_task_id_t task_id, twr_tick_t tick)
+{
+    _twr_scheduler.pool[task_id].tick = twr_tick_get() + tick;
+}
+
+void twr_scheduler_plan_current_now(void)
+{
+    twr_scheduler_plan_now(_twr_scheduler.current_task_id);
+}
+
+void twr_scheduler_plan_current_absolute(twr_tick_t tick)
+{
+    twr_scheduler_plan_absolute(_twr_scheduler.current_task_id, tick);
+}
+
+void twr_scheduler_plan_current_relative(twr_tick_t tick)
+{
+    twr_scheduler_plan_relative(_twr_scheduler.current_task_id, tick);
+}
+
+void twr_scheduler_plan_current_from_now(twr_tick_t tick)
+{
+    twr_scheduler_plan_from_now(_twr_scheduler.current_task_id, tick);
+}
@@ -0,0 +1,133 @@
+#include <sim.h>
+#include <time.h>
+
+// STM32L083 data EEPROM size
+#define _TWR_EEPROM_SIZE 6144
+
+static struct
+{
+    uint8_t eeprom[_TWR_EEPROM_SIZE];
+    struct timespec timer_start;
+
+    // Holders of the system clock, the bus sessions opened while it is held
+    int pll;
+    bool session[SIM_I2C_CHANNELS];
+    sim_i2c_stats_t i2c[SIM_I2C_CHANNELS];
+
+} _twr_system;
+
+void twr_system_init(void)
+{
+    memset(_twr_system.eeprom, 0, sizeof(_twr_system.eeprom));
+}
+
+void twr_system_reset(void)
+{
+    twr_atci_printf("$SIM: \"SYSTEM RESET\"");
+
+    sim_reboot(false);
+}
+
+void sim_system_save(FILE *file)
+{
+    fwrite(_twr_system.eeprom, sizeof(_twr_system.eeprom), 1, file);
+    fwrite(_twr_system.i2c, sizeof(_twr_system.i2c), 1, file);
+}
+
+bool sim_system_load(FILE *file)
+{
+    return fread(_twr_system.eeprom, sizeof(_twr_system.eeprom), 1, file) == 1 &&
+           fread(_twr_system.i2c, sizeof(_twr_system.i2c), 1, file) == 1;
+}
+
+void twr_system_pll_enable(void)
+{
+    _twr_system.pll++;
+}
+
+void twr_system_pll_disable(void)
+{
+    if (_twr_system.pll > 0 && --_twr_system.pll == 0)
+    {
+        memset(_twr_system.session, 0, sizeof(_twr_system.session));
+    }
+}
+
+void sim_i2c_transfer(twr_i2c_channel_t channel)
+{
+    if (channel < 0 || channel >= SIM_I2C_CHANNELS)
+    {
+        return;
+    }
+
+    _twr_system.i2c[channel].transfers++;
+
+    // Without the clock held up every transfer starts and stops it on its own
+    if (_twr_system.pll == 0 || !_twr_system.session[channel])
+    {
+        _twr_system.i2c[channel].sessions++;
+    }
+
+    _twr_system.session[channel] = _twr_system.pll > 0;
+}
+
+void sim_i2c_get_stats(twr_i2c_channel_t channel, sim_i2c_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    if (channel >= 0 && channel < SIM_I2C_CHANNELS)
+    {
+        *stats = _twr_system.i2c[channel];
+    }
+}
+
+bool twr_eeprom_write(uint32_t address, const void *buffer, size_t length)
+{
+    if (address + length > sizeof(_twr_system.eeprom))
+    {
+        return false;
+    }
+
+    memcpy(_twr_system.eeprom + address, buffer, length);
+
+    return true;
+}
+
+bool twr_eeprom_read(uint32_t address, void *buffer, size_t length)
+{
+    if (address + length > sizeof(_twr_system.eeprom))
+    {
+        return false;
+    }
+
+    memcpy(buffer, _twr_system.eeprom + address, length);
+
+    return true;
+}
+
+size_t twr_eeprom_get_size(void)
+{
+    return sizeof(_twr_system.eeprom);
+}
+
+void twr_timer_init(void)
+{
+}
+
+void twr_timer_start(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &_twr_system.timer_start);
+}
+
+uint16_t twr_timer_get_microseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint16_t) ((now.tv_sec - _twr_system.timer_start.tv_sec) * 1000000 + (now.tv_nsec - _twr_system.timer_start.tv_nsec) / 1000);
+}
+
+void twr_timer_stop(void)
+{
+}
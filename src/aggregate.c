@@ -0,0 +1,157 @@
+#include <aggregate.h>
+
+// Samples are accumulated as differences from the first one of the interval, the sums stay
+// small and the variance is exact: n * sum(d^2) - sum(d)^2 over n^2
+
+static uint32_t _aggregate_sqrt(uint64_t value);
+
+void aggregate_init(aggregate_t *self)
+{
+    memset(self, 0, sizeof(*self));
+}
+
+void aggregate_feed(aggregate_t *self, int32_t value)
+{
+    self->_last = value;
+    self->_last_valid = true;
+
+    if (self->_count == UINT16_MAX)
+    {
+        return;
+    }
+
+    if (self->_count++ == 0)
+    {
+        self->_offset = value;
+        self->_sum = 0;
+        self->_sum_squares = 0;
+        self->_min = value;
+        self->_max = value;
+
+        return;
+    }
+
+    int32_t delta = value - self->_offset;
+
+    self->_sum += delta;
+    self->_sum_squares += (uint64_t) ((int64_t) delta * delta);
+
+    if (value < self->_min)
+    {
+        self->_min = value;
+    }
+
+    if (value > self->_max)
+    {
+        self->_max = value;
+    }
+}
+
+void aggregate_invalidate(aggregate_t *self)
+{
+    aggregate_init(self);
+}
+
+void aggregate_reset(aggregate_t *self)
+{
+    self->_count = 0;
+}
+
+int aggregate_get_count(aggregate_t *self)
+{
+    return self->_count;
+}
+
+bool aggregate_get_mean(aggregate_t *self, int32_t *result)
+{
+    if (self->_count == 0)
+    {
+        return false;
+    }
+
+    int64_t half = self->_count / 2;
+
+    *result = self->_offset + (self->_sum >= 0 ? self->_sum + half : self->_sum - half) / self->_count;
+
+    return true;
+}
+
+bool aggregate_get_min(aggregate_t *self, int32_t *result)
+{
+    if (self->_count == 0)
+    {
+        return false;
+    }
+
+    *result = self->_min;
+
+    return true;
+}
+
+bool aggregate_get_max(aggregate_t *self, int32_t *result)
+{
+    if (self->_count == 0)
+    {
+        return false;
+    }
+
+    *result = self->_max;
+
+    return true;
+}
+
+bool aggregate_get_stddev(aggregate_t *self, int32_t *result)
+{
+    if (self->_count == 0)
+    {
+        return false;
+    }
+
+    uint64_t n = self->_count;
+    uint64_t sum = self->_sum < 0 ? -(int64_t) self->_sum : self->_sum;
+
+    *result = _aggregate_sqrt((n * self->_sum_squares - sum * sum) / (n * n));
+
+    return true;
+}
+
+bool aggregate_get_last(aggregate_t *self, int32_t *result)
+{
+    if (!self->_last_valid)
+    {
+        return false;
+    }
+
+    *result = self->_last;
+
+    return true;
+}
+
+// Bitwise integer square root rounded down
+static uint32_t _aggregate_sqrt(uint64_t value)
+{
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t) 1 << 62;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+
+        bit >>= 2;
+    }
+
+    return (uint32_t) root;
+}
@@ -0,0 +1,164 @@
+#include <airtime.h>
+#include <lorawan.h>
+#include <twr.h>
+
+#define AIRTIME_HOUR (60 * 60 * 1000)
+
+// Off-time after an uplink is 99 times its time on air, counted here from the start of the uplink
+#define AIRTIME_DUTY_CYCLE_FACTOR 100
+
+static struct
+{
+    twr_cmwx1zzabz_t *lora;
+    uint32_t budget;
+
+    // Milliseconds of time on air multiplied by the ticks of an hour, negative after an uplink larger than the bucket
+    int64_t tokens;
+    twr_tick_t refill_tick;
+
+    twr_tick_t off_time_end;
+
+    // Time on air of one transmission of the last uplink
+    uint32_t last;
+
+    airtime_stats_t stats;
+
+} _airtime;
+
+static void _airtime_refill(void);
+static void _airtime_charge(uint32_t airtime);
+static int64_t _airtime_size(void);
+
+void airtime_init(twr_cmwx1zzabz_t *lora)
+{
+    memset(&_airtime, 0, sizeof(_airtime));
+
+    _airtime.lora = lora;
+
+    airtime_set_budget(AIRTIME_BUDGET_DEFAULT);
+
+    _airtime.tokens = _airtime_size();
+}
+
+uint32_t airtime_get(size_t length)
+{
+    uint8_t repeat = twr_cmwx1zzabz_get_repeat_unconfirmed(_airtime.lora);
+
+    uint32_t airtime = lorawan_get_airtime(twr_cmwx1zzabz_get_band(_airtime.lora),
+                                           twr_cmwx1zzabz_get_datarate(_airtime.lora), length);
+
+    return airtime * (repeat > 1 ? repeat : 1);
+}
+
+twr_tick_t airtime_get_delay(size_t length)
+{
+    _airtime_refill();
+
+    twr_tick_t now = twr_tick_get();
+    twr_tick_t delay = _airtime.off_time_end > now ? _airtime.off_time_end - now : 0;
+
+    int64_t cost = (int64_t) airtime_get(length) * AIRTIME_HOUR;
+
+    // Uplink larger than the whole bucket waits until it is full and borrows the rest
+    if (cost > _airtime_size())
+    {
+        cost = _airtime_size();
+    }
+
+    if (_airtime.tokens < cost)
+    {
+        twr_tick_t refill = (cost - _airtime.tokens + _airtime.budget - 1) / _airtime.budget;
+
+        if (refill > delay)
+        {
+            delay = refill;
+        }
+    }
+
+    return delay;
+}
+
+void airtime_sent(size_t length, bool confirmed)
+{
+    _airtime.last = lorawan_get_airtime(twr_cmwx1zzabz_get_band(_airtime.lora),
+                                        twr_cmwx1zzabz_get_datarate(_airtime.lora), length);
+
+    // Confirmed uplink is transmitted once, every retry is charged when it happens
+    _airtime_charge(confirmed ? _airtime.last : airtime_get(length));
+
+    _airtime.stats.uplinks++;
+}
+
+void airtime_retransmitted(void)
+{
+    _airtime_charge(_airtime.last);
+}
+
+void airtime_deferred(void)
+{
+    _airtime.stats.deferred++;
+}
+
+void airtime_set_budget(uint32_t budget)
+{
+    _airtime_refill();
+
+    _airtime.budget = budget;
+
+    // Lower budget cuts what is left
+    if (_airtime.tokens > _airtime_size())
+    {
+        _airtime.tokens = _airtime_size();
+    }
+}
+
+uint32_t airtime_get_budget(void)
+{
+    return _airtime.budget;
+}
+
+uint32_t airtime_get_available(void)
+{
+    _airtime_refill();
+
+    return _airtime.tokens > 0 ? _airtime.tokens / AIRTIME_HOUR : 0;
+}
+
+void airtime_get_stats(airtime_stats_t *stats)
+{
+    *stats = _airtime.stats;
+}
+
+static void _airtime_refill(void)
+{
+    twr_tick_t now = twr_tick_get();
+
+    _airtime.tokens += (int64_t) (now - _airtime.refill_tick) * _airtime.budget;
+
+    if (_airtime.tokens > _airtime_size())
+    {
+        _airtime.tokens = _airtime_size();
+    }
+
+    _airtime.refill_tick = now;
+}
+
+static void _airtime_charge(uint32_t airtime)
+{
+    _airtime_refill();
+
+    _airtime.tokens -= (int64_t) airtime * AIRTIME_HOUR;
+
+    // Only EU868 limits every sub-band by the duty cycle, the other bands are limited by the budget alone
+    if (twr_cmwx1zzabz_get_band(_airtime.lora) == TWR_CMWX1ZZABZ_CONFIG_BAND_EU868)
+    {
+        _airtime.off_time_end = twr_tick_get() + (twr_tick_t) airtime * AIRTIME_DUTY_CYCLE_FACTOR;
+    }
+
+    _airtime.stats.used += airtime;
+}
+
+static int64_t _airtime_size(void)
+{
+    return (int64_t) _airtime.budget * AIRTIME_HOUR;
+}
@@ -1,10 +1,58 @@
 #include <application.h>
 #include <at.h>
-
-#define SEND_DATA_INTERVAL          (15 * 60 * 1000)
-#define MEASURE_INTERVAL            (1 * 60 * 1000)
-#define MEASURE_INTERVAL_BAROMETER  (5 * 60 * 1000)
-#define MEASURE_INTERVAL_CO2        (5 * 60 * 1000)
+#include <profile.h>
+#include <payload.h>
+#include <batch.h>
+#include <lorawan.h>
+#include <co2_sampling.h>
+#include <threshold.h>
+#include <report.h>
+#include <backfill.h>
+#include <aggregate.h>
+#include <config.h>
+#include <downlink.h>
+#include <airtime.h>
+#include <slot.h>
+#include <link.h>
+#include <uplink.h>
+#include <join.h>
+#include <occupancy.h>
+#include <filter.h>
+#include <wake.h>
+#include <battery.h>
+#include <power.h>
+
+// Smallest Hampel limit per stream in the unit of its samples
+#define FILTER_FLOOR_TEMPERATURE    50
+#define FILTER_FLOOR_HUMIDITY       20
+#define FILTER_FLOOR_ILLUMINANCE    50
+#define FILTER_FLOOR_PRESSURE       50
+#define FILTER_FLOOR_CO2            30
+
+// Battery measured at rest between the transmissions
+#define BATTERY_REST_INTERVAL       (60 * 60 * 1000)
+
+// Intervals and settings, see config.h
+#define EEPROM_CONFIG_ADDRESS       0x0000
+
+// OTAA session, see join.c
+#define EEPROM_SESSION_ADDRESS      0x0040
+
+// EEPROM ring log of send intervals, 200 records
+#define EEPROM_RINGLOG_ADDRESS      0x0100
+#define EEPROM_RINGLOG_SIZE         2404
+
+// Downlink commands, see README
+#define DOWNLINK_SET_INTERVALS      0x01
+#define DOWNLINK_SET_THRESHOLDS     0x02
+#define DOWNLINK_SET_DATARATE       0x03
+#define DOWNLINK_CALIBRATION        0x04
+#define DOWNLINK_STATUS             0x05
+#define DOWNLINK_REBOOT             0x06
+
+// Accelerometer wakes the MCU only on motion, the face is read once the unit is still again
+#define ORIENTATION_ALARM_THRESHOLD 0.25f
+#define ORIENTATION_SETTLE_DELAY (2 * 1000)
 
 #define CALIBRATION_START_DELAY (15 * 60 * 1000)
 #define CALIBRATION_MEASURE_INTERVAL (2 * 60 * 1000)
@@ -23,36 +71,78 @@ twr_module_pir_t pir;
 
 uint32_t pir_motion_count = 0;
 
-TWR_DATA_STREAM_FLOAT_BUFFER(sm_voltage_buffer, 8)
-TWR_DATA_STREAM_FLOAT_BUFFER(sm_temperature_buffer, (SEND_DATA_INTERVAL / MEASURE_INTERVAL))
-TWR_DATA_STREAM_FLOAT_BUFFER(sm_humidity_buffer, (SEND_DATA_INTERVAL / MEASURE_INTERVAL))
-TWR_DATA_STREAM_FLOAT_BUFFER(sm_illuminance_buffer, (SEND_DATA_INTERVAL / MEASURE_INTERVAL))
-TWR_DATA_STREAM_FLOAT_BUFFER(sm_pressure_buffer, (SEND_DATA_INTERVAL / MEASURE_INTERVAL_BAROMETER))
-TWR_DATA_STREAM_FLOAT_BUFFER(sm_co2_buffer, (SEND_DATA_INTERVAL / MEASURE_INTERVAL_BAROMETER))
+TWR_DATA_STREAM_INT_BUFFER(sm_voltage_buffer, 8)
 TWR_DATA_STREAM_INT_BUFFER(sm_orientation_buffer, 3)
 
 twr_data_stream_t sm_voltage;
-twr_data_stream_t sm_temperature;
-twr_data_stream_t sm_humidity;
-twr_data_stream_t sm_illuminance;
-twr_data_stream_t sm_pressure;
-twr_data_stream_t sm_co2;
 twr_data_stream_t sm_orientation;
 
+// Statistics of the current send interval in hundredths of degree, tenths of percent, lux, Pa and ppm
+aggregate_t agg_temperature;
+aggregate_t agg_humidity;
+aggregate_t agg_illuminance;
+aggregate_t agg_pressure;
+aggregate_t agg_co2;
+
+// Same streams over the current batch snapshot only, the interval statistics above span the whole batch
+aggregate_t agg_snapshot_temperature;
+aggregate_t agg_snapshot_humidity;
+aggregate_t agg_snapshot_co2;
+
+// Outlier filters in front of the aggregates, see AT$FILTER
+filter_t filter_temperature;
+filter_t filter_humidity;
+filter_t filter_illuminance;
+filter_t filter_pressure;
+filter_t filter_co2;
+
 twr_scheduler_task_id_t battery_measure_task_id;
+// Measurement in progress was started during a transmission
+bool battery_loaded = false;
+// Uplink on air, from the start of the message to its end
+bool lora_transmitting = false;
+// Power tier the intervals were stretched for
+power_tier_t power_tier = POWER_TIER_NORMAL;
+
+// Periodic measurements on the wake grid
+int measure_climate_id;
+int measure_barometer_id;
+int orientation_id;
+int measure_battery_id;
+
+// Motion alarm since the last uplink
+bool tamper = false;
+// Tick the unit is still after the last motion alarm
+twr_tick_t orientation_still_tick = 0;
 
 enum {
     HEADER_BOOT         = 0x00,
     HEADER_UPDATE       = 0x01,
     HEADER_BUTTON_CLICK = 0x02,
     HEADER_BUTTON_HOLD  = 0x03,
+    HEADER_BATCH        = 0x04,
+    HEADER_THRESHOLD    = 0x05,
+    HEADER_BACKFILL     = 0x06,
 
 } header = HEADER_BOOT;
 
+// Flag of the header byte, the frame ends with the acknowledgement of the last downlink
+#define HEADER_FLAG_ACK 0x08
+// Power tier in bits 5-4 of the standard and batch frames, compact frames use them for the keyframe sequence
+#define HEADER_TIER_SHIFT 4
+
+bool reboot_pending = false;
+// Uplink requested by a command, sent now with whatever the batch holds
+bool send_now = false;
+
 twr_scheduler_task_id_t calibration_task_id = 0;
 int calibration_counter;
 
 void calibration_task(void *param);
+void intervals_apply(void);
+void power_apply(void);
+void deadband_apply(void);
+void filter_apply(size_t stream);
 
 void calibration_start()
 {
@@ -74,7 +164,8 @@ void calibration_stop()
     twr_scheduler_unregister(calibration_task_id);
     calibration_task_id = 0;
 
-    twr_module_co2_set_update_interval(MEASURE_INTERVAL_CO2);
+    // Bounds of the current power tier, survival keeps the sensor off
+    intervals_apply();
     twr_atci_printf("$CO2_CALIBRATION: \"STOP\"");
 }
 
@@ -82,11 +173,13 @@ void calibration_task(void *param)
 {
     (void) param;
 
+    profile_begin(PROFILE_SOURCE_CALIBRATION_TASK);
+
     twr_led_set_mode(&led, TWR_LED_MODE_BLINK_SLOW);
 
     twr_atci_printf("$CO2_CALIBRATION_COUNTER: \"%d\"", calibration_counter);
 
-    twr_module_co2_set_update_interval(CALIBRATION_MEASURE_INTERVAL);
+    co2_sampling_set_bounds(CALIBRATION_MEASURE_INTERVAL, CALIBRATION_MEASURE_INTERVAL);
     twr_module_co2_calibration(TWR_LP8_CALIBRATION_BACKGROUND_FILTERED);
 
     calibration_counter--;
@@ -97,10 +190,14 @@ void calibration_task(void *param)
     }
 
     twr_scheduler_plan_current_relative(CALIBRATION_MEASURE_INTERVAL);
+
+    profile_end(PROFILE_SOURCE_CALIBRATION_TASK);
 }
 
 void button_event_handler(twr_button_t *self, twr_button_event_t event, void *event_param)
 {
+    profile_begin(PROFILE_SOURCE_BUTTON);
+
     if (event == TWR_BUTTON_EVENT_CLICK)
     {
         header = HEADER_BUTTON_CLICK;
@@ -118,6 +215,19 @@ void button_event_handler(twr_button_t *self, twr_button_event_t event, void *ev
             calibration_stop();
         }
     }
+
+    profile_end(PROFILE_SOURCE_BUTTON);
+}
+
+void threshold_callback(void)
+{
+    // Boot and button frames are on the way already
+    if (header == HEADER_UPDATE)
+    {
+        header = HEADER_THRESHOLD;
+
+        twr_scheduler_plan_now(0);
+    }
 }
 
 void pir_event_handler(twr_module_pir_t *self, twr_module_pir_event_t event, void *event_param)
@@ -125,11 +235,24 @@ void pir_event_handler(twr_module_pir_t *self, twr_module_pir_event_t event, voi
     (void) self;
     (void) event_param;
 
+    profile_begin(PROFILE_SOURCE_PIR);
+
     if (event == TWR_MODULE_PIR_EVENT_MOTION)
     {
         //twr_led_pulse(&led, 50);
         pir_motion_count++;
+
+        occupancy_motion();
+
+        if (!calibration_task_id)
+        {
+            co2_sampling_motion();
+        }
+
+        threshold_feed_motion();
     }
+
+    profile_end(PROFILE_SOURCE_PIR);
 }
 
 void co2_module_event_handler(twr_module_co2_event_t event, void *event_param)
@@ -137,77 +260,277 @@ void co2_module_event_handler(twr_module_co2_event_t event, void *event_param)
     (void) event;
     (void) event_param;
 
+    profile_begin(PROFILE_SOURCE_CO2);
+
+    profile_charge(PROFILE_SOURCE_CO2, PROFILE_PERIPHERAL_CO2);
+
     float value;
 
     if (twr_module_co2_get_concentration_ppm(&value))
     {
-        twr_data_stream_feed(&sm_co2, &value);
+        int32_t ppm = value;
+        int32_t filtered;
+
+        // Rejected sample is left out of the interval and the alarms
+        bool accepted = filter_feed(&filter_co2, ppm, &filtered);
+
+        if (accepted)
+        {
+            aggregate_feed(&agg_co2, filtered);
+            aggregate_feed(&agg_snapshot_co2, filtered);
+        }
 
         if (calibration_task_id)
         {
             twr_atci_printf("$CO2_CALIBRATION_CO2_VALUE: \"%f\"", value);
         }
+        else
+        {
+            // Raw jump shortens the interval, the next sample confirms or rejects it sooner
+            co2_sampling_feed(ppm);
+
+            if (accepted)
+            {
+                threshold_feed_co2(filtered);
+            }
+        }
     }
     else
     {
-        twr_data_stream_reset(&sm_co2);
+        filter_invalidate(&filter_co2);
+
+        aggregate_invalidate(&agg_co2);
+        aggregate_invalidate(&agg_snapshot_co2);
     }
+
+    profile_end(PROFILE_SOURCE_CO2);
 }
 
 void climate_module_event_handler(twr_module_climate_event_t event, void *event_param)
 {
-    float value = NAN;
+    profile_begin(PROFILE_SOURCE_CLIMATE);
+
+    // The SDK reports floats, a sample is scaled to integer once here and stays integer downstream
+    float value;
 
     if (event == TWR_MODULE_CLIMATE_EVENT_UPDATE_THERMOMETER)
     {
-        twr_module_climate_get_temperature_celsius(&value);
+        profile_charge(PROFILE_SOURCE_CLIMATE, PROFILE_PERIPHERAL_THERMOMETER);
+
+        if (twr_module_climate_get_temperature_celsius(&value))
+        {
+            int32_t temperature = value * 100.f;
+
+            if (filter_feed(&filter_temperature, temperature, &temperature))
+            {
+                aggregate_feed(&agg_temperature, temperature);
+                aggregate_feed(&agg_snapshot_temperature, temperature);
 
-        twr_data_stream_feed(&sm_temperature, &value);
+                threshold_feed_temperature(temperature);
+            }
+        }
+        else
+        {
+            filter_invalidate(&filter_temperature);
+
+            aggregate_invalidate(&agg_temperature);
+            aggregate_invalidate(&agg_snapshot_temperature);
+        }
     }
     else if (event == TWR_MODULE_CLIMATE_EVENT_UPDATE_HYGROMETER)
     {
-        twr_module_climate_get_humidity_percentage(&value);
+        profile_charge(PROFILE_SOURCE_CLIMATE, PROFILE_PERIPHERAL_HYGROMETER);
+
+        int32_t humidity;
+
+        if (twr_module_climate_get_humidity_percentage(&value))
+        {
+            if (filter_feed(&filter_humidity, (int32_t) (value * 10.f), &humidity))
+            {
+                aggregate_feed(&agg_humidity, humidity);
+                aggregate_feed(&agg_snapshot_humidity, humidity);
+            }
+        }
+        else
+        {
+            filter_invalidate(&filter_humidity);
 
-        twr_data_stream_feed(&sm_humidity, &value);
+            aggregate_invalidate(&agg_humidity);
+            aggregate_invalidate(&agg_snapshot_humidity);
+        }
     }
     else if (event == TWR_MODULE_CLIMATE_EVENT_UPDATE_LUX_METER)
     {
-        twr_module_climate_get_illuminance_lux(&value);
+        profile_charge(PROFILE_SOURCE_CLIMATE, PROFILE_PERIPHERAL_LUX_METER);
+
+        int32_t illuminance;
+
+        if (twr_module_climate_get_illuminance_lux(&value))
+        {
+            if (filter_feed(&filter_illuminance, (int32_t) value, &illuminance))
+            {
+                aggregate_feed(&agg_illuminance, illuminance);
+            }
+        }
+        else
+        {
+            filter_invalidate(&filter_illuminance);
 
-        twr_data_stream_feed(&sm_illuminance, &value);
+            aggregate_invalidate(&agg_illuminance);
+        }
     }
     else if (event == TWR_MODULE_CLIMATE_EVENT_UPDATE_BAROMETER)
     {
-        twr_module_climate_get_pressure_pascal(&value);
+        profile_charge(PROFILE_SOURCE_CLIMATE, PROFILE_PERIPHERAL_BAROMETER);
+
+        int32_t pressure;
+
+        if (twr_module_climate_get_pressure_pascal(&value))
+        {
+            if (filter_feed(&filter_pressure, (int32_t) value, &pressure))
+            {
+                aggregate_feed(&agg_pressure, pressure);
+            }
+        }
+        else
+        {
+            filter_invalidate(&filter_pressure);
 
-        twr_data_stream_feed(&sm_pressure, &value);
+            aggregate_invalidate(&agg_pressure);
+        }
     }
+
+    profile_end(PROFILE_SOURCE_CLIMATE);
 }
 
 void battery_event_handler(twr_module_battery_event_t event, void *event_param)
 {
+    profile_begin(PROFILE_SOURCE_BATTERY);
+
     if (event == TWR_MODULE_BATTERY_EVENT_UPDATE)
     {
-        float voltage = NAN;
+        profile_charge(PROFILE_SOURCE_BATTERY, PROFILE_PERIPHERAL_BATTERY);
+
+        float voltage;
+
+        if (twr_module_battery_get_voltage(&voltage))
+        {
+            int millivolts;
+
+            // Uplinks carry the voltage under load, the one at rest until the first transmission
+            if (battery_loaded && !battery_get_voltage(true, &millivolts))
+            {
+                twr_data_stream_reset(&sm_voltage);
+            }
 
-        twr_module_battery_get_voltage(&voltage);
+            if (battery_loaded || twr_data_stream_get_length(&sm_voltage) == 0)
+            {
+                millivolts = voltage * 1000.f;
 
-        twr_data_stream_feed(&sm_voltage, &voltage);
+                twr_data_stream_feed(&sm_voltage, &millivolts);
+            }
+
+            battery_feed(voltage, battery_loaded);
+
+            if (power_update())
+            {
+                power_apply();
+            }
+        }
+        else if (battery_loaded)
+        {
+            twr_data_stream_reset(&sm_voltage);
+        }
     }
+
+    profile_end(PROFILE_SOURCE_BATTERY);
 }
 
 void battery_measure_task(void *param)
 {
+    profile_begin(PROFILE_SOURCE_BATTERY_MEASURE_TASK);
+
+    battery_loaded = true;
+
     if (!twr_module_battery_measure())
     {
         twr_scheduler_plan_current_now();
     }
+
+    profile_end(PROFILE_SOURCE_BATTERY_MEASURE_TASK);
+}
+
+void measure_climate(void *param)
+{
+    (void) param;
+
+    profile_begin(PROFILE_SOURCE_MEASURE);
+
+    twr_module_climate_measure_thermometer();
+    twr_module_climate_measure_hygrometer();
+    twr_module_climate_measure_lux_meter();
+
+    profile_end(PROFILE_SOURCE_MEASURE);
+}
+
+void measure_barometer(void *param)
+{
+    (void) param;
+
+    profile_begin(PROFILE_SOURCE_MEASURE);
+
+    twr_module_climate_measure_barometer();
+
+    profile_end(PROFILE_SOURCE_MEASURE);
+}
+
+void measure_battery(void *param)
+{
+    (void) param;
+
+    profile_begin(PROFILE_SOURCE_MEASURE);
+
+    // Not at rest during a transmission, tried again at the next grid tick
+    if (!lora_transmitting && twr_module_battery_measure())
+    {
+        battery_loaded = false;
+    }
+    else
+    {
+        wake_schedule(measure_battery_id, wake_get_grid());
+    }
+
+    profile_end(PROFILE_SOURCE_MEASURE);
+}
+
+// Face read on the wake grid, shares the bus session with the climate measurements of the tick
+void measure_orientation(void *param)
+{
+    (void) param;
+
+    profile_begin(PROFILE_SOURCE_LIS2DH12);
+
+    // Alarms of a longer handling postpone the reading until the unit is still
+    if (orientation_still_tick > twr_tick_get())
+    {
+        wake_schedule(orientation_id, orientation_still_tick - twr_tick_get());
+    }
+    else if (!twr_lis2dh12_measure(&lis2dh12))
+    {
+        wake_schedule(orientation_id, ORIENTATION_SETTLE_DELAY);
+    }
+
+    profile_end(PROFILE_SOURCE_LIS2DH12);
 }
 
 void lis2dh12_event_handler(twr_lis2dh12_t *self, twr_lis2dh12_event_t event, void *event_param)
 {
+    profile_begin(PROFILE_SOURCE_LIS2DH12);
+
     if (event == TWR_LIS2DH12_EVENT_UPDATE)
     {
+        profile_charge(PROFILE_SOURCE_LIS2DH12, PROFILE_PERIPHERAL_LIS2DH12);
+
         twr_lis2dh12_result_g_t g;
 
         if (twr_lis2dh12_get_result_g(self, &g))
@@ -216,278 +539,1619 @@ void lis2dh12_event_handler(twr_lis2dh12_t *self, twr_lis2dh12_event_t event, vo
 
             int orientation = (int) twr_dice_get_face(&dice);
 
+            // One reading per motion, the face of the previous position does not count
+            twr_data_stream_reset(&sm_orientation);
             twr_data_stream_feed(&sm_orientation, &orientation);
         }
     }
+    else if (event == TWR_LIS2DH12_EVENT_ALARM)
+    {
+        profile_charge(PROFILE_SOURCE_LIS2DH12, PROFILE_PERIPHERAL_LIS2DH12);
+
+        tamper = true;
+
+        orientation_still_tick = twr_tick_get() + ORIENTATION_SETTLE_DELAY;
+
+        wake_schedule(orientation_id, ORIENTATION_SETTLE_DELAY);
+    }
+
+    profile_end(PROFILE_SOURCE_LIS2DH12);
 }
 
-void lora_callback(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_event_t event, void *event_param)
+// Send interval stretched by the power tier
+twr_tick_t send_interval_get(void)
 {
-    if (event == TWR_CMWX1ZZABZ_EVENT_ERROR)
+    return config_get(CONFIG_SEND_INTERVAL) << power_tier;
+}
+
+void intervals_apply(void)
+{
+    power_tier = power_get_tier();
+
+    // Every tier below normal doubles the intervals
+    twr_tick_t measure_interval = config_get(CONFIG_MEASURE_INTERVAL) << power_tier;
+
+    // The shortest interval is the grid, a changed grid starts from now
+    if (wake_get_grid() != measure_interval || wake_get_tolerance() != config_get(CONFIG_MEASURE_TOLERANCE))
     {
-        twr_led_set_mode(&led, TWR_LED_MODE_BLINK_FAST);
+        wake_set_grid(measure_interval, config_get(CONFIG_MEASURE_TOLERANCE));
     }
-    else if (event == TWR_CMWX1ZZABZ_EVENT_SEND_MESSAGE_START)
-    {
-        twr_led_set_mode(&led, TWR_LED_MODE_ON);
 
-        twr_scheduler_plan_relative(battery_measure_task_id, 20);
-    }
-    else if (event == TWR_CMWX1ZZABZ_EVENT_SEND_MESSAGE_DONE)
+    wake_set_interval(measure_climate_id, measure_interval);
+    wake_set_interval(measure_barometer_id, config_get(CONFIG_MEASURE_INTERVAL_BAROMETER) << power_tier);
+
+    slot_set_jitter(config_get(CONFIG_SEND_JITTER));
+
+    // Calibration drives the CO2 module on its own and restores the bounds when it stops
+    if (calibration_task_id)
     {
-        twr_led_set_mode(&led, TWR_LED_MODE_OFF);
+        return;
     }
-    else if (event == TWR_CMWX1ZZABZ_EVENT_READY)
+
+    // The LP8 draws the most of all sensors, eco keeps it at the longest interval and survival turns it off
+    if (power_tier == POWER_TIER_SURVIVAL)
     {
-        twr_led_set_mode(&led, TWR_LED_MODE_OFF);
+        co2_sampling_set_bounds(TWR_TICK_INFINITY, TWR_TICK_INFINITY);
+
+        // The last concentration would be repeated in every uplink
+        aggregate_invalidate(&agg_co2);
+        aggregate_invalidate(&agg_snapshot_co2);
     }
-    else if (event == TWR_CMWX1ZZABZ_EVENT_JOIN_SUCCESS)
+    else if (power_tier == POWER_TIER_ECO)
     {
-        twr_atci_printf("$JOIN_OK");
+        co2_sampling_set_bounds(config_get(CONFIG_MEASURE_INTERVAL_CO2_MAX) << power_tier,
+                                config_get(CONFIG_MEASURE_INTERVAL_CO2_MAX) << power_tier);
     }
-    else if (event == TWR_CMWX1ZZABZ_EVENT_JOIN_ERROR)
+    else
     {
-        twr_atci_printf("$JOIN_ERROR");
+        co2_sampling_set_bounds(config_get(CONFIG_MEASURE_INTERVAL_CO2_MIN), config_get(CONFIG_MEASURE_INTERVAL_CO2_MAX));
     }
 }
 
-bool at_send(void)
+void power_apply(void)
 {
-    twr_scheduler_plan_now(0);
-
-    return true;
-}
+    static const link_quality_t repeat_limit[] = {
+            [POWER_TIER_NORMAL] = LINK_QUALITY_POOR,
+            [POWER_TIER_ECO] = LINK_QUALITY_FAIR,
+            [POWER_TIER_SURVIVAL] = LINK_QUALITY_GOOD,
+    };
 
-bool at_calibration(void)
-{
-    if (calibration_task_id)
-    {
-        calibration_stop();
-    }
-    else
-    {
-        calibration_start();
-    }
+    link_set_repeat_limit(repeat_limit[power_get_tier()]);
 
-    return true;
+    intervals_apply();
 }
 
-bool at_status(void)
+// Five uint16 in seconds, zero keeps the value
+bool downlink_set_intervals(const uint8_t *args)
 {
-    float value_avg = NAN;
-
-    static const struct {
-        twr_data_stream_t *stream;
-        const char *name;
-        int precision;
-    } values[] = {
-            {&sm_voltage, "Voltage", 1},
-            {&sm_temperature, "Temperature", 1},
-            {&sm_humidity, "Humidity", 1},
-            {&sm_illuminance, "Illuminance", 1},
-            {&sm_pressure, "Pressure", 0},
-            {&sm_co2, "CO2", 0},
+    static const config_item_t items[] = {
+            CONFIG_SEND_INTERVAL,
+            CONFIG_MEASURE_INTERVAL,
+            CONFIG_MEASURE_INTERVAL_BAROMETER,
+            CONFIG_MEASURE_INTERVAL_CO2_MIN,
+            CONFIG_MEASURE_INTERVAL_CO2_MAX
     };
 
-    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    twr_tick_t value[sizeof(items) / sizeof(items[0])];
+
+    // All or nothing, a single bad value rejects the whole command
+    for (size_t i = 0; i < sizeof(items) / sizeof(items[0]); i++)
     {
-        value_avg = NAN;
+        value[i] = (twr_tick_t) (args[i * 2] << 8 | args[i * 2 + 1]) * 1000;
 
-        if (twr_data_stream_get_average(values[i].stream, &value_avg))
+        if (value[i] == 0)
         {
-            twr_atci_printf("$STATUS: \"%s\",%.*f", values[i].name, values[i].precision, value_avg);
+            value[i] = config_get(items[i]);
         }
-        else
+        else if (value[i] < config_get_min(items[i]) || value[i] > config_get_max(items[i]))
         {
-            twr_atci_printf("$STATUS: \"%s\",", values[i].name);
+            return false;
         }
     }
 
-    int orientation;
-
-    if (twr_data_stream_get_median(&sm_orientation, &orientation))
+    if (value[3] > value[4])
     {
-        twr_atci_printf("$STATUS: \"Orientation\",%d", orientation);
+        return false;
     }
-    else
+
+    for (size_t i = 0; i < sizeof(items) / sizeof(items[0]); i++)
     {
-        twr_atci_printf("$STATUS: \"Orientation\",", orientation);
+        config_set(items[i], value[i]);
     }
 
-    twr_atci_printf("$STATUS: \"PIR Motion count\",%d", pir_motion_count);
+    config_save();
+
+    intervals_apply();
 
     return true;
 }
 
-void application_init(void)
+// CO2 levels [ppm], temperature delta [0.1 C] and motion quiet period [min] as uint16, 0xffff keeps the value
+bool downlink_set_thresholds(const uint8_t *args)
 {
-    twr_data_stream_init(&sm_voltage, 1, &sm_voltage_buffer);
-    twr_data_stream_init(&sm_temperature, 1, &sm_temperature_buffer);
-    twr_data_stream_init(&sm_humidity, 1, &sm_humidity_buffer);
-    twr_data_stream_init(&sm_illuminance, 1, &sm_illuminance_buffer);
-    twr_data_stream_init(&sm_pressure, 1, &sm_pressure_buffer);
-    twr_data_stream_init(&sm_co2, 1, &sm_co2_buffer);
-    twr_data_stream_init(&sm_orientation, 1, &sm_orientation_buffer);
-
-    // Initialize LED
-    twr_led_init(&led, TWR_GPIO_LED, false, false);
-    twr_led_set_mode(&led, TWR_LED_MODE_ON);
+    uint16_t value[4];
 
-    // Initialize button
-    twr_button_init(&button, TWR_GPIO_BUTTON, TWR_GPIO_PULL_DOWN, false);
-    twr_button_set_event_handler(&button, button_event_handler, NULL);
+    for (size_t i = 0; i < 4; i++)
+    {
+        value[i] = args[i * 2] << 8 | args[i * 2 + 1];
+    }
 
-    // Initialize climate module
-    twr_module_climate_init();
-    twr_module_climate_set_event_handler(climate_module_event_handler, NULL);
-    twr_module_climate_set_update_interval_thermometer(MEASURE_INTERVAL);
-    twr_module_climate_set_update_interval_hygrometer(MEASURE_INTERVAL);
-    twr_module_climate_set_update_interval_lux_meter(MEASURE_INTERVAL);
-    twr_module_climate_set_update_interval_barometer(MEASURE_INTERVAL_BAROMETER);
+    uint16_t level_1;
+    uint16_t level_2;
 
-    // Initialize PIR Module
-    twr_module_pir_init(&pir);
-    twr_module_pir_set_event_handler(&pir, pir_event_handler, NULL);
+    threshold_get_co2_levels(&level_1, &level_2);
 
-    // Initilize CO2
-    twr_module_co2_init();
-    twr_module_co2_set_update_interval(MEASURE_INTERVAL_CO2);
-    twr_module_co2_set_event_handler(co2_module_event_handler, NULL);
+    if ((value[0] != 0xffff && value[0] > 10000) || (value[1] != 0xffff && value[1] > 10000) ||
+        (value[2] != 0xffff && value[2] > 500) || (value[3] != 0xffff && value[3] > 24 * 60))
+    {
+        return false;
+    }
 
-    // Initialize battery
-    twr_module_battery_init();
-    twr_module_battery_set_event_handler(battery_event_handler, NULL);
-    battery_measure_task_id = twr_scheduler_register(battery_measure_task, NULL, 2020);
+    threshold_set_co2_levels(value[0] != 0xffff ? value[0] : level_1, value[1] != 0xffff ? value[1] : level_2);
 
-    twr_dice_init(&dice, TWR_DICE_FACE_UNKNOWN);
+    if (value[2] != 0xffff)
+    {
+        threshold_set_temperature_delta(value[2]);
+    }
 
-    twr_lis2dh12_init(&lis2dh12, TWR_I2C_I2C0, 0x19);
-    twr_lis2dh12_set_resolution(&lis2dh12, TWR_LIS2DH12_RESOLUTION_8BIT);
+    if (value[3] != 0xffff)
+    {
+        threshold_set_motion_quiet((twr_tick_t) value[3] * 60000);
+    }
 
-    twr_lis2dh12_set_event_handler(&lis2dh12, lis2dh12_event_handler, NULL);
-    twr_lis2dh12_set_update_interval(&lis2dh12, MEASURE_INTERVAL);
+    // Levels as ordered by the threshold module
+    threshold_get_co2_levels(&level_1, &level_2);
 
-    // Initialize lora module
-    twr_cmwx1zzabz_init(&lora, TWR_UART_UART1);
-    twr_cmwx1zzabz_set_event_handler(&lora, lora_callback, NULL);
-    twr_cmwx1zzabz_set_mode(&lora, TWR_CMWX1ZZABZ_CONFIG_MODE_ABP);
-    twr_cmwx1zzabz_set_class(&lora, TWR_CMWX1ZZABZ_CONFIG_CLASS_A);
+    config_set_value(CONFIG_THRESHOLD_CO2_LEVEL_1, level_1);
+    config_set_value(CONFIG_THRESHOLD_CO2_LEVEL_2, level_2);
+    config_set_value(CONFIG_THRESHOLD_TEMPERATURE, threshold_get_temperature_delta());
+    config_set_value(CONFIG_THRESHOLD_MOTION_QUIET, threshold_get_motion_quiet() / 60000);
 
-    // Initialize AT command interface
-    at_init(&led, &lora);
-    static const twr_atci_command_t commands[] = {
-            AT_LORA_COMMANDS,
-            {"$SEND", at_send, NULL, NULL, NULL, "Immediately send packet"},
-            {"$CALIBRATION", at_calibration, NULL, NULL, NULL, "Immediately send packet"},
-            {"$STATUS", at_status, NULL, NULL, NULL, "Show status"},
-            AT_LED_COMMANDS,
-            TWR_ATCI_COMMAND_CLAC,
-            TWR_ATCI_COMMAND_HELP
-    };
-    twr_atci_init(commands, TWR_ATCI_COMMANDS_LENGTH(commands));
+    config_save();
 
-    twr_scheduler_plan_current_relative(10 * 1000);
+    return true;
 }
 
-void application_task(void)
+// Data rate and ADR, 0xff keeps the value
+bool downlink_set_datarate(const uint8_t *args)
 {
-    if (!twr_cmwx1zzabz_is_ready(&lora))
-    {
-        twr_scheduler_plan_current_relative(100);
+    uint8_t datarate_max = lorawan_get_max_datarate(twr_cmwx1zzabz_get_band(&lora));
 
-        return;
+    if ((args[0] != 0xff && args[0] > datarate_max) || (args[1] != 0xff && args[1] > 1))
+    {
+        return false;
     }
 
-    static uint8_t buffer[16];
-
-    memset(buffer, 0xff, sizeof(buffer));
-
-    buffer[0] = header;
-
-    float voltage_avg = NAN;
-
-    twr_data_stream_get_average(&sm_voltage, &voltage_avg);
-
-    if (!isnan(voltage_avg))
+    if (args[0] != 0xff)
     {
-        buffer[1] = ceil(voltage_avg * 10.f);
+        twr_cmwx1zzabz_set_datarate(&lora, args[0]);
     }
 
-    int orientation;
-
-    if (twr_data_stream_get_median(&sm_orientation, &orientation))
+    if (args[1] != 0xff)
     {
-        buffer[2] = orientation;
+        twr_cmwx1zzabz_set_adaptive_datarate(&lora, args[1]);
     }
 
-    float temperature_avg = NAN;
+    return true;
+}
 
-    twr_data_stream_get_average(&sm_temperature, &temperature_avg);
+bool downlink_calibration(const uint8_t *args)
+{
+    (void) args;
 
-    if (!isnan(temperature_avg))
+    if (!calibration_task_id)
     {
-        int16_t temperature_i16 = (int16_t) (temperature_avg * 10.f);
-
-        buffer[3] = temperature_i16 >> 8;
-        buffer[4] = temperature_i16;
+        calibration_start();
+    }
+
+    return true;
+}
+
+bool downlink_status(const uint8_t *args)
+{
+    (void) args;
+
+    send_now = true;
+
+    twr_scheduler_plan_now(0);
+
+    return true;
+}
+
+bool downlink_reboot(const uint8_t *args)
+{
+    (void) args;
+
+    // After the acknowledgement is sent
+    reboot_pending = true;
+
+    send_now = true;
+
+    twr_scheduler_plan_now(0);
+
+    return true;
+}
+
+void lora_callback(twr_cmwx1zzabz_t *self, twr_cmwx1zzabz_event_t event, void *event_param)
+{
+    static twr_tick_t send_start_tick = 0;
+
+    profile_begin(PROFILE_SOURCE_LORA);
+
+    // LED signals the radio in the normal tier only
+    bool led_enabled = power_get_tier() == POWER_TIER_NORMAL;
+
+    if (event == TWR_CMWX1ZZABZ_EVENT_ERROR)
+    {
+        if (led_enabled)
+        {
+            twr_led_set_mode(&led, TWR_LED_MODE_BLINK_FAST);
+        }
+
+        link_feed_error();
+
+        join_feed_error();
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_SEND_MESSAGE_START)
+    {
+        if (led_enabled)
+        {
+            twr_led_set_mode(&led, TWR_LED_MODE_ON);
+        }
+
+        twr_scheduler_plan_relative(battery_measure_task_id, 20);
+
+        send_start_tick = twr_tick_get();
+
+        lora_transmitting = true;
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_SEND_MESSAGE_DONE)
+    {
+        twr_led_set_mode(&led, TWR_LED_MODE_OFF);
+
+        lora_transmitting = false;
+
+        profile_charge_ticks(PROFILE_SOURCE_LORA, PROFILE_PERIPHERAL_RADIO, twr_tick_get() - send_start_tick);
+
+        if (reboot_pending && !downlink_is_ack_pending())
+        {
+            twr_system_reset();
+        }
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_READY)
+    {
+        twr_led_set_mode(&led, TWR_LED_MODE_OFF);
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_MESSAGE_RECEIVED)
+    {
+        uint8_t data[TWR_CMWX1ZZABZ_RX_MAX_PACKET_SIZE];
+
+        uint32_t length = twr_cmwx1zzabz_get_received_message_data(self, data, sizeof(data));
+
+        downlink_process(twr_cmwx1zzabz_get_received_message_port(self), data, length);
+
+        // Quality of the downlink
+        twr_cmwx1zzabz_rfq(self);
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_MESSAGE_RETRANSMISSION)
+    {
+        airtime_retransmitted();
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_MESSAGE_CONFIRMED)
+    {
+        link_feed_confirmed(true);
+
+        // Quality of the acknowledgement
+        twr_cmwx1zzabz_rfq(self);
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_MESSAGE_NOT_CONFIRMED)
+    {
+        link_feed_confirmed(false);
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_RFQ)
+    {
+        int32_t rssi;
+        int32_t snr;
+
+        if (twr_cmwx1zzabz_get_rfq(self, &rssi, &snr))
+        {
+            link_feed_snr(snr);
+        }
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_LINK_CHECK_OK)
+    {
+        uint8_t margin;
+        uint8_t gateway_count;
+
+        if (twr_cmwx1zzabz_get_link_check(self, &margin, &gateway_count))
+        {
+            link_feed_link_check(true, margin);
+        }
+
+        join_feed_link_check(true);
+
+        backfill_link_check(true);
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_LINK_CHECK_NOK)
+    {
+        link_feed_link_check(false, 0);
+
+        join_feed_link_check(false);
+
+        backfill_link_check(false);
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_JOIN_SUCCESS)
+    {
+        twr_atci_printf("$JOIN_OK");
+
+        join_feed_result(true);
+
+        // Boot frame opens every session, the interval continues
+        header = HEADER_BOOT;
+
+        twr_scheduler_plan_now(0);
+    }
+    else if (event == TWR_CMWX1ZZABZ_EVENT_JOIN_ERROR)
+    {
+        twr_atci_printf("$JOIN_ERROR");
+
+        join_feed_result(false);
+
+        link_feed_error();
+    }
+
+    // Radio may be free for the next uplink
+    uplink_kick();
+
+    profile_end(PROFILE_SOURCE_LORA);
+}
+
+// Mean of the interval, the last value if there was no measurement in the interval
+bool aggregate_get_value(aggregate_t *aggregate, int32_t *result)
+{
+    return aggregate_get_mean(aggregate, result) || aggregate_get_last(aggregate, result);
+}
+
+void aggregates_reset(void)
+{
+    aggregate_reset(&agg_temperature);
+    aggregate_reset(&agg_humidity);
+    aggregate_reset(&agg_illuminance);
+    aggregate_reset(&agg_pressure);
+    aggregate_reset(&agg_co2);
+    aggregate_reset(&agg_snapshot_temperature);
+    aggregate_reset(&agg_snapshot_humidity);
+    aggregate_reset(&agg_snapshot_co2);
+}
+
+// Periodic uplink goes out as a batch frame, one requested now only if the batch holds snapshots
+bool frame_is_batch(void)
+{
+    return batch_is_enabled() && header == HEADER_UPDATE && (!send_now || batch_get_count() != 0);
+}
+
+// Upper bound of the next uplink in the current format
+size_t frame_get_max_size(size_t frame_size)
+{
+    size_t size = PAYLOAD_STANDARD_SIZE + (payload_get_stats() ? PAYLOAD_STATS_SIZE : 0) + PAYLOAD_OCCUPANCY_SIZE;
+
+    if (frame_is_batch())
+    {
+        size = frame_size;
+    }
+    else if (payload_get_format() == PAYLOAD_FORMAT_COMPACT)
+    {
+        size = PAYLOAD_COMPACT_MAX_SIZE;
+    }
+
+    return size + (downlink_is_ack_pending() ? DOWNLINK_ACK_SIZE : 0);
+}
+
+void snapshot_take(void)
+{
+    batch_snapshot_t snapshot = {
+            .tick = twr_tick_get(),
+            .pir_motion_count = pir_motion_count
+    };
+
+    int32_t temperature_avg;
+
+    if (aggregate_get_mean(&agg_snapshot_temperature, &temperature_avg))
+    {
+        snapshot.temperature = payload_get_temperature(temperature_avg);
+        snapshot.fields |= PAYLOAD_FIELD_TEMPERATURE;
+    }
+
+    int32_t humidity_avg;
+
+    if (aggregate_get_mean(&agg_snapshot_humidity, &humidity_avg))
+    {
+        snapshot.humidity = humidity_avg / 5;
+        snapshot.fields |= PAYLOAD_FIELD_HUMIDITY;
+    }
+
+    int32_t co2_avg;
+
+    if (aggregate_get_value(&agg_snapshot_co2, &co2_avg))
+    {
+        snapshot.co2 = co2_avg;
+        snapshot.fields |= PAYLOAD_FIELD_CO2;
+    }
+
+    // Every snapshot is the mean of its own interval only, the send interval keeps its statistics
+    aggregate_reset(&agg_snapshot_temperature);
+    aggregate_reset(&agg_snapshot_humidity);
+    aggregate_reset(&agg_snapshot_co2);
+
+    batch_push(&snapshot);
+}
+
+bool at_send(void)
+{
+    send_now = true;
+
+    twr_scheduler_plan_now(0);
+
+    return true;
+}
+
+bool at_calibration(void)
+{
+    if (calibration_task_id)
+    {
+        calibration_stop();
+    }
+    else
+    {
+        calibration_start();
+    }
+
+    return true;
+}
+
+bool at_status(void)
+{
+    int millivolts;
+
+    if (twr_data_stream_get_average(&sm_voltage, &millivolts))
+    {
+        twr_atci_printf("$STATUS: \"Voltage\",%.1f", millivolts / 1000.f);
+    }
+    else
+    {
+        twr_atci_printf("$STATUS: \"Voltage\",");
+    }
+
+    // Integer units are converted for display only
+    static const struct {
+        aggregate_t *aggregate;
+        const char *name;
+        float scale;
+        int precision;
+    } values[] = {
+            {&agg_temperature, "Temperature", 100.f, 1},
+            {&agg_humidity, "Humidity", 10.f, 1},
+            {&agg_illuminance, "Illuminance", 1.f, 0},
+            {&agg_pressure, "Pressure", 1.f, 0},
+            {&agg_co2, "CO2", 1.f, 0},
+    };
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        int32_t value_avg;
+        int32_t value_min;
+        int32_t value_max;
+
+        float scale = values[i].scale;
+        int precision = values[i].precision;
+
+        if (aggregate_get_mean(values[i].aggregate, &value_avg))
+        {
+            aggregate_get_min(values[i].aggregate, &value_min);
+            aggregate_get_max(values[i].aggregate, &value_max);
+
+            twr_atci_printf("$STATUS: \"%s\",%.*f,%.*f,%.*f", values[i].name,
+                    precision, value_avg / scale, precision, value_min / scale, precision, value_max / scale);
+        }
+        else if (aggregate_get_last(values[i].aggregate, &value_avg))
+        {
+            twr_atci_printf("$STATUS: \"%s\",%.*f", values[i].name, precision, value_avg / scale);
+        }
+        else
+        {
+            twr_atci_printf("$STATUS: \"%s\",", values[i].name);
+        }
+    }
+
+    int orientation;
+
+    if (twr_data_stream_get_median(&sm_orientation, &orientation))
+    {
+        twr_atci_printf("$STATUS: \"Orientation\",%d", orientation);
+    }
+    else
+    {
+        twr_atci_printf("$STATUS: \"Orientation\",", orientation);
+    }
+
+    twr_atci_printf("$STATUS: \"Tamper\",%d", tamper);
+
+    twr_atci_printf("$STATUS: \"PIR Motion count\",%d", pir_motion_count);
+
+    occupancy_t occupancy;
+
+    occupancy_get(&occupancy);
+
+    twr_atci_printf("$STATUS: \"Occupied minutes\",%d", occupancy.minutes);
+
+    if (occupancy.minutes != 0)
+    {
+        twr_atci_printf("$STATUS: \"First motion\",%d", occupancy.first);
+        twr_atci_printf("$STATUS: \"Last motion\",%d", occupancy.last);
+    }
+
+    // 0 while the sensor is off in survival
+    twr_tick_t co2_interval = co2_sampling_get_interval();
+
+    twr_atci_printf("$STATUS: \"CO2 interval\",%d", co2_interval == TWR_TICK_INFINITY ? 0 : (int) (co2_interval / 1000));
+
+    return true;
+}
+
+bool at_payload_read(void)
+{
+    twr_atci_printfln("$PAYLOAD: %d", payload_get_format());
+
+    return true;
+}
+
+bool at_payload_set(twr_atci_param_t *param)
+{
+    uint8_t format = atoi(param->txt);
+
+    if (format > PAYLOAD_FORMAT_COMPACT)
+    {
+        return false;
+    }
+
+    config_set_flag(CONFIG_FLAG_COMPACT, format == PAYLOAD_FORMAT_COMPACT);
+
+    config_save();
+
+    payload_set_format(format);
+
+    return true;
+}
+
+bool at_stats_read(void)
+{
+    twr_atci_printfln("$STATS: %d", payload_get_stats());
+
+    return true;
+}
+
+bool at_stats_set(twr_atci_param_t *param)
+{
+    int stats = atoi(param->txt);
+
+    if (stats < 0 || stats > 1)
+    {
+        return false;
+    }
+
+    config_set_flag(CONFIG_FLAG_STATS, stats);
+
+    config_save();
+
+    payload_set_stats(stats);
+
+    return true;
+}
+
+bool at_keyframe_read(void)
+{
+    twr_atci_printfln("$KEYFRAME: %d", payload_get_keyframe_interval());
+
+    return true;
+}
+
+bool at_keyframe_set(twr_atci_param_t *param)
+{
+    int interval = atoi(param->txt);
+
+    if (interval < 1 || interval > 255)
+    {
+        return false;
+    }
+
+    config_set_value(CONFIG_KEYFRAME_INTERVAL, interval);
+
+    config_save();
+
+    payload_set_keyframe_interval(interval);
+
+    return true;
+}
+
+bool at_batch_read(void)
+{
+    twr_atci_printfln("$BATCH: %d", batch_get_size());
+
+    return true;
+}
+
+bool at_batch_set(twr_atci_param_t *param)
+{
+    int size = atoi(param->txt);
+
+    if (size < 1 || size > BATCH_MAX_SNAPSHOTS)
+    {
+        return false;
+    }
+
+    config_set_value(CONFIG_BATCH_SIZE, size);
+
+    config_save();
+
+    batch_set_size(size, pir_motion_count);
+
+    return true;
+}
+
+bool at_interval_read(void)
+{
+    twr_atci_printfln("$INTERVAL: %d,%d,%d",
+            (int) (config_get(CONFIG_SEND_INTERVAL) / 1000),
+            (int) (config_get(CONFIG_MEASURE_INTERVAL) / 1000),
+            (int) (config_get(CONFIG_MEASURE_INTERVAL_BAROMETER) / 1000));
+
+    return true;
+}
+
+bool at_interval_set(twr_atci_param_t *param)
+{
+    uint32_t send_interval;
+    uint32_t measure_interval;
+    uint32_t barometer_interval;
+
+    if (!twr_atci_get_uint(param, &send_interval) || !twr_atci_is_comma(param) ||
+        !twr_atci_get_uint(param, &measure_interval) || !twr_atci_is_comma(param) ||
+        !twr_atci_get_uint(param, &barometer_interval))
+    {
+        return false;
+    }
+
+    if (!config_set(CONFIG_SEND_INTERVAL, (twr_tick_t) send_interval * 1000) ||
+        !config_set(CONFIG_MEASURE_INTERVAL, (twr_tick_t) measure_interval * 1000) ||
+        !config_set(CONFIG_MEASURE_INTERVAL_BAROMETER, (twr_tick_t) barometer_interval * 1000))
+    {
+        // Drop the values set so far
+        config_init(EEPROM_CONFIG_ADDRESS);
+
+        return false;
+    }
+
+    config_save();
+
+    intervals_apply();
+
+    return true;
+}
+
+bool at_slot_read(void)
+{
+    twr_atci_printfln("$SLOT: %d,%d", (int) (slot_get_offset(send_interval_get()) / 1000),
+                      (int) (config_get(CONFIG_SEND_JITTER) / 1000));
+
+    return true;
+}
+
+bool at_slot_set(twr_atci_param_t *param)
+{
+    uint32_t jitter;
+
+    if (!twr_atci_get_uint(param, &jitter) || !config_set(CONFIG_SEND_JITTER, (twr_tick_t) jitter * 1000))
+    {
+        return false;
+    }
+
+    config_save();
+
+    intervals_apply();
+
+    return true;
+}
+
+bool at_co2int_read(void)
+{
+    twr_tick_t interval_min = co2_sampling_get_interval_min();
+    twr_tick_t interval_max = co2_sampling_get_interval_max();
+
+    // 0 while the sensor is off in survival
+    twr_atci_printfln("$CO2INT: %d,%d", interval_min == TWR_TICK_INFINITY ? 0 : (int) (interval_min / 60000),
+                      interval_max == TWR_TICK_INFINITY ? 0 : (int) (interval_max / 60000));
+
+    return true;
+}
+
+bool at_co2int_set(twr_atci_param_t *param)
+{
+    uint32_t interval_min;
+    uint32_t interval_max;
+
+    if (!twr_atci_get_uint(param, &interval_min) || !twr_atci_is_comma(param) || !twr_atci_get_uint(param, &interval_max))
+    {
+        return false;
+    }
+
+    // Checked in minutes, the milliseconds of a large value would wrap into the range
+    if (interval_min > interval_max || interval_max > 60)
+    {
+        return false;
+    }
+
+    // The minimum gives every send interval a fresh sample while CO2 changes, the maximum may exceed the send
+    // interval as quiet intervals repeat the last sample
+    if ((twr_tick_t) interval_min * 60000 > config_get(CONFIG_SEND_INTERVAL))
+    {
+        return false;
+    }
+
+    if (!config_set(CONFIG_MEASURE_INTERVAL_CO2_MIN, (twr_tick_t) interval_min * 60000) ||
+        !config_set(CONFIG_MEASURE_INTERVAL_CO2_MAX, (twr_tick_t) interval_max * 60000))
+    {
+        config_init(EEPROM_CONFIG_ADDRESS);
+
+        return false;
+    }
+
+    config_save();
+
+    intervals_apply();
+
+    return true;
+}
+
+bool at_backfill(void)
+{
+    twr_atci_printfln("$BACKFILL: %s,%d", backfill_is_online() ? "online" : "offline", backfill_get_pending());
+
+    return true;
+}
+
+bool at_airtime_read(void)
+{
+    airtime_stats_t stats;
+
+    airtime_get_stats(&stats);
+
+    size_t frame_size = lorawan_get_max_payload(twr_cmwx1zzabz_get_band(&lora), twr_cmwx1zzabz_get_datarate(&lora));
+
+    twr_atci_printfln("$AIRTIME: %d,%d,%d,%d,%d,%d,%d", twr_cmwx1zzabz_get_datarate(&lora),
+                      (int) airtime_get(frame_get_max_size(frame_size < BATCH_MAX_SIZE ? frame_size : BATCH_MAX_SIZE)),
+                      (int) airtime_get_available(), (int) airtime_get_budget(),
+                      (int) stats.used, (int) stats.uplinks, (int) stats.deferred);
+
+    return true;
+}
+
+bool at_airtime_set(twr_atci_param_t *param)
+{
+    uint32_t budget;
+
+    // Down to the TTN fair use policy of 30 s per day
+    if (!twr_atci_get_uint(param, &budget) || budget < 1000 || budget > AIRTIME_BUDGET_DEFAULT)
+    {
+        return false;
+    }
+
+    config_set_value(CONFIG_AIRTIME_BUDGET, budget);
+
+    config_save();
+
+    airtime_set_budget(budget);
+
+    return true;
+}
+
+bool at_policy_read(void)
+{
+    twr_atci_printfln("$POLICY: %d,%d", link_is_enabled(), link_get_adaptive_datarate());
+
+    return true;
+}
+
+bool at_policy_set(twr_atci_param_t *param)
+{
+    uint32_t enabled;
+    uint32_t adaptive_datarate;
+
+    if (!twr_atci_get_uint(param, &enabled) || enabled > 1 || !twr_atci_is_comma(param) ||
+        !twr_atci_get_uint(param, &adaptive_datarate) || adaptive_datarate > 1)
+    {
+        return false;
+    }
+
+    config_set_flag(CONFIG_FLAG_POLICY, enabled);
+    config_set_flag(CONFIG_FLAG_ADAPTIVE_DATARATE, adaptive_datarate);
+
+    config_save();
+
+    link_set_enabled(enabled);
+    link_set_adaptive_datarate(adaptive_datarate);
+
+    return true;
+}
+
+bool at_link(void)
+{
+    static const char *quality[] = {"good", "fair", "poor"};
+
+    int32_t margin;
+
+    if (link_get_margin(&margin))
+    {
+        twr_atci_printfln("$LINK: %s,%d,%.1f,%d", quality[link_get_quality()], twr_cmwx1zzabz_get_datarate(&lora),
+                          margin / 10.f, link_get_delivery());
+    }
+    else
+    {
+        twr_atci_printfln("$LINK: %s,%d,,%d", quality[link_get_quality()], twr_cmwx1zzabz_get_datarate(&lora),
+                          link_get_delivery());
+    }
+
+    return true;
+}
+
+bool at_session_read(void)
+{
+    static const char *state[] = {"abp", "joining", "joined"};
+
+    twr_atci_printfln("$SESSION: %s,%d,%d", state[join_get_state()], (int) join_get_attempts(),
+                      (int) (join_get_delay() / 1000));
+
+    return true;
+}
+
+bool at_session_set(twr_atci_param_t *param)
+{
+    uint32_t value;
+
+    if (!twr_atci_get_uint(param, &value) || value != 0 || join_get_state() == JOIN_STATE_ABP)
+    {
+        return false;
+    }
+
+    join_restart();
+
+    return true;
+}
+
+bool at_rbe_read(void)
+{
+    twr_atci_printfln("$RBE: %d,%d", report_is_enabled(), (int) (report_get_heartbeat() / 60000));
+
+    return true;
+}
+
+bool at_rbe_set(twr_atci_param_t *param)
+{
+    uint32_t enabled;
+    uint32_t heartbeat;
+
+    if (!twr_atci_get_uint(param, &enabled) || enabled > 1)
+    {
+        return false;
+    }
+
+    if (twr_atci_is_comma(param))
+    {
+        if (!twr_atci_get_uint(param, &heartbeat) || heartbeat < config_get(CONFIG_SEND_INTERVAL) / 60000 || heartbeat > 24 * 60)
+        {
+            return false;
+        }
+
+        config_set_value(CONFIG_REPORT_HEARTBEAT, heartbeat);
+
+        report_set_heartbeat((twr_tick_t) heartbeat * 60000);
+    }
+
+    config_set_flag(CONFIG_FLAG_REPORT, enabled);
+
+    config_save();
+
+    report_set_enabled(enabled);
+
+    return true;
+}
+
+static filter_t *const filters[] = {&filter_temperature, &filter_humidity, &filter_illuminance, &filter_pressure, &filter_co2};
+
+static const int32_t filter_floors[] = {FILTER_FLOOR_TEMPERATURE, FILTER_FLOOR_HUMIDITY, FILTER_FLOOR_ILLUMINANCE,
+                                        FILTER_FLOOR_PRESSURE, FILTER_FLOOR_CO2};
+
+// Config items CONFIG_FILTER_TEMPERATURE on are in the order of the streams
+void filter_apply(size_t stream)
+{
+    uint16_t value = config_get_value(CONFIG_FILTER_TEMPERATURE + stream);
+
+    filter_mode_t mode = CONFIG_FILTER_MODE(value) > FILTER_MODE_TRIMMED_MEAN ? FILTER_MODE_NONE : CONFIG_FILTER_MODE(value);
+
+    filter_init(filters[stream], mode, CONFIG_FILTER_WINDOW(value), CONFIG_FILTER_THRESHOLD(value), filter_floors[stream]);
+}
+
+bool at_filter_read(void)
+{
+    for (size_t i = 0; i < sizeof(filters) / sizeof(filters[0]); i++)
+    {
+        twr_atci_printfln("$FILTER: %d,%d,%d,%d,%d", (int) i, filter_get_mode(filters[i]), filter_get_window(filters[i]),
+                          filter_get_threshold(filters[i]), (int) filter_get_rejected(filters[i]));
+    }
+
+    return true;
+}
+
+bool at_filter_set(twr_atci_param_t *param)
+{
+    uint32_t stream;
+    uint32_t mode;
+    uint32_t window;
+    uint32_t threshold = FILTER_THRESHOLD_DEFAULT;
+
+    if (!twr_atci_get_uint(param, &stream) || stream >= sizeof(filters) / sizeof(filters[0]) ||
+        !twr_atci_is_comma(param) || !twr_atci_get_uint(param, &mode) || mode > FILTER_MODE_TRIMMED_MEAN ||
+        !twr_atci_is_comma(param) || !twr_atci_get_uint(param, &window) || window < 3 || window > FILTER_WINDOW_MAX)
+    {
+        return false;
+    }
+
+    if (twr_atci_is_comma(param) && (!twr_atci_get_uint(param, &threshold) || threshold < 10 || threshold > 255))
+    {
+        return false;
+    }
+
+    config_set_value(CONFIG_FILTER_TEMPERATURE + stream, CONFIG_FILTER(mode, window, threshold));
+
+    config_save();
+
+    filter_apply(stream);
+
+    return true;
+}
+
+bool at_deadband_read(void)
+{
+    twr_atci_printfln("$DEADBAND: %d,%d,%d,%d,%d,%d",
+            (int) report_get_deadband(PAYLOAD_FIELD_TEMPERATURE),
+            (int) report_get_deadband(PAYLOAD_FIELD_HUMIDITY) / 2,
+            (int) report_get_deadband(PAYLOAD_FIELD_ILLUMINANCE),
+            (int) report_get_deadband(PAYLOAD_FIELD_PRESSURE) * 2,
+            (int) report_get_deadband(PAYLOAD_FIELD_PIR_MOTION_COUNT),
+            (int) report_get_deadband(PAYLOAD_FIELD_CO2));
+
+    return true;
+}
+
+bool at_deadband_set(twr_atci_param_t *param)
+{
+    uint32_t deadband[6];
+
+    for (size_t i = 0; i < 6; i++)
+    {
+        if ((i > 0 && !twr_atci_is_comma(param)) || !twr_atci_get_uint(param, &deadband[i]) || deadband[i] > 65535)
+        {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < 6; i++)
+    {
+        config_set_value(CONFIG_DEADBAND_TEMPERATURE + i, deadband[i]);
+    }
+
+    config_save();
+
+    deadband_apply();
+
+    return true;
+}
+
+// Config items in the units of AT$DEADBAND, the report compares in the units of the frame
+void deadband_apply(void)
+{
+    report_set_deadband(PAYLOAD_FIELD_TEMPERATURE, config_get_value(CONFIG_DEADBAND_TEMPERATURE));
+    report_set_deadband(PAYLOAD_FIELD_HUMIDITY, config_get_value(CONFIG_DEADBAND_HUMIDITY) * 2);
+    report_set_deadband(PAYLOAD_FIELD_ILLUMINANCE, config_get_value(CONFIG_DEADBAND_ILLUMINANCE));
+    report_set_deadband(PAYLOAD_FIELD_PRESSURE, config_get_value(CONFIG_DEADBAND_PRESSURE) / 2);
+    report_set_deadband(PAYLOAD_FIELD_PIR_MOTION_COUNT, config_get_value(CONFIG_DEADBAND_MOTION));
+    report_set_deadband(PAYLOAD_FIELD_CO2, config_get_value(CONFIG_DEADBAND_CO2));
+}
+
+bool at_thrco2_read(void)
+{
+    uint16_t level_1;
+    uint16_t level_2;
+
+    threshold_get_co2_levels(&level_1, &level_2);
+
+    twr_atci_printfln("$THRCO2: %d,%d", level_1, level_2);
+
+    return true;
+}
+
+bool at_thrco2_set(twr_atci_param_t *param)
+{
+    uint32_t level_1;
+    uint32_t level_2;
+
+    if (!twr_atci_get_uint(param, &level_1) || !twr_atci_is_comma(param) || !twr_atci_get_uint(param, &level_2))
+    {
+        return false;
+    }
+
+    if (level_1 > 10000 || level_2 > 10000)
+    {
+        return false;
+    }
+
+    config_set_value(CONFIG_THRESHOLD_CO2_LEVEL_1, level_1);
+    config_set_value(CONFIG_THRESHOLD_CO2_LEVEL_2, level_2);
+
+    config_save();
+
+    threshold_set_co2_levels(level_1, level_2);
+
+    return true;
+}
+
+bool at_thrtemp_read(void)
+{
+    twr_atci_printfln("$THRTEMP: %d", threshold_get_temperature_delta());
+
+    return true;
+}
+
+bool at_thrtemp_set(twr_atci_param_t *param)
+{
+    int delta = atoi(param->txt);
+
+    if (delta < 0 || delta > 500)
+    {
+        return false;
+    }
+
+    config_set_value(CONFIG_THRESHOLD_TEMPERATURE, delta);
+
+    config_save();
+
+    threshold_set_temperature_delta(delta);
+
+    return true;
+}
+
+bool at_thrmotion_read(void)
+{
+    twr_atci_printfln("$THRMOTION: %d", (int) (threshold_get_motion_quiet() / 60000));
+
+    return true;
+}
+
+bool at_thrmotion_set(twr_atci_param_t *param)
+{
+    int quiet = atoi(param->txt);
+
+    if (quiet < 0 || quiet > 24 * 60)
+    {
+        return false;
+    }
+
+    config_set_value(CONFIG_THRESHOLD_MOTION_QUIET, quiet);
+
+    config_save();
+
+    threshold_set_motion_quiet((twr_tick_t) quiet * 60000);
+
+    return true;
+}
+
+bool at_wake_read(void)
+{
+    twr_atci_printfln("$WAKE: %d,%d,%lu,%lu", (int) (wake_get_grid() / 1000), (int) (wake_get_tolerance() / 1000),
+                      (unsigned long) profile_get_exits_last_hour(), (unsigned long) profile_get_exits());
+
+    return true;
+}
+
+bool at_wake_set(twr_atci_param_t *param)
+{
+    uint32_t tolerance;
+
+    if (!twr_atci_get_uint(param, &tolerance) || !config_set(CONFIG_MEASURE_TOLERANCE, (twr_tick_t) tolerance * 1000))
+    {
+        return false;
+    }
+
+    config_save();
+
+    intervals_apply();
+
+    return true;
+}
+
+bool at_battery(void)
+{
+    static const char *tier[] = {"normal", "eco", "survival"};
+
+    char rest[8] = "";
+    char loaded[8] = "";
+    char charge[8] = "";
+    char days[12] = "";
+
+    int value;
+    uint32_t forecast;
+
+    if (battery_get_voltage(false, &value))
+    {
+        snprintf(rest, sizeof(rest), "%.2f", value / 1000.f);
+    }
+
+    if (battery_get_voltage(true, &value))
+    {
+        snprintf(loaded, sizeof(loaded), "%.2f", value / 1000.f);
+    }
+
+    if (battery_get_charge(&value))
+    {
+        snprintf(charge, sizeof(charge), "%d", value);
+    }
+
+    if (battery_get_days(&forecast))
+    {
+        snprintf(days, sizeof(days), "%lu", (unsigned long) forecast);
+    }
+
+    twr_atci_printfln("$BATTERY: %s,%s,%s,%lu,%s,%s", rest, loaded, charge, (unsigned long) battery_get_remaining(), days,
+                      tier[power_get_tier()]);
+
+    return true;
+}
+
+bool at_profile(void)
+{
+    profile_print();
+
+    return true;
+}
+
+void application_init(void)
+{
+    profile_init();
+
+    config_init(EEPROM_CONFIG_ADDRESS);
+
+    // The settings of the AT commands are kept in the config as well and survive a reboot
+    payload_init();
+    payload_set_format(config_get_flag(CONFIG_FLAG_COMPACT) ? PAYLOAD_FORMAT_COMPACT : PAYLOAD_FORMAT_STANDARD);
+    payload_set_stats(config_get_flag(CONFIG_FLAG_STATS));
+    payload_set_keyframe_interval(config_get_value(CONFIG_KEYFRAME_INTERVAL));
+
+    batch_init();
+    batch_set_size(config_get_value(CONFIG_BATCH_SIZE), pir_motion_count);
+
+    report_init();
+    report_set_enabled(config_get_flag(CONFIG_FLAG_REPORT));
+    report_set_heartbeat((twr_tick_t) config_get_value(CONFIG_REPORT_HEARTBEAT) * 60000);
+    report_set_deadband(PAYLOAD_FIELD_VOLTAGE, 1);
+    deadband_apply();
+
+    threshold_init(threshold_callback);
+    threshold_set_co2_levels(config_get_value(CONFIG_THRESHOLD_CO2_LEVEL_1), config_get_value(CONFIG_THRESHOLD_CO2_LEVEL_2));
+    threshold_set_temperature_delta(config_get_value(CONFIG_THRESHOLD_TEMPERATURE));
+    threshold_set_motion_quiet((twr_tick_t) config_get_value(CONFIG_THRESHOLD_MOTION_QUIET) * 60000);
+
+    slot_init(&lora);
+
+    twr_data_stream_init(&sm_voltage, 1, &sm_voltage_buffer);
+    twr_data_stream_init(&sm_orientation, 1, &sm_orientation_buffer);
+
+    aggregate_init(&agg_temperature);
+    aggregate_init(&agg_humidity);
+    aggregate_init(&agg_illuminance);
+    aggregate_init(&agg_pressure);
+    aggregate_init(&agg_co2);
+    aggregate_init(&agg_snapshot_temperature);
+    aggregate_init(&agg_snapshot_humidity);
+    aggregate_init(&agg_snapshot_co2);
+
+    // Single spurious CO2 readings after the warm-up of the sensor, lux spikes of a passing shadow, see config.c
+    for (size_t i = 0; i < sizeof(filters) / sizeof(filters[0]); i++)
+    {
+        filter_apply(i);
+    }
+
+    // Initialize LED
+    twr_led_init(&led, TWR_GPIO_LED, false, false);
+    twr_led_set_mode(&led, TWR_LED_MODE_ON);
+
+    // Initialize button
+    twr_button_init(&button, TWR_GPIO_BUTTON, TWR_GPIO_PULL_DOWN, false);
+    twr_button_set_event_handler(&button, button_event_handler, NULL);
+
+    // Initialize climate module
+    twr_module_climate_init();
+    twr_module_climate_set_event_handler(climate_module_event_handler, NULL);
+
+    // Initialize PIR Module
+    twr_module_pir_init(&pir);
+    twr_module_pir_set_event_handler(&pir, pir_event_handler, NULL);
+
+    // Climate, barometer and CO2 measurements share one wake-up per grid tick
+    wake_init(config_get(CONFIG_MEASURE_INTERVAL), config_get(CONFIG_MEASURE_TOLERANCE));
+
+    measure_climate_id = wake_register(measure_climate, NULL, TWR_TICK_INFINITY);
+    measure_barometer_id = wake_register(measure_barometer, NULL, TWR_TICK_INFINITY);
+
+    // Initilize CO2
+    twr_module_co2_init();
+    twr_module_co2_set_event_handler(co2_module_event_handler, NULL);
+    co2_sampling_init(config_get(CONFIG_MEASURE_INTERVAL_CO2_MIN), config_get(CONFIG_MEASURE_INTERVAL_CO2_MAX));
+
+    // Initialize battery
+    twr_module_battery_init();
+    twr_module_battery_set_event_handler(battery_event_handler, NULL);
+    battery_measure_task_id = twr_scheduler_register(battery_measure_task, NULL, TWR_TICK_INFINITY);
+
+    battery_init();
+    power_init();
+
+    measure_battery_id = wake_register(measure_battery, NULL, BATTERY_REST_INTERVAL);
+
+    twr_dice_init(&dice, TWR_DICE_FACE_UNKNOWN);
+
+    twr_lis2dh12_init(&lis2dh12, TWR_I2C_I2C0, 0x19);
+    twr_lis2dh12_set_resolution(&lis2dh12, TWR_LIS2DH12_RESOLUTION_8BIT);
+
+    twr_lis2dh12_set_event_handler(&lis2dh12, lis2dh12_event_handler, NULL);
+
+    // Face read once at boot and after every motion instead of polling
+    twr_lis2dh12_alarm_t alarm = {
+            .threshold = ORIENTATION_ALARM_THRESHOLD,
+            .x_high = true,
+            .y_high = true,
+            .z_high = true,
+    };
+
+    twr_lis2dh12_set_alarm(&lis2dh12, &alarm);
+
+    orientation_id = wake_register(measure_orientation, NULL, TWR_TICK_INFINITY);
+
+    wake_schedule(orientation_id, 0);
+
+    intervals_apply();
+
+    occupancy_init(send_interval_get());
+
+    // Initialize lora module
+    twr_cmwx1zzabz_init(&lora, TWR_UART_UART1);
+    twr_cmwx1zzabz_set_event_handler(&lora, lora_callback, NULL);
+    twr_cmwx1zzabz_set_class(&lora, TWR_CMWX1ZZABZ_CONFIG_CLASS_A);
+
+    airtime_init(&lora);
+    airtime_set_budget(config_get_value(CONFIG_AIRTIME_BUDGET));
+
+    uplink_init(&lora);
+    uplink_register(UPLINK_CLASS_ALARM, 0);
+    uplink_register(UPLINK_CLASS_PERIODIC, 0);
+
+    // Mode is kept by the module, see AT$MODE
+    join_init(&lora, EEPROM_SESSION_ADDRESS);
+
+    link_init(&lora);
+    link_set_enabled(config_get_flag(CONFIG_FLAG_POLICY));
+    link_set_adaptive_datarate(config_get_flag(CONFIG_FLAG_ADAPTIVE_DATARATE));
+
+    backfill_init(&lora, HEADER_BACKFILL, EEPROM_RINGLOG_ADDRESS, EEPROM_RINGLOG_SIZE);
+
+    static const downlink_command_t downlink_commands[] = {
+            {DOWNLINK_SET_INTERVALS, 10, downlink_set_intervals},
+            {DOWNLINK_SET_THRESHOLDS, 8, downlink_set_thresholds},
+            {DOWNLINK_SET_DATARATE, 2, downlink_set_datarate},
+            {DOWNLINK_CALIBRATION, 0, downlink_calibration},
+            {DOWNLINK_STATUS, 0, downlink_status},
+            {DOWNLINK_REBOOT, 0, downlink_reboot},
+    };
+
+    downlink_init(downlink_commands, sizeof(downlink_commands) / sizeof(downlink_commands[0]));
+
+    // Initialize AT command interface
+    at_init(&led, &lora);
+    static const twr_atci_command_t commands[] = {
+            AT_LORA_COMMANDS,
+            {"$SEND", at_send, NULL, NULL, NULL, "Immediately send packet"},
+            {"$CALIBRATION", at_calibration, NULL, NULL, NULL, "Immediately send packet"},
+            {"$STATUS", at_status, NULL, NULL, NULL, "Show status"},
+            {"$PAYLOAD", NULL, at_payload_set, at_payload_read, NULL, "Payload format 0:standard, 1:compact"},
+            {"$STATS", NULL, at_stats_set, at_stats_read, NULL, "Interval statistics in standard frames 0:disabled, 1:enabled"},
+            {"$KEYFRAME", NULL, at_keyframe_set, at_keyframe_read, NULL, "Frames between compact keyframes 1-255"},
+            {"$BATCH", NULL, at_batch_set, at_batch_read, NULL, "Snapshots per uplink 1-16, 1:disabled"},
+            {"$INTERVAL", NULL, at_interval_set, at_interval_read, NULL, "Intervals send,measure,barometer [s]"},
+            {"$CO2INT", NULL, at_co2int_set, at_co2int_read, NULL, "CO2 measure interval bounds min,max [min] 1-60"},
+            {"$SLOT", NULL, at_slot_set, at_slot_read, NULL, "Send jitter [s] 0-300, read also shows the slot offset [s]"},
+            {"$WAKE", NULL, at_wake_set, at_wake_read, NULL, "Measurement grid tolerance [s] 0-300, read also shows the grid [s] and stop mode exits in the last hour and since boot"},
+            {"$BACKFILL", at_backfill, NULL, NULL, NULL, "Link state and records waiting for backfill"},
+            {"$AIRTIME", NULL, at_airtime_set, at_airtime_read, NULL, "Airtime budget per hour [ms] 1000-36000"},
+            {"$POLICY", NULL, at_policy_set, at_policy_read, NULL, "Uplink policy 0:disabled 1:enabled,adaptive data rate 0:disabled 1:enabled"},
+            {"$BATTERY", at_battery, NULL, NULL, NULL, "Battery voltage at rest and under load [V], charge [%], remaining [mAh], days to empty and stage"},
+            {"$LINK", at_link, NULL, NULL, NULL, "Link quality, data rate, margin [dB] and delivery of confirmed uplinks [%]"},
+            {"$SESSION", NULL, at_session_set, at_session_read, NULL, "OTAA session state,join attempts,next attempt [s], 0:join again"},
+            {"$RBE", NULL, at_rbe_set, at_rbe_read, NULL, "Report by exception 0:disabled 1:enabled, optional heartbeat [min]"},
+            {"$DEADBAND", NULL, at_deadband_set, at_deadband_read, NULL, "Deadbands temperature [0.1 C],humidity [%],illuminance [lux],pressure [Pa],motion,CO2 [ppm]"},
+            {"$FILTER", NULL, at_filter_set, at_filter_read, NULL, "Filter stream 0:temperature 1:humidity 2:illuminance 3:pressure 4:CO2,mode 0:none 1:median 2:Hampel 3:trimmed mean,window 3-9,Hampel threshold [0.1 MAD]"},
+            {"$THRCO2", NULL, at_thrco2_set, at_thrco2_read, NULL, "CO2 alarm levels level1,level2 [ppm], 0:disabled"},
+            {"$THRTEMP", NULL, at_thrtemp_set, at_thrtemp_read, NULL, "Temperature change for immediate send [0.1 C], 0:disabled"},
+            {"$THRMOTION", NULL, at_thrmotion_set, at_thrmotion_read, NULL, "Quiet period before motion sends immediately [min], 0:disabled"},
+            {"$PROFILE", at_profile, NULL, NULL, NULL, "Show wake-ups, active time [us] and charge [uC] per task"},
+            AT_LED_COMMANDS,
+            TWR_ATCI_COMMAND_CLAC,
+            TWR_ATCI_COMMAND_HELP
+    };
+    twr_atci_init(commands, TWR_ATCI_COMMANDS_LENGTH(commands));
+
+    // Devices powered on together do not send the boot frame together
+    twr_scheduler_plan_current_relative(10 * 1000 + slot_get_random());
+}
+
+void application_task(void)
+{
+    profile_begin(PROFILE_SOURCE_APPLICATION_TASK);
+
+    size_t frame_size = lorawan_get_max_payload(twr_cmwx1zzabz_get_band(&lora), twr_cmwx1zzabz_get_datarate(&lora));
+
+    if (frame_size > BATCH_MAX_SIZE)
+    {
+        frame_size = BATCH_MAX_SIZE;
+    }
+
+    // Snapshots share the frame with the acknowledgement
+    size_t batch_size = frame_size - (downlink_is_ack_pending() ? DOWNLINK_ACK_SIZE : 0);
+
+    if (batch_is_enabled() && header == HEADER_UPDATE && !send_now && !batch_is_full(batch_size))
+    {
+        snapshot_take();
+
+        if (!batch_is_full(batch_size))
+        {
+            twr_scheduler_plan_current_relative(slot_get_delay(send_interval_get() / batch_get_size()));
+
+            profile_end(PROFILE_SOURCE_APPLICATION_TASK);
+
+            return;
+        }
+    }
+
+    bool alarm = header == HEADER_BUTTON_CLICK || header == HEADER_BUTTON_HOLD || header == HEADER_THRESHOLD;
+
+    // Planned again once the radio is free
+    if (!uplink_acquire(alarm ? UPLINK_CLASS_ALARM : UPLINK_CLASS_PERIODIC))
+    {
+        profile_end(PROFILE_SOURCE_APPLICATION_TASK);
+
+        return;
+    }
+
+    // Checked with the largest frame before anything is consumed, a postponed frame is built when
+    // it is sent and carries whatever was requested in the meantime
+    twr_tick_t delay = airtime_get_delay(frame_get_max_size(frame_size));
+
+    if (delay != 0)
+    {
+        airtime_deferred();
+
+        uplink_release();
+
+        twr_scheduler_plan_current_relative(delay);
+
+        profile_end(PROFILE_SOURCE_APPLICATION_TASK);
+
+        return;
+    }
+
+    payload_t payload = {
+            .header = header,
+            .tier = power_get_tier(),
+            .fields = PAYLOAD_FIELD_PIR_MOTION_COUNT,
+            .pir_motion_count = pir_motion_count
+    };
+
+    occupancy_get(&payload.occupancy);
+
+    int voltage_avg;
+
+    if (twr_data_stream_get_average(&sm_voltage, &voltage_avg))
+    {
+        // Rounded up to tenths of volt
+        payload.voltage = (voltage_avg + 99) / 100;
+        payload.fields |= PAYLOAD_FIELD_VOLTAGE;
+    }
+
+    int orientation;
+
+    if (twr_data_stream_get_median(&sm_orientation, &orientation))
+    {
+        payload.orientation = orientation;
+        payload.fields |= PAYLOAD_FIELD_ORIENTATION;
+    }
+
+    if (tamper)
+    {
+        payload.orientation |= PAYLOAD_ORIENTATION_TAMPER;
+        payload.fields |= PAYLOAD_FIELD_ORIENTATION;
     }
 
-    float humidity_avg = NAN;
+    // Threshold frames report the value that crossed, not the interval average
+    bool (*get_value)(aggregate_t *, int32_t *) = header == HEADER_THRESHOLD ? aggregate_get_last : aggregate_get_value;
+
+    int32_t value;
+
+    if (get_value(&agg_temperature, &value))
+    {
+        payload.temperature = payload_get_temperature(value);
+        payload.fields |= PAYLOAD_FIELD_TEMPERATURE;
+
+        payload.temperature_min = payload.temperature;
+        payload.temperature_max = payload.temperature;
+        payload.temperature_stddev = 0;
+
+        if (aggregate_get_min(&agg_temperature, &value))
+        {
+            payload.temperature_min = payload_get_temperature(value);
+        }
+
+        if (aggregate_get_max(&agg_temperature, &value))
+        {
+            payload.temperature_max = payload_get_temperature(value);
+        }
 
-    twr_data_stream_get_average(&sm_humidity, &humidity_avg);
+        if (aggregate_get_stddev(&agg_temperature, &value))
+        {
+            payload.temperature_stddev = value > 254 ? 254 : value;
+        }
+    }
 
-    if (!isnan(humidity_avg))
+    if (aggregate_get_value(&agg_humidity, &value))
     {
-        buffer[5] = humidity_avg * 2;
+        payload.humidity = value / 5;
+        payload.fields |= PAYLOAD_FIELD_HUMIDITY;
     }
 
-    float illuminance_avg = NAN;
+    if (aggregate_get_value(&agg_illuminance, &value))
+    {
+        payload.illuminance = value > 65534 ? 65534 : value;
+        payload.fields |= PAYLOAD_FIELD_ILLUMINANCE;
+    }
 
-    twr_data_stream_get_average(&sm_illuminance, &illuminance_avg);
+    if (aggregate_get_value(&agg_pressure, &value))
+    {
+        payload.pressure = value / 2;
+        payload.fields |= PAYLOAD_FIELD_PRESSURE;
+    }
 
-    if (!isnan(illuminance_avg))
+    if (get_value(&agg_co2, &value))
     {
-        if (illuminance_avg > 65534)
+        payload.co2 = value;
+        payload.fields |= PAYLOAD_FIELD_CO2;
+
+        payload.co2_min = payload.co2;
+        payload.co2_max = payload.co2;
+        payload.co2_stddev = 0;
+
+        if (aggregate_get_min(&agg_co2, &value))
+        {
+            payload.co2_min = value;
+        }
+
+        if (aggregate_get_max(&agg_co2, &value))
+        {
+            payload.co2_max = value;
+        }
+
+        if (aggregate_get_stddev(&agg_co2, &value))
         {
-            illuminance_avg = 65534;
+            payload.co2_stddev = value;
         }
+    }
+
+    // Next interval starts, threshold and button frames do not cut it
+    if (header == HEADER_UPDATE)
+    {
+        aggregates_reset();
+
+        occupancy_start(send_interval_get());
+    }
+
+    if (header == HEADER_UPDATE)
+    {
+        backfill_push(&payload, send_interval_get());
+    }
+
+    uint8_t ack[DOWNLINK_ACK_SIZE];
+
+    size_t ack_size = downlink_get_ack(ack) ? sizeof(ack) : 0;
+
+    // Interval is logged for the backfill, other frames are dropped before the device joined
+    bool skip = !join_is_joined() || (header == HEADER_UPDATE && !batch_is_enabled() && ack_size == 0 && !tamper &&
+                                      !send_now && !report_is_needed(&payload));
+
+    if (skip)
+    {
+        header = HEADER_UPDATE;
+
+        send_now = false;
 
-        uint16_t value = (uint16_t) illuminance_avg;
-        buffer[6] = value >> 8;
-        buffer[7] = value;
+        uplink_release();
+
+        twr_scheduler_plan_current_relative(slot_get_delay(send_interval_get()));
+
+        profile_end(PROFILE_SOURCE_APPLICATION_TASK);
+
+        return;
     }
 
-    float pressure_avg = NAN;
+    // Large enough for every frame format
+    static uint8_t buffer[BATCH_MAX_SIZE];
 
-    twr_data_stream_get_average(&sm_pressure, &pressure_avg);
+    size_t length;
+
+    if (frame_is_batch())
+    {
+        payload.header = HEADER_BATCH;
+
+        length = batch_encode(&payload, buffer, batch_size);
+    }
+    else
+    {
+        length = payload_encode(&payload, buffer, sizeof(buffer) - ack_size);
+    }
 
-    if (!isnan(pressure_avg))
+    if (length != 0 && !(buffer[0] & PAYLOAD_HEADER_COMPACT))
     {
-        uint16_t value = pressure_avg / 2.f;
-        buffer[8] = value >> 8;
-        buffer[9] = value;
+        buffer[0] |= payload.tier << HEADER_TIER_SHIFT;
     }
 
-    buffer[10] = pir_motion_count >> 24;
-    buffer[11] = pir_motion_count >> 16;
-    buffer[12] = pir_motion_count >> 8;
-    buffer[13] = pir_motion_count;
+    if (ack_size != 0 && length != 0)
+    {
+        buffer[0] |= HEADER_FLAG_ACK;
+
+        memcpy(buffer + length, ack, ack_size);
+
+        length += ack_size;
 
-    float co2_avg = NAN;
+        downlink_ack_sent();
+    }
 
-    twr_data_stream_get_average(&sm_co2, &co2_avg);
+    bool confirmed = link_apply(alarm ? LINK_CLASS_ALARM : LINK_CLASS_PERIODIC);
 
-    if (!isnan(co2_avg))
+    if (confirmed)
+    {
+        twr_cmwx1zzabz_send_message_confirmed(&lora, buffer, length);
+    }
+    else
     {
-        uint16_t value = co2_avg;
-        buffer[14] = value >> 8;
-        buffer[15] = value;
+        twr_cmwx1zzabz_send_message(&lora, buffer, length);
     }
 
-    twr_cmwx1zzabz_send_message(&lora, buffer, sizeof(buffer));
+    airtime_sent(length, confirmed);
+
+    uplink_release();
+
+    report_sent(&payload);
+
+    threshold_sent(&payload);
+
+    tamper = false;
 
     static char tmp[sizeof(buffer) * 2 + 1];
-    for (size_t i = 0; i < sizeof(buffer); i++)
+    for (size_t i = 0; i < length; i++)
     {
         sprintf(tmp + i * 2, "%02x", buffer[i]);
     }
@@ -496,5 +2160,9 @@ void application_task(void)
 
     header = HEADER_UPDATE;
 
-    twr_scheduler_plan_current_relative(SEND_DATA_INTERVAL);
+    send_now = false;
+
+    twr_scheduler_plan_current_relative(slot_get_delay(send_interval_get() / batch_get_size()));
+
+    profile_end(PROFILE_SOURCE_APPLICATION_TASK);
 }
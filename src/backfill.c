@@ -0,0 +1,358 @@
+#include <backfill.h>
+#include <ringlog.h>
+#include <lorawan.h>
+#include <airtime.h>
+#include <uplink.h>
+#include <join.h>
+#include <twr.h>
+
+#define BACKFILL_LINK_CHECK_INTERVAL (60 * 60 * 1000)
+#define BACKFILL_LINK_CHECK_RETRY (15 * 60 * 1000)
+
+// Resent frames are spaced by the minimum gap, further if the airtime budget requires
+#define BACKFILL_MIN_GAP (60 * 1000)
+
+#define BACKFILL_MAX_RECORDS 32
+
+static struct
+{
+    twr_cmwx1zzabz_t *lora;
+    uint8_t header;
+
+    bool online;
+    bool draining;
+
+    // First record not known to be delivered and the end of the records to resend
+    uint16_t confirmed;
+    uint16_t end;
+
+    uint32_t pir_motion_count;
+    bool pir_motion_valid;
+
+    twr_tick_t link_check_tick;
+    twr_scheduler_task_id_t task_id;
+
+} _backfill;
+
+static void _backfill_task(void *param);
+static void _backfill_send(void);
+static size_t _backfill_encode(uint8_t *buffer, size_t size, uint16_t *next);
+static uint16_t _backfill_get_interval(uint16_t sequence);
+
+void backfill_init(twr_cmwx1zzabz_t *lora, uint8_t header, uint32_t address, size_t size)
+{
+    memset(&_backfill, 0, sizeof(_backfill));
+
+    _backfill.lora = lora;
+    _backfill.header = header;
+    _backfill.online = true;
+
+    ringlog_init(address, size);
+
+    _backfill.confirmed = ringlog_get_sequence();
+
+    uint16_t mark;
+
+    // Outage not drained before the reset, resend after the first successful link check
+    if (ringlog_get_mark(&mark))
+    {
+        _backfill.confirmed = mark;
+        _backfill.online = false;
+    }
+
+    _backfill.link_check_tick = twr_tick_get() + BACKFILL_LINK_CHECK_RETRY;
+
+    _backfill.task_id = twr_scheduler_register(_backfill_task, NULL, _backfill.link_check_tick);
+
+    uplink_register(UPLINK_CLASS_BACKFILL, _backfill.task_id);
+}
+
+void backfill_push(const payload_t *payload, twr_tick_t interval)
+{
+    ringlog_record_t record = {
+            .fields = payload->fields & (PAYLOAD_FIELD_TEMPERATURE | PAYLOAD_FIELD_HUMIDITY | PAYLOAD_FIELD_CO2),
+            .temperature = payload->temperature,
+            .humidity = payload->humidity,
+            .co2 = payload->co2,
+            .interval = interval / 60000 > 0xffff ? 0xffff : interval / 60000,
+    };
+
+    uint32_t motions = payload->pir_motion_count - _backfill.pir_motion_count;
+
+    record.pir_motion_count = !_backfill.pir_motion_valid ? 0 : motions > 255 ? 255 : motions;
+
+    _backfill.pir_motion_count = payload->pir_motion_count;
+    _backfill.pir_motion_valid = true;
+
+    ringlog_append(&record);
+}
+
+void backfill_link_check(bool ok)
+{
+    twr_tick_t now = twr_tick_get();
+
+    _backfill.link_check_tick = now + (ok ? BACKFILL_LINK_CHECK_INTERVAL : BACKFILL_LINK_CHECK_RETRY);
+
+    if (!ok)
+    {
+        if (_backfill.online)
+        {
+            // Everything since the last good link check may be lost
+            _backfill.online = false;
+            _backfill.draining = false;
+
+            ringlog_set_mark(_backfill.confirmed);
+        }
+
+        twr_scheduler_plan_absolute(_backfill.task_id, _backfill.link_check_tick);
+
+        return;
+    }
+
+    if (!_backfill.online || _backfill.draining)
+    {
+        _backfill.online = true;
+        _backfill.draining = true;
+        _backfill.end = ringlog_get_sequence();
+
+        twr_scheduler_plan_now(_backfill.task_id);
+
+        return;
+    }
+
+    _backfill.confirmed = ringlog_get_sequence();
+
+    twr_scheduler_plan_absolute(_backfill.task_id, _backfill.link_check_tick);
+}
+
+int backfill_get_pending(void)
+{
+    uint16_t oldest = ringlog_get_oldest();
+    uint16_t sequence = ringlog_get_sequence();
+
+    if (_backfill.online && !_backfill.draining)
+    {
+        return 0;
+    }
+
+    // Records overwritten during a long outage are gone
+    if ((uint16_t) (sequence - _backfill.confirmed) > (uint16_t) (sequence - oldest))
+    {
+        return sequence - oldest;
+    }
+
+    return (uint16_t) (sequence - _backfill.confirmed);
+}
+
+bool backfill_is_online(void)
+{
+    return _backfill.online;
+}
+
+static void _backfill_task(void *param)
+{
+    (void) param;
+
+    // Without a session the link is down, records kept until a link check after the join
+    if (!join_is_joined())
+    {
+        backfill_link_check(false);
+
+        return;
+    }
+
+    if (!uplink_acquire(UPLINK_CLASS_BACKFILL))
+    {
+        return;
+    }
+
+    _backfill_send();
+
+    uplink_release();
+}
+
+// Link check or the next frame of the records to resend
+static void _backfill_send(void)
+{
+    if (!_backfill.draining)
+    {
+        twr_tick_t delay = airtime_get_delay(0);
+
+        if (delay != 0)
+        {
+            twr_scheduler_plan_current_relative(delay);
+
+            return;
+        }
+
+        twr_cmwx1zzabz_link_check(_backfill.lora);
+
+        airtime_sent(0, false);
+
+        // Replanned by the result, retried if it never comes
+        twr_scheduler_plan_current_relative(BACKFILL_LINK_CHECK_RETRY);
+
+        return;
+    }
+
+    if (_backfill.confirmed == _backfill.end)
+    {
+        _backfill.draining = false;
+        _backfill.confirmed = _backfill.end;
+
+        ringlog_clear_mark();
+
+        twr_scheduler_plan_current_absolute(_backfill.link_check_tick);
+
+        return;
+    }
+
+    uint8_t datarate = twr_cmwx1zzabz_get_datarate(_backfill.lora);
+    twr_cmwx1zzabz_config_band_t band = twr_cmwx1zzabz_get_band(_backfill.lora);
+
+    size_t frame_size = lorawan_get_max_payload(band, datarate);
+
+    static uint8_t buffer[BACKFILL_HEADER_SIZE + BACKFILL_MAX_RECORDS * BACKFILL_RECORD_SIZE];
+
+    if (frame_size > sizeof(buffer))
+    {
+        frame_size = sizeof(buffer);
+    }
+
+    uint16_t next;
+
+    size_t length = _backfill_encode(buffer, frame_size, &next);
+
+    if (length == 0 && next != _backfill.confirmed)
+    {
+        // Nothing readable left
+        _backfill.confirmed = next;
+
+        twr_scheduler_plan_current_now();
+
+        return;
+    }
+
+    twr_tick_t delay = length != 0 ? airtime_get_delay(length) : 0;
+
+    if (delay != 0)
+    {
+        airtime_deferred();
+
+        twr_scheduler_plan_current_relative(delay);
+
+        return;
+    }
+
+    if (length == 0 || !twr_cmwx1zzabz_send_message(_backfill.lora, buffer, length))
+    {
+        twr_scheduler_plan_current_relative(BACKFILL_MIN_GAP);
+
+        return;
+    }
+
+    _backfill.confirmed = next;
+
+    ringlog_set_mark(next);
+
+    airtime_sent(length, false);
+
+    twr_scheduler_plan_current_relative(BACKFILL_MIN_GAP);
+}
+
+// Frame: header, sequence of the newest record in the log and count, then records oldest first of
+// age in minutes before the newest record, temperature, humidity, CO2 and PIR motions
+static size_t _backfill_encode(uint8_t *buffer, size_t size, uint16_t *next)
+{
+    *next = _backfill.confirmed;
+
+    if (size < BACKFILL_HEADER_SIZE + BACKFILL_RECORD_SIZE)
+    {
+        return 0;
+    }
+
+    uint16_t newest = ringlog_get_sequence() - 1;
+    uint16_t sequence = _backfill.confirmed;
+
+    if ((uint16_t) (newest - sequence) >= (uint16_t) (newest - ringlog_get_oldest()))
+    {
+        sequence = ringlog_get_oldest();
+    }
+
+    int max = (size - BACKFILL_HEADER_SIZE) / BACKFILL_RECORD_SIZE;
+    int count = 0;
+
+    // Sum of the intervals of the records after the first one up to the newest
+    uint32_t age = 0;
+
+    for (uint16_t i = sequence; i != newest; i++)
+    {
+        age += _backfill_get_interval(i + 1);
+    }
+
+    uint8_t *p = buffer + BACKFILL_HEADER_SIZE;
+
+    ringlog_record_t record;
+
+    for (uint16_t first = sequence; sequence != _backfill.end && count < max; sequence++)
+    {
+        if (sequence != first)
+        {
+            age -= _backfill_get_interval(sequence);
+        }
+
+        if (!ringlog_read(sequence, &record))
+        {
+            continue;
+        }
+
+        memset(p, 0xff, BACKFILL_RECORD_SIZE);
+
+        p[0] = age > 0xffff ? 0xff : age >> 8;
+        p[1] = age > 0xffff ? 0xff : age;
+
+        if (record.fields & PAYLOAD_FIELD_TEMPERATURE)
+        {
+            p[2] = record.temperature >> 8;
+            p[3] = record.temperature;
+        }
+
+        if (record.fields & PAYLOAD_FIELD_HUMIDITY)
+        {
+            p[4] = record.humidity;
+        }
+
+        if (record.fields & PAYLOAD_FIELD_CO2)
+        {
+            p[5] = record.co2 >> 8;
+            p[6] = record.co2;
+        }
+
+        p[7] = record.pir_motion_count;
+
+        p += BACKFILL_RECORD_SIZE;
+        count++;
+    }
+
+    *next = sequence;
+
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    buffer[0] = _backfill.header;
+    buffer[1] = newest >> 8;
+    buffer[2] = newest;
+    buffer[3] = count;
+
+    return BACKFILL_HEADER_SIZE + count * BACKFILL_RECORD_SIZE;
+}
+
+// Minutes covered by the record, a record no longer readable counts none
+static uint16_t _backfill_get_interval(uint16_t sequence)
+{
+    ringlog_record_t record;
+
+    return ringlog_read(sequence, &record) ? record.interval : 0;
+}
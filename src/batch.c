@@ -0,0 +1,147 @@
+#include <batch.h>
+#include <twr.h>
+
+static struct
+{
+    uint8_t size;
+    batch_snapshot_t snapshot[BATCH_MAX_SNAPSHOTS];
+    int head;
+    int count;
+    uint32_t pir_motion_count;
+
+} _batch;
+
+void batch_init(void)
+{
+    memset(&_batch, 0, sizeof(_batch));
+
+    _batch.size = 1;
+}
+
+void batch_set_size(uint8_t size, uint32_t pir_motion_count)
+{
+    _batch.size = size;
+    _batch.count = 0;
+    _batch.pir_motion_count = pir_motion_count;
+}
+
+uint8_t batch_get_size(void)
+{
+    return _batch.size;
+}
+
+bool batch_is_enabled(void)
+{
+    return _batch.size > 1;
+}
+
+void batch_push(const batch_snapshot_t *snapshot)
+{
+    if (_batch.count == BATCH_MAX_SNAPSHOTS)
+    {
+        // Overwrite the oldest one
+        _batch.head = (_batch.head + 1) % BATCH_MAX_SNAPSHOTS;
+        _batch.count--;
+    }
+
+    _batch.snapshot[(_batch.head + _batch.count) % BATCH_MAX_SNAPSHOTS] = *snapshot;
+    _batch.count++;
+}
+
+int batch_get_count(void)
+{
+    return _batch.count;
+}
+
+bool batch_is_full(size_t frame_size)
+{
+    int capacity = frame_size < BATCH_HEADER_SIZE ? 0 : (frame_size - BATCH_HEADER_SIZE) / BATCH_SNAPSHOT_SIZE;
+
+    return _batch.count >= _batch.size || _batch.count >= capacity;
+}
+
+// Frame: header, battery, orientation, illuminance, pressure, count and snapshots oldest first of
+// age [min] before the uplink, temperature, humidity, CO2 and PIR motions during the snapshot interval
+size_t batch_encode(const payload_t *payload, uint8_t *buffer, size_t size)
+{
+    if (size < BATCH_HEADER_SIZE)
+    {
+        return 0;
+    }
+
+    int count = (size - BATCH_HEADER_SIZE) / BATCH_SNAPSHOT_SIZE;
+
+    if (count > _batch.count)
+    {
+        count = _batch.count;
+    }
+
+    memset(buffer, 0xff, BATCH_HEADER_SIZE + count * BATCH_SNAPSHOT_SIZE);
+
+    buffer[0] = payload->header;
+
+    if (payload->fields & PAYLOAD_FIELD_VOLTAGE)
+    {
+        buffer[1] = payload->voltage;
+    }
+
+    if (payload->fields & PAYLOAD_FIELD_ORIENTATION)
+    {
+        buffer[2] = payload->orientation;
+    }
+
+    if (payload->fields & PAYLOAD_FIELD_ILLUMINANCE)
+    {
+        buffer[3] = payload->illuminance >> 8;
+        buffer[4] = payload->illuminance;
+    }
+
+    if (payload->fields & PAYLOAD_FIELD_PRESSURE)
+    {
+        buffer[5] = payload->pressure >> 8;
+        buffer[6] = payload->pressure;
+    }
+
+    buffer[7] = count;
+
+    twr_tick_t now = twr_tick_get();
+
+    uint8_t *p = buffer + BATCH_HEADER_SIZE;
+
+    for (int i = 0; i < count; i++, p += BATCH_SNAPSHOT_SIZE)
+    {
+        batch_snapshot_t *snapshot = &_batch.snapshot[_batch.head];
+
+        twr_tick_t age = (now - snapshot->tick) / (60 * 1000);
+
+        p[0] = age > 254 ? 254 : age;
+
+        if (snapshot->fields & PAYLOAD_FIELD_TEMPERATURE)
+        {
+            p[1] = snapshot->temperature >> 8;
+            p[2] = snapshot->temperature;
+        }
+
+        if (snapshot->fields & PAYLOAD_FIELD_HUMIDITY)
+        {
+            p[3] = snapshot->humidity;
+        }
+
+        if (snapshot->fields & PAYLOAD_FIELD_CO2)
+        {
+            p[4] = snapshot->co2 >> 8;
+            p[5] = snapshot->co2;
+        }
+
+        uint32_t motion = snapshot->pir_motion_count - _batch.pir_motion_count;
+
+        p[6] = motion > 254 ? 254 : motion;
+
+        _batch.pir_motion_count = snapshot->pir_motion_count;
+
+        _batch.head = (_batch.head + 1) % BATCH_MAX_SNAPSHOTS;
+        _batch.count--;
+    }
+
+    return BATCH_HEADER_SIZE + count * BATCH_SNAPSHOT_SIZE;
+}
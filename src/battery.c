@@ -0,0 +1,204 @@
+#include <battery.h>
+#include <profile.h>
+#include <twr.h>
+
+// Discharge curve of the pack at rest, four alkaline cells in series
+static const struct
+{
+    int millivolts;
+    int percentage;
+
+} _battery_curve[] = {
+        {6200, 100},
+        {6000, 95},
+        {5800, 85},
+        {5600, 72},
+        {5400, 58},
+        {5200, 45},
+        {5000, 32},
+        {4800, 20},
+        {4600, 11},
+        {4400, 5},
+        {4000, 0},
+};
+
+// Drop under the load of a transmission assumed before the first measurement at rest [mV]
+#define BATTERY_SAG_DEFAULT 150
+
+// Rise of the state of charge on the curve above the estimate that means fresh cells [0.1 %]
+#define BATTERY_SWAP_RISE 300
+
+// Exponential filter of the measurements, new ones count 1 / 2^shift
+#define BATTERY_FILTER_SHIFT 2
+
+typedef struct
+{
+    bool valid;
+    int millivolts;
+
+} battery_voltage_t;
+
+static struct
+{
+    battery_voltage_t rest;
+    battery_voltage_t loaded;
+
+    bool valid;
+
+    // Remaining capacity [uAh] when the profile had accounted the charge [uC]
+    uint64_t anchor_remaining;
+    uint64_t anchor_charge;
+
+} _battery;
+
+static void _battery_filter(battery_voltage_t *voltage, int millivolts);
+static int _battery_get_sag(void);
+static int _battery_get_curve(int millivolts);
+static int _battery_get_permille(void);
+static void _battery_anchor(int permille);
+
+void battery_init(void)
+{
+    memset(&_battery, 0, sizeof(_battery));
+}
+
+void battery_feed(float voltage, bool loaded)
+{
+    int millivolts = (int) (voltage * 1000.f);
+
+    // Fresh cells are no noise, the filters start over from them
+    if (_battery.valid && _battery_get_curve(millivolts + (loaded ? _battery_get_sag() : 0)) >
+                          _battery_get_permille() + BATTERY_SWAP_RISE)
+    {
+        memset(&_battery.rest, 0, sizeof(_battery.rest));
+        memset(&_battery.loaded, 0, sizeof(_battery.loaded));
+
+        _battery.valid = false;
+    }
+
+    _battery_filter(loaded ? &_battery.loaded : &_battery.rest, millivolts);
+
+    int rest = _battery.rest.valid ? _battery.rest.millivolts : _battery.loaded.millivolts + _battery_get_sag();
+
+    int curve = _battery_get_curve(rest);
+
+    // Voltage telling less is left than counted means the pack holds less than its nominal capacity
+    if (!_battery.valid || curve < _battery_get_permille())
+    {
+        _battery_anchor(curve);
+    }
+}
+
+bool battery_get_voltage(bool loaded, int *millivolts)
+{
+    battery_voltage_t *voltage = loaded ? &_battery.loaded : &_battery.rest;
+
+    *millivolts = voltage->millivolts;
+
+    return voltage->valid;
+}
+
+bool battery_get_charge(int *percentage)
+{
+    if (!_battery.valid)
+    {
+        return false;
+    }
+
+    *percentage = _battery_get_permille() / 10;
+
+    return true;
+}
+
+uint32_t battery_get_remaining(void)
+{
+    if (!_battery.valid)
+    {
+        return 0;
+    }
+
+    uint64_t used = (profile_get_charge() - _battery.anchor_charge) / 3600;
+
+    return used < _battery.anchor_remaining ? (_battery.anchor_remaining - used) / 1000 : 0;
+}
+
+bool battery_get_days(uint32_t *days)
+{
+    uint32_t current = profile_get_average_current();
+
+    if (!_battery.valid || current == 0)
+    {
+        return false;
+    }
+
+    *days = (uint32_t) ((uint64_t) battery_get_remaining() * 1000 / current / 24);
+
+    return true;
+}
+
+static void _battery_filter(battery_voltage_t *voltage, int millivolts)
+{
+    if (!voltage->valid)
+    {
+        voltage->valid = true;
+        voltage->millivolts = millivolts;
+
+        return;
+    }
+
+    voltage->millivolts += (millivolts - voltage->millivolts) / (1 << BATTERY_FILTER_SHIFT);
+}
+
+// Drop of the voltage under load [mV], assumed until both kinds were measured
+static int _battery_get_sag(void)
+{
+    if (_battery.rest.valid && _battery.loaded.valid && _battery.rest.millivolts > _battery.loaded.millivolts)
+    {
+        return _battery.rest.millivolts - _battery.loaded.millivolts;
+    }
+
+    return BATTERY_SAG_DEFAULT;
+}
+
+// State of charge [0.1 %] on the curve
+static int _battery_get_curve(int millivolts)
+{
+    size_t length = sizeof(_battery_curve) / sizeof(_battery_curve[0]);
+
+    if (millivolts >= _battery_curve[0].millivolts)
+    {
+        return _battery_curve[0].percentage * 10;
+    }
+
+    for (size_t i = 1; i < length; i++)
+    {
+        if (millivolts >= _battery_curve[i].millivolts)
+        {
+            int span = _battery_curve[i - 1].millivolts - _battery_curve[i].millivolts;
+
+            return _battery_curve[i].percentage * 10 + (millivolts - _battery_curve[i].millivolts) *
+                   (_battery_curve[i - 1].percentage - _battery_curve[i].percentage) * 10 / span;
+        }
+    }
+
+    return 0;
+}
+
+static int _battery_get_permille(void)
+{
+    if (!_battery.valid)
+    {
+        return 0;
+    }
+
+    uint64_t used = (profile_get_charge() - _battery.anchor_charge) / 3600;
+
+    return used < _battery.anchor_remaining ? (int) ((_battery.anchor_remaining - used) / BATTERY_CAPACITY) : 0;
+}
+
+static void _battery_anchor(int permille)
+{
+    _battery.valid = true;
+    _battery.anchor_remaining = (uint64_t) BATTERY_CAPACITY * permille;
+    _battery.anchor_charge = profile_get_charge();
+}
@@ -0,0 +1,142 @@
+#include <co2_sampling.h>
+#include <wake.h>
+#include <twr.h>
+
+// Slopes in ppm per minute
+#define CO2_SAMPLING_SLOPE_FAST 10
+#define CO2_SAMPLING_SLOPE_FLAT 2
+
+static struct
+{
+    twr_tick_t interval_min;
+    twr_tick_t interval_max;
+    twr_tick_t interval;
+    bool motion;
+    bool last_valid;
+    int last_ppm;
+    twr_tick_t last_tick;
+
+    int wake_id;
+
+} _co2_sampling;
+
+static void _co2_sampling_measure(void *param);
+static void _co2_sampling_apply(twr_tick_t interval);
+
+void co2_sampling_init(twr_tick_t interval_min, twr_tick_t interval_max)
+{
+    memset(&_co2_sampling, 0, sizeof(_co2_sampling));
+
+    _co2_sampling.wake_id = wake_register(_co2_sampling_measure, NULL, TWR_TICK_INFINITY);
+
+    co2_sampling_set_bounds(interval_min, interval_max);
+}
+
+void co2_sampling_set_bounds(twr_tick_t interval_min, twr_tick_t interval_max)
+{
+    _co2_sampling.interval_min = interval_min;
+    _co2_sampling.interval_max = interval_max;
+
+    co2_sampling_reset();
+}
+
+twr_tick_t co2_sampling_get_interval_min(void)
+{
+    return _co2_sampling.interval_min;
+}
+
+twr_tick_t co2_sampling_get_interval_max(void)
+{
+    return _co2_sampling.interval_max;
+}
+
+twr_tick_t co2_sampling_get_interval(void)
+{
+    return _co2_sampling.interval;
+}
+
+void co2_sampling_reset(void)
+{
+    _co2_sampling.interval = 0;
+    _co2_sampling.last_valid = false;
+
+    _co2_sampling_apply(_co2_sampling.interval_min);
+}
+
+void co2_sampling_feed(int32_t ppm)
+{
+    twr_tick_t now = twr_tick_get();
+
+    int value = ppm;
+
+    bool motion = _co2_sampling.motion;
+
+    _co2_sampling.motion = false;
+
+    if (!_co2_sampling.last_valid || now == _co2_sampling.last_tick)
+    {
+        _co2_sampling.last_valid = true;
+        _co2_sampling.last_ppm = value;
+        _co2_sampling.last_tick = now;
+
+        return;
+    }
+
+    int slope = (int) ((int64_t) (value - _co2_sampling.last_ppm) * 60 * 1000 / (int64_t) (now - _co2_sampling.last_tick));
+
+    _co2_sampling.last_ppm = value;
+    _co2_sampling.last_tick = now;
+
+    if (slope < 0)
+    {
+        slope = -slope;
+    }
+
+    if (slope >= CO2_SAMPLING_SLOPE_FAST)
+    {
+        _co2_sampling_apply(_co2_sampling.interval_min);
+    }
+    else if (!motion && slope <= CO2_SAMPLING_SLOPE_FLAT)
+    {
+        // Saturates at the maximum, doubling TWR_TICK_INFINITY of the survival tier would wrap
+        bool saturated = _co2_sampling.interval > _co2_sampling.interval_max / 2;
+
+        _co2_sampling_apply(saturated ? _co2_sampling.interval_max : _co2_sampling.interval * 2);
+    }
+}
+
+void co2_sampling_motion(void)
+{
+    if (_co2_sampling.motion)
+    {
+        return;
+    }
+
+    _co2_sampling.motion = true;
+
+    // Occupancy started after a quiet period, do not wait for the long interval
+    if (_co2_sampling.interval > _co2_sampling.interval_min)
+    {
+        _co2_sampling_apply(_co2_sampling.interval_min);
+    }
+}
+
+static void _co2_sampling_apply(twr_tick_t interval)
+{
+    if (interval == _co2_sampling.interval)
+    {
+        return;
+    }
+
+    _co2_sampling.interval = interval;
+
+    // Counts from the last measurement, a shorter interval may be due at the next grid tick already
+    wake_set_interval(_co2_sampling.wake_id, interval);
+}
+
+static void _co2_sampling_measure(void *param)
+{
+    (void) param;
+
+    twr_module_co2_measure();
+}
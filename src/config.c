@@ -0,0 +1,187 @@
+#include <config.h>
+#include <twr.h>
+
+// Layout: magic, version, item count, items as uint16 big endian, check byte, it has to end before the session
+#define CONFIG_MAGIC 0xc5
+#define CONFIG_VERSION 2
+#define CONFIG_HEADER_SIZE 3
+#define CONFIG_SIZE (CONFIG_HEADER_SIZE + CONFIG_COUNT * 2 + 1)
+
+// Enough for items added by later versions
+#define CONFIG_MAX_SIZE 64
+
+static const struct
+{
+    uint16_t value;
+    uint16_t min;
+    uint16_t max;
+
+} _config_limits[CONFIG_COUNT] = {
+        [CONFIG_SEND_INTERVAL] = {15 * 60, 60, 12 * 60 * 60},
+        [CONFIG_MEASURE_INTERVAL] = {60, 10, 60 * 60},
+        [CONFIG_MEASURE_INTERVAL_BAROMETER] = {5 * 60, 10, 60 * 60},
+        [CONFIG_MEASURE_INTERVAL_CO2_MIN] = {5 * 60, 60, 60 * 60},
+        [CONFIG_MEASURE_INTERVAL_CO2_MAX] = {30 * 60, 60, 60 * 60},
+        [CONFIG_SEND_JITTER] = {30, 0, 5 * 60},
+        [CONFIG_MEASURE_TOLERANCE] = {10, 0, 5 * 60},
+        [CONFIG_FLAGS] = {CONFIG_FLAG_POLICY | CONFIG_FLAG_ADAPTIVE_DATARATE, 0, 0x1f},
+        [CONFIG_KEYFRAME_INTERVAL] = {8, 1, 255},
+        [CONFIG_BATCH_SIZE] = {1, 1, 16},
+        [CONFIG_AIRTIME_BUDGET] = {36000, 1000, 36000},
+        [CONFIG_REPORT_HEARTBEAT] = {60, 1, 24 * 60},
+        [CONFIG_DEADBAND_TEMPERATURE] = {3, 0, 0xffff},
+        [CONFIG_DEADBAND_HUMIDITY] = {2, 0, 0xffff},
+        [CONFIG_DEADBAND_ILLUMINANCE] = {50, 0, 0xffff},
+        [CONFIG_DEADBAND_PRESSURE] = {50, 0, 0xffff},
+        [CONFIG_DEADBAND_MOTION] = {0, 0, 0xffff},
+        [CONFIG_DEADBAND_CO2] = {50, 0, 0xffff},
+        [CONFIG_FILTER_TEMPERATURE] = {CONFIG_FILTER(0, 3, 30), CONFIG_FILTER(0, 3, 10), CONFIG_FILTER(3, 9, 255)},
+        [CONFIG_FILTER_HUMIDITY] = {CONFIG_FILTER(0, 3, 30), CONFIG_FILTER(0, 3, 10), CONFIG_FILTER(3, 9, 255)},
+        [CONFIG_FILTER_ILLUMINANCE] = {CONFIG_FILTER(1, 3, 30), CONFIG_FILTER(0, 3, 10), CONFIG_FILTER(3, 9, 255)},
+        [CONFIG_FILTER_PRESSURE] = {CONFIG_FILTER(0, 3, 30), CONFIG_FILTER(0, 3, 10), CONFIG_FILTER(3, 9, 255)},
+        [CONFIG_FILTER_CO2] = {CONFIG_FILTER(2, 3, 30), CONFIG_FILTER(0, 3, 10), CONFIG_FILTER(3, 9, 255)},
+        [CONFIG_THRESHOLD_CO2_LEVEL_1] = {1000, 0, 10000},
+        [CONFIG_THRESHOLD_CO2_LEVEL_2] = {1500, 0, 10000},
+        [CONFIG_THRESHOLD_TEMPERATURE] = {0, 0, 500},
+        [CONFIG_THRESHOLD_MOTION_QUIET] = {0, 0, 24 * 60},
+};
+
+static struct
+{
+    uint32_t address;
+    uint16_t value[CONFIG_COUNT];
+
+} _config;
+
+static uint8_t _config_check(const uint8_t *buffer, size_t length);
+
+void config_init(uint32_t address)
+{
+    memset(&_config, 0, sizeof(_config));
+
+    _config.address = address;
+
+    for (int i = 0; i < CONFIG_COUNT; i++)
+    {
+        _config.value[i] = _config_limits[i].value;
+    }
+
+    uint8_t buffer[CONFIG_MAX_SIZE];
+
+    if (!twr_eeprom_read(address, buffer, CONFIG_HEADER_SIZE) || buffer[0] != CONFIG_MAGIC)
+    {
+        return;
+    }
+
+    // Any version is read as far as the items are known, older layouts are a prefix of the newer ones
+    int count = buffer[2];
+    size_t length = CONFIG_HEADER_SIZE + count * 2 + 1;
+
+    if (length > sizeof(buffer) || !twr_eeprom_read(address, buffer, length) || buffer[length - 1] != _config_check(buffer, length - 1))
+    {
+        return;
+    }
+
+    for (int i = 0; i < count && i < CONFIG_COUNT; i++)
+    {
+        uint16_t value = buffer[CONFIG_HEADER_SIZE + i * 2] << 8 | buffer[CONFIG_HEADER_SIZE + i * 2 + 1];
+
+        if (value >= _config_limits[i].min && value <= _config_limits[i].max)
+        {
+            _config.value[i] = value;
+        }
+    }
+}
+
+twr_tick_t config_get(config_item_t item)
+{
+    return (twr_tick_t) _config.value[item] * 1000;
+}
+
+bool config_set(config_item_t item, twr_tick_t value)
+{
+    if (item >= CONFIG_COUNT || value < config_get_min(item) || value > config_get_max(item))
+    {
+        return false;
+    }
+
+    _config.value[item] = value / 1000;
+
+    return true;
+}
+
+uint16_t config_get_value(config_item_t item)
+{
+    return _config.value[item];
+}
+
+bool config_set_value(config_item_t item, uint16_t value)
+{
+    if (item >= CONFIG_COUNT || value < _config_limits[item].min || value > _config_limits[item].max)
+    {
+        return false;
+    }
+
+    _config.value[item] = value;
+
+    return true;
+}
+
+bool config_get_flag(uint16_t flag)
+{
+    return (_config.value[CONFIG_FLAGS] & flag) != 0;
+}
+
+void config_set_flag(uint16_t flag, bool value)
+{
+    _config.value[CONFIG_FLAGS] = value ? _config.value[CONFIG_FLAGS] | flag : _config.value[CONFIG_FLAGS] & ~flag;
+}
+
+twr_tick_t config_get_min(config_item_t item)
+{
+    return (twr_tick_t) _config_limits[item].min * 1000;
+}
+
+twr_tick_t config_get_max(config_item_t item)
+{
+    return (twr_tick_t) _config_limits[item].max * 1000;
+}
+
+bool config_save(void)
+{
+    uint8_t buffer[CONFIG_SIZE];
+
+    buffer[0] = CONFIG_MAGIC;
+    buffer[1] = CONFIG_VERSION;
+    buffer[2] = CONFIG_COUNT;
+
+    for (int i = 0; i < CONFIG_COUNT; i++)
+    {
+        buffer[CONFIG_HEADER_SIZE + i * 2] = _config.value[i] >> 8;
+        buffer[CONFIG_HEADER_SIZE + i * 2 + 1] = _config.value[i];
+    }
+
+    buffer[CONFIG_SIZE - 1] = _config_check(buffer, CONFIG_SIZE - 1);
+
+    uint8_t stored[CONFIG_SIZE];
+
+    // Spare the EEPROM when nothing changed
+    if (twr_eeprom_read(_config.address, stored, sizeof(stored)) && memcmp(stored, buffer, sizeof(buffer)) == 0)
+    {
+        return true;
+    }
+
+    return twr_eeprom_write(_config.address, buffer, sizeof(buffer));
+}
+
+static uint8_t _config_check(const uint8_t *buffer, size_t length)
+{
+    uint8_t check = 0x5a;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        check = (check << 1 | check >> 7) ^ buffer[i];
+    }
+
+    return check;
+}
@@ -0,0 +1,145 @@
+#include <downlink.h>
+
+static struct
+{
+    const downlink_command_t *commands;
+    size_t length;
+
+    bool processed;
+    uint8_t sequence;
+
+    bool ack;
+    uint8_t status;
+
+} _downlink;
+
+static const downlink_command_t *_downlink_find(uint8_t opcode);
+static size_t _downlink_count(const uint8_t *data, size_t length);
+
+void downlink_init(const downlink_command_t *commands, size_t length)
+{
+    memset(&_downlink, 0, sizeof(_downlink));
+
+    _downlink.commands = commands;
+    _downlink.length = length;
+}
+
+void downlink_process(uint8_t port, const uint8_t *data, size_t length)
+{
+    if (port != DOWNLINK_PORT || length < 2)
+    {
+        return;
+    }
+
+    uint8_t sequence = data[0];
+
+    // A repeated downlink is only acknowledged again
+    if (_downlink.processed && sequence == _downlink.sequence)
+    {
+        _downlink.ack = true;
+
+        return;
+    }
+
+    _downlink.processed = true;
+    _downlink.sequence = sequence;
+    _downlink.ack = true;
+    _downlink.status = DOWNLINK_STATUS_OK;
+
+    // The index of a failing command would not fit the status, nothing is applied
+    if (_downlink_count(data, length) > DOWNLINK_COMMANDS_MAX)
+    {
+        _downlink.status = DOWNLINK_STATUS_BAD_LENGTH;
+
+        return;
+    }
+
+    // Commands run in order, the status carries the code and the index of the first failing one,
+    // the commands before it stay applied
+    size_t offset = 1;
+
+    for (uint8_t index = 0; offset < length; index++)
+    {
+        const downlink_command_t *command = _downlink_find(data[offset]);
+
+        downlink_status_t status = DOWNLINK_STATUS_OK;
+
+        if (command == NULL)
+        {
+            status = DOWNLINK_STATUS_UNKNOWN_OPCODE;
+        }
+        else if (offset + 1 + command->length > length)
+        {
+            status = DOWNLINK_STATUS_BAD_LENGTH;
+        }
+        else if (!command->handler(data + offset + 1))
+        {
+            status = DOWNLINK_STATUS_BAD_VALUE;
+        }
+
+        if (status != DOWNLINK_STATUS_OK)
+        {
+            _downlink.status = (index << 4) | status;
+
+            return;
+        }
+
+        offset += 1 + command->length;
+    }
+}
+
+bool downlink_is_ack_pending(void)
+{
+    return _downlink.ack;
+}
+
+bool downlink_get_ack(uint8_t *buffer)
+{
+    if (!_downlink.ack)
+    {
+        return false;
+    }
+
+    buffer[0] = _downlink.sequence;
+    buffer[1] = _downlink.status;
+
+    return true;
+}
+
+void downlink_ack_sent(void)
+{
+    _downlink.ack = false;
+}
+
+static const downlink_command_t *_downlink_find(uint8_t opcode)
+{
+    for (size_t i = 0; i < _downlink.length; i++)
+    {
+        if (_downlink.commands[i].opcode == opcode)
+        {
+            return &_downlink.commands[i];
+        }
+    }
+
+    return NULL;
+}
+
+// Number of commands up to the end or to the first one that cannot be parsed
+static size_t _downlink_count(const uint8_t *data, size_t length)
+{
+    size_t count = 0;
+
+    for (size_t offset = 1; offset < length; count++)
+    {
+        const downlink_command_t *command = _downlink_find(data[offset]);
+
+        if (command == NULL)
+        {
+            return count + 1;
+        }
+
+        offset += 1 + command->length;
+    }
+
+    return count;
+}
@@ -0,0 +1,132 @@
+#include <filter.h>
+
+// Median absolute deviation scaled to the standard deviation of normal noise, in thousandths
+#define FILTER_MAD_SCALE 1483
+
+static int32_t _filter_median(int32_t *values, uint8_t count);
+
+void filter_init(filter_t *self, filter_mode_t mode, uint8_t window, uint8_t threshold, int32_t floor)
+{
+    memset(self, 0, sizeof(*self));
+
+    self->_mode = mode;
+    self->_window = window < 3 ? 3 : window > FILTER_WINDOW_MAX ? FILTER_WINDOW_MAX : window;
+    self->_threshold = threshold;
+    self->_floor = floor < 1 ? 1 : floor;
+}
+
+bool filter_feed(filter_t *self, int32_t value, int32_t *result)
+{
+    *result = value;
+
+    if (self->_mode == FILTER_MODE_NONE)
+    {
+        return true;
+    }
+
+    self->_buffer[self->_index] = value;
+    self->_index = (self->_index + 1) % self->_window;
+
+    if (self->_count < self->_window)
+    {
+        self->_count++;
+
+        return true;
+    }
+
+    int32_t sorted[FILTER_WINDOW_MAX];
+
+    memcpy(sorted, self->_buffer, self->_window * sizeof(sorted[0]));
+
+    int32_t median = _filter_median(sorted, self->_window);
+
+    if (self->_mode == FILTER_MODE_MEDIAN)
+    {
+        *result = median;
+    }
+    else if (self->_mode == FILTER_MODE_TRIMMED_MEAN)
+    {
+        int64_t sum = 0;
+
+        for (int i = 1; i < self->_window - 1; i++)
+        {
+            sum += sorted[i];
+        }
+
+        int64_t n = self->_window - 2;
+
+        *result = (sum >= 0 ? sum + n / 2 : sum - n / 2) / n;
+    }
+    else if (self->_mode == FILTER_MODE_HAMPEL)
+    {
+        int32_t deviation[FILTER_WINDOW_MAX];
+
+        for (int i = 0; i < self->_window; i++)
+        {
+            deviation[i] = sorted[i] > median ? sorted[i] - median : median - sorted[i];
+        }
+
+        int64_t limit = (int64_t) _filter_median(deviation, self->_window) * FILTER_MAD_SCALE * self->_threshold / 10000;
+
+        // Flat window has no deviation, a step within the noise of the sensor still passes
+        if (limit < self->_floor)
+        {
+            limit = self->_floor;
+        }
+
+        if ((value > median ? value - median : median - value) > limit)
+        {
+            self->_rejected++;
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void filter_invalidate(filter_t *self)
+{
+    self->_count = 0;
+    self->_index = 0;
+}
+
+filter_mode_t filter_get_mode(filter_t *self)
+{
+    return self->_mode;
+}
+
+uint8_t filter_get_window(filter_t *self)
+{
+    return self->_window;
+}
+
+uint8_t filter_get_threshold(filter_t *self)
+{
+    return self->_threshold;
+}
+
+uint32_t filter_get_rejected(filter_t *self)
+{
+    return self->_rejected;
+}
+
+// Sorts the values in place, insertion sort of a few values
+static int32_t _filter_median(int32_t *values, uint8_t count)
+{
+    for (int i = 1; i < count; i++)
+    {
+        int32_t value = values[i];
+        int j = i;
+
+        while (j > 0 && values[j - 1] > value)
+        {
+            values[j] = values[j - 1];
+            j--;
+        }
+
+        values[j] = value;
+    }
+
+    return values[count / 2];
+}
@@ -0,0 +1,422 @@
+#include <join.h>
+#include <lorawan.h>
+#include <airtime.h>
+#include <uplink.h>
+#include <slot.h>
+#include <twr.h>
+
+// Layout: magic, FNV-1a of the credentials as uint32 big endian, check byte
+#define JOIN_SESSION_MAGIC 0x3a
+#define JOIN_SESSION_SIZE 6
+
+// Devices powered on together spread their first attempt over this window
+#define JOIN_FIRST_WINDOW (60 * 1000)
+
+// Spacing of the attempts doubles from the minimum up to the maximum
+#define JOIN_BACKOFF_MIN (30 * 1000)
+#define JOIN_BACKOFF_MAX (60 * 60 * 1000)
+
+// Join request: MHDR, AppEUI, DevEUI, DevNonce and MIC
+#define JOIN_REQUEST_LENGTH 23
+
+// Duty cycle of the join requests since the first attempt, 1 % in the first hour, 0.1 % up to 11 hours,
+// then 0.01 %, expressed as the off-time factor of every attempt
+#define JOIN_DUTY_CYCLE_HOUR (60 * 60 * 1000)
+#define JOIN_DUTY_CYCLE_FACTOR_1 100
+#define JOIN_DUTY_CYCLE_FACTOR_11 1000
+#define JOIN_DUTY_CYCLE_FACTOR 10000
+
+// Link checks and uplinks failing in a row before the session is considered lost
+#define JOIN_SESSION_FAILURES 4
+
+// Link check confirming a resumed session is retried if its result never comes
+#define JOIN_CONFIRM_RETRY (60 * 1000)
+
+static struct
+{
+    twr_cmwx1zzabz_t *lora;
+    uint32_t address;
+
+    join_state_t state;
+
+    twr_scheduler_task_id_t task_id;
+
+    uint32_t attempts;
+    twr_tick_t first_tick;
+    twr_tick_t off_time_end;
+    twr_tick_t next_tick;
+
+    // Data rate to return to once joined
+    uint8_t datarate;
+
+    uint8_t failures;
+
+    // Session resumed after a reboot, not confirmed by a link check yet
+    bool resumed;
+
+} _join;
+
+static void _join_task(void *param);
+static void _join_plan(twr_tick_t delay);
+static void _join_attempt(void);
+static void _join_confirm(void);
+static void _join_feed(bool ok);
+static bool _join_session_load(void);
+static void _join_session_save(bool valid);
+static uint32_t _join_hash(void);
+static uint8_t _join_check(const uint8_t *buffer, size_t length);
+
+void join_init(twr_cmwx1zzabz_t *lora, uint32_t address)
+{
+    memset(&_join, 0, sizeof(_join));
+
+    _join.lora = lora;
+    _join.address = address;
+    _join.state = JOIN_STATE_ABP;
+
+    if (twr_cmwx1zzabz_get_mode(lora) == TWR_CMWX1ZZABZ_CONFIG_MODE_OTAA)
+    {
+        // The module keeps the session it joined over a reset, but not over a brownout, a link check tells
+        _join.resumed = _join_session_load();
+        _join.state = _join.resumed ? JOIN_STATE_JOINED : JOIN_STATE_JOINING;
+    }
+
+    _join.task_id = twr_scheduler_register(_join_task, NULL, TWR_TICK_INFINITY);
+
+    uplink_register(UPLINK_CLASS_JOIN, _join.task_id);
+
+    // Also picks up the mode changed after boot
+    _join_plan(slot_get_random_range(JOIN_FIRST_WINDOW));
+}
+
+void join_feed_result(bool ok)
+{
+    if (twr_cmwx1zzabz_get_mode(_join.lora) != TWR_CMWX1ZZABZ_CONFIG_MODE_OTAA)
+    {
+        _join.state = JOIN_STATE_ABP;
+
+        return;
+    }
+
+    if (ok)
+    {
+        if (_join.attempts != 0)
+        {
+            twr_cmwx1zzabz_set_datarate(_join.lora, _join.datarate);
+        }
+
+        _join.state = JOIN_STATE_JOINED;
+        _join.attempts = 0;
+        _join.failures = 0;
+        _join.resumed = false;
+
+        _join_plan(TWR_TICK_INFINITY);
+
+        _join_session_save(true);
+
+        return;
+    }
+
+    // Also a manual join that failed, the module has no session anymore
+    if (_join.state == JOIN_STATE_JOINED)
+    {
+        join_restart();
+
+        return;
+    }
+
+    _join.state = JOIN_STATE_JOINING;
+
+    twr_tick_t backoff = JOIN_BACKOFF_MIN;
+
+    for (uint32_t i = 1; i < _join.attempts && backoff < JOIN_BACKOFF_MAX; i++)
+    {
+        backoff *= 2;
+    }
+
+    if (backoff > JOIN_BACKOFF_MAX)
+    {
+        backoff = JOIN_BACKOFF_MAX;
+    }
+
+    // Equal jitter, devices failing together drift apart
+    twr_tick_t delay = backoff / 2 + slot_get_random_range(backoff / 2);
+
+    twr_tick_t now = twr_tick_get();
+
+    if (_join.off_time_end > now + delay)
+    {
+        delay = _join.off_time_end - now;
+    }
+
+    _join_plan(delay);
+}
+
+void join_feed_link_check(bool ok)
+{
+    _join_feed(ok);
+}
+
+void join_feed_error(void)
+{
+    _join_feed(false);
+}
+
+void join_restart(void)
+{
+    if (twr_cmwx1zzabz_get_mode(_join.lora) != TWR_CMWX1ZZABZ_CONFIG_MODE_OTAA)
+    {
+        return;
+    }
+
+    _join_session_save(false);
+
+    _join.state = JOIN_STATE_JOINING;
+    _join.attempts = 0;
+    _join.failures = 0;
+    _join.resumed = false;
+
+    _join_plan(slot_get_random_range(JOIN_FIRST_WINDOW));
+}
+
+join_state_t join_get_state(void)
+{
+    return _join.state;
+}
+
+bool join_is_joined(void)
+{
+    // Mode changed after boot counts before the task notices, a resumed session only once a link check confirmed it
+    return twr_cmwx1zzabz_get_mode(_join.lora) != TWR_CMWX1ZZABZ_CONFIG_MODE_OTAA ||
+           (_join.state == JOIN_STATE_JOINED && !_join.resumed);
+}
+
+uint32_t join_get_attempts(void)
+{
+    return _join.attempts;
+}
+
+twr_tick_t join_get_delay(void)
+{
+    twr_tick_t now = twr_tick_get();
+
+    if (_join.next_tick == TWR_TICK_INFINITY || _join.next_tick <= now)
+    {
+        return 0;
+    }
+
+    return _join.next_tick - now;
+}
+
+static void _join_task(void *param)
+{
+    (void) param;
+
+    _join.next_tick = TWR_TICK_INFINITY;
+
+    if (twr_cmwx1zzabz_get_mode(_join.lora) != TWR_CMWX1ZZABZ_CONFIG_MODE_OTAA)
+    {
+        _join.state = JOIN_STATE_ABP;
+
+        return;
+    }
+
+    if (_join.state == JOIN_STATE_JOINED && !_join.resumed)
+    {
+        return;
+    }
+
+    if (!uplink_acquire(UPLINK_CLASS_JOIN))
+    {
+        return;
+    }
+
+    if (_join.state == JOIN_STATE_JOINED)
+    {
+        _join_confirm();
+    }
+    else
+    {
+        _join.state = JOIN_STATE_JOINING;
+
+        _join_attempt();
+    }
+
+    uplink_release();
+}
+
+static void _join_feed(bool ok)
+{
+    if (_join.state != JOIN_STATE_JOINED)
+    {
+        return;
+    }
+
+    if (ok)
+    {
+        _join.failures = 0;
+
+        if (_join.resumed)
+        {
+            _join.resumed = false;
+
+            _join_plan(TWR_TICK_INFINITY);
+        }
+
+        return;
+    }
+
+    // Outage or a session the network forgot, joining again covers both
+    if (++_join.failures >= JOIN_SESSION_FAILURES)
+    {
+        join_restart();
+    }
+}
+
+static void _join_plan(twr_tick_t delay)
+{
+    _join.next_tick = delay == TWR_TICK_INFINITY ? TWR_TICK_INFINITY : twr_tick_get() + delay;
+
+    twr_scheduler_plan_absolute(_join.task_id, _join.next_tick);
+}
+
+static void _join_attempt(void)
+{
+    twr_cmwx1zzabz_config_band_t band = twr_cmwx1zzabz_get_band(_join.lora);
+
+    if (_join.attempts == 0)
+    {
+        _join.first_tick = twr_tick_get();
+        _join.datarate = twr_cmwx1zzabz_get_datarate(_join.lora);
+    }
+
+    // Fastest data rate first, every other failure widens the range towards the slowest at random
+    uint8_t max = lorawan_get_max_datarate(band);
+    uint32_t span = _join.attempts / 2 < max ? _join.attempts / 2 : max;
+
+    twr_cmwx1zzabz_set_datarate(_join.lora, max - slot_get_random_range(span));
+
+    twr_tick_t delay = airtime_get_delay(JOIN_REQUEST_LENGTH - LORAWAN_MAC_OVERHEAD);
+
+    if (delay != 0)
+    {
+        airtime_deferred();
+
+        _join_plan(delay);
+
+        return;
+    }
+
+    twr_tick_t now = twr_tick_get();
+
+    twr_tick_t elapsed = now - _join.first_tick;
+
+    uint32_t factor = elapsed < JOIN_DUTY_CYCLE_HOUR ? JOIN_DUTY_CYCLE_FACTOR_1 :
+                      elapsed < 11 * JOIN_DUTY_CYCLE_HOUR ? JOIN_DUTY_CYCLE_FACTOR_11 : JOIN_DUTY_CYCLE_FACTOR;
+
+    uint32_t airtime = lorawan_get_airtime(band, twr_cmwx1zzabz_get_datarate(_join.lora), JOIN_REQUEST_LENGTH - LORAWAN_MAC_OVERHEAD);
+
+    _join.off_time_end = now + (twr_tick_t) airtime * factor;
+    _join.attempts++;
+
+    twr_cmwx1zzabz_join(_join.lora);
+
+    // Join request is transmitted once
+    airtime_sent(JOIN_REQUEST_LENGTH - LORAWAN_MAC_OVERHEAD, true);
+}
+
+// Link check of the resumed session, the module refuses it without a session
+static void _join_confirm(void)
+{
+    twr_tick_t delay = airtime_get_delay(0);
+
+    if (delay != 0)
+    {
+        airtime_deferred();
+
+        _join_plan(delay);
+
+        return;
+    }
+
+    twr_cmwx1zzabz_link_check(_join.lora);
+
+    airtime_sent(0, false);
+
+    _join_plan(JOIN_CONFIRM_RETRY);
+}
+
+static bool _join_session_load(void)
+{
+    uint8_t buffer[JOIN_SESSION_SIZE];
+
+    if (!twr_eeprom_read(_join.address, buffer, sizeof(buffer)) || buffer[0] != JOIN_SESSION_MAGIC ||
+        buffer[sizeof(buffer) - 1] != _join_check(buffer, sizeof(buffer) - 1))
+    {
+        return false;
+    }
+
+    uint32_t hash = (uint32_t) buffer[1] << 24 | (uint32_t) buffer[2] << 16 | (uint32_t) buffer[3] << 8 | buffer[4];
+
+    // Credentials changed since, the session belongs to another device
+    return hash == _join_hash();
+}
+
+static void _join_session_save(bool valid)
+{
+    uint8_t buffer[JOIN_SESSION_SIZE] = { 0 };
+
+    if (valid)
+    {
+        uint32_t hash = _join_hash();
+
+        buffer[0] = JOIN_SESSION_MAGIC;
+        buffer[1] = hash >> 24;
+        buffer[2] = hash >> 16;
+        buffer[3] = hash >> 8;
+        buffer[4] = hash;
+        buffer[sizeof(buffer) - 1] = _join_check(buffer, sizeof(buffer) - 1);
+    }
+
+    uint8_t stored[JOIN_SESSION_SIZE];
+
+    // Rejoins of a device that never moves write the same record
+    if (twr_eeprom_read(_join.address, stored, sizeof(stored)) && memcmp(stored, buffer, sizeof(buffer)) == 0)
+    {
+        return;
+    }
+
+    twr_eeprom_write(_join.address, buffer, sizeof(buffer));
+}
+
+// FNV-1a of the DevEUI, AppEUI and AppKey
+static uint32_t _join_hash(void)
+{
+    char credentials[16 + 16 + 32 + 1];
+
+    twr_cmwx1zzabz_get_deveui(_join.lora, credentials);
+    twr_cmwx1zzabz_get_appeui(_join.lora, credentials + 16);
+    twr_cmwx1zzabz_get_appkey(_join.lora, credentials + 32);
+
+    uint32_t hash = 2166136261UL;
+
+    for (size_t i = 0; i < sizeof(credentials) && credentials[i] != '\0'; i++)
+    {
+        hash ^= (uint8_t) credentials[i];
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+static uint8_t _join_check(const uint8_t *buffer, size_t length)
+{
+    uint8_t check = 0x5a;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        check = (check << 1 | check >> 7) ^ buffer[i];
+    }
+
+    return check;
+}
@@ -0,0 +1,234 @@
+#include <link.h>
+#include <lorawan.h>
+#include <twr.h>
+
+// Quality limits of the margin in tenths of dB
+#define LINK_MARGIN_FAIR 60
+#define LINK_MARGIN_POOR 30
+
+// One data rate step is worth 2.5 dB, a faster one is tried above 10 dB margin after the step
+#define LINK_MARGIN_DATARATE_UP 125
+#define LINK_MARGIN_DATARATE_STEP 25
+
+// Samples between two data rate steps
+#define LINK_DATARATE_HOLD 4
+
+// Consecutive failures of a poor link
+#define LINK_FAILURES_POOR 2
+
+static const struct
+{
+    uint8_t repeat_unconfirmed;
+    uint8_t repeat_confirmed;
+
+} _link_repeat[] = {
+        [LINK_QUALITY_GOOD] = {1, 2},
+        [LINK_QUALITY_FAIR] = {2, 4},
+        [LINK_QUALITY_POOR] = {3, 8}
+};
+
+static struct
+{
+    twr_cmwx1zzabz_t *lora;
+    bool enabled;
+    bool adaptive_datarate;
+
+    // Exponential averages, margin in tenths of dB, delivery in tenths of percent
+    int32_t margin;
+    bool margin_valid;
+    int32_t delivery;
+
+    int failures;
+    int samples;
+
+    link_quality_t repeat_limit;
+
+} _link;
+
+static void _link_feed_margin(int32_t margin);
+static void _link_adapt_datarate(void);
+
+void link_init(twr_cmwx1zzabz_t *lora)
+{
+    memset(&_link, 0, sizeof(_link));
+
+    _link.lora = lora;
+    _link.enabled = true;
+    _link.adaptive_datarate = true;
+    _link.delivery = 1000;
+    _link.repeat_limit = LINK_QUALITY_POOR;
+}
+
+void link_set_enabled(bool enabled)
+{
+    _link.enabled = enabled;
+}
+
+bool link_is_enabled(void)
+{
+    return _link.enabled;
+}
+
+void link_set_adaptive_datarate(bool enabled)
+{
+    _link.adaptive_datarate = enabled;
+}
+
+bool link_get_adaptive_datarate(void)
+{
+    return _link.adaptive_datarate;
+}
+
+void link_feed_snr(int32_t snr)
+{
+    int32_t floor = lorawan_get_snr_floor(twr_cmwx1zzabz_get_band(_link.lora), twr_cmwx1zzabz_get_datarate(_link.lora));
+
+    _link_feed_margin(snr * 10 - floor);
+}
+
+void link_feed_link_check(bool ok, uint8_t margin)
+{
+    if (ok)
+    {
+        _link.failures = 0;
+
+        _link_feed_margin((int32_t) margin * 10);
+    }
+    else
+    {
+        link_feed_error();
+    }
+}
+
+void link_feed_confirmed(bool ok)
+{
+    _link.delivery += ((ok ? 1000 : 0) - _link.delivery) / 8;
+
+    if (ok)
+    {
+        _link.failures = 0;
+    }
+    else
+    {
+        link_feed_error();
+    }
+}
+
+void link_feed_error(void)
+{
+    _link.failures++;
+    _link.samples++;
+
+    _link_adapt_datarate();
+}
+
+link_quality_t link_get_quality(void)
+{
+    if (_link.failures >= LINK_FAILURES_POOR || (_link.margin_valid && _link.margin < LINK_MARGIN_POOR))
+    {
+        return LINK_QUALITY_POOR;
+    }
+
+    // Nothing known yet counts as good, the network may still request more by ADR
+    if (_link.failures > 0 || (_link.margin_valid && _link.margin < LINK_MARGIN_FAIR))
+    {
+        return LINK_QUALITY_FAIR;
+    }
+
+    return LINK_QUALITY_GOOD;
+}
+
+bool link_get_margin(int32_t *margin)
+{
+    *margin = _link.margin;
+
+    return _link.margin_valid;
+}
+
+uint8_t link_get_delivery(void)
+{
+    return (_link.delivery + 5) / 10;
+}
+
+void link_set_repeat_limit(link_quality_t quality)
+{
+    _link.repeat_limit = quality;
+}
+
+bool link_apply(link_class_t link_class)
+{
+    if (!_link.enabled)
+    {
+        return false;
+    }
+
+    link_quality_t quality = link_get_quality();
+
+    if (quality > _link.repeat_limit)
+    {
+        quality = _link.repeat_limit;
+    }
+
+    if (link_class == LINK_CLASS_ALARM)
+    {
+        // Retries are spent only when the acknowledgement is missing
+        twr_cmwx1zzabz_set_repeat_confirmed(_link.lora, _link_repeat[quality].repeat_confirmed);
+
+        return true;
+    }
+
+    twr_cmwx1zzabz_set_repeat_unconfirmed(_link.lora, _link_repeat[quality].repeat_unconfirmed);
+
+    return false;
+}
+
+static void _link_feed_margin(int32_t margin)
+{
+    if (_link.margin_valid)
+    {
+        _link.margin += (margin - _link.margin) / 4;
+    }
+    else
+    {
+        _link.margin = margin;
+        _link.margin_valid = true;
+    }
+
+    _link.samples++;
+
+    _link_adapt_datarate();
+}
+
+static void _link_adapt_datarate(void)
+{
+    if (!_link.enabled || !_link.adaptive_datarate || twr_cmwx1zzabz_get_adaptive_datarate(_link.lora) ||
+        _link.samples < LINK_DATARATE_HOLD)
+    {
+        return;
+    }
+
+    uint8_t datarate = twr_cmwx1zzabz_get_datarate(_link.lora);
+    uint8_t datarate_max = lorawan_get_max_datarate(twr_cmwx1zzabz_get_band(_link.lora));
+
+    if (link_get_quality() == LINK_QUALITY_POOR && datarate > 0)
+    {
+        datarate--;
+
+        _link.margin += LINK_MARGIN_DATARATE_STEP;
+        _link.failures = 0;
+    }
+    else if (_link.failures == 0 && _link.margin_valid && _link.margin >= LINK_MARGIN_DATARATE_UP && datarate < datarate_max)
+    {
+        datarate++;
+
+        _link.margin -= LINK_MARGIN_DATARATE_STEP;
+    }
+    else
+    {
+        return;
+    }
+
+    twr_cmwx1zzabz_set_datarate(_link.lora, datarate);
+
+    _link.samples = 0;
+}
@@ -0,0 +1,94 @@
+#include <lorawan.h>
+
+// LoRaWAN Regional Parameters, AS923, KR920 and IN865 follow the EU868 table
+static const uint8_t _lorawan_max_payload_eu868[] = {51, 51, 51, 115, 222, 222, 222, 222};
+static const uint8_t _lorawan_max_payload_us915[] = {11, 53, 125, 242, 242};
+static const uint8_t _lorawan_max_payload_au915[] = {51, 51, 51, 115, 242, 242, 242};
+
+size_t lorawan_get_max_payload(twr_cmwx1zzabz_config_band_t band, uint8_t datarate)
+{
+    const uint8_t *table = _lorawan_max_payload_eu868;
+    size_t length = sizeof(_lorawan_max_payload_eu868);
+
+    if (band == TWR_CMWX1ZZABZ_CONFIG_BAND_US915)
+    {
+        table = _lorawan_max_payload_us915;
+        length = sizeof(_lorawan_max_payload_us915);
+    }
+    else if (band == TWR_CMWX1ZZABZ_CONFIG_BAND_AU915)
+    {
+        table = _lorawan_max_payload_au915;
+        length = sizeof(_lorawan_max_payload_au915);
+    }
+
+    if (datarate >= length)
+    {
+        // Unknown data rate, use the smallest payload of the band
+        return table[0];
+    }
+
+    return table[datarate];
+}
+
+static void _lorawan_get_modulation(twr_cmwx1zzabz_config_band_t band, uint8_t datarate, uint32_t *sf, uint32_t *bw)
+{
+    if (band == TWR_CMWX1ZZABZ_CONFIG_BAND_US915 || band == TWR_CMWX1ZZABZ_CONFIG_BAND_AU915)
+    {
+        // US915 DR0 - DR3 are SF10 - SF7 at 125 kHz, DR4 is SF8 at 500 kHz, AU915 is shifted by two
+        uint8_t dr = band == TWR_CMWX1ZZABZ_CONFIG_BAND_AU915 ? (datarate < 2 ? 0 : datarate - 2) : datarate;
+
+        *sf = dr < 4 ? 10 - dr : 8;
+        *bw = dr < 4 ? 125 : 500;
+    }
+    else
+    {
+        // DR0 - DR5 are SF12 - SF7 at 125 kHz, DR6 is SF7 at 250 kHz
+        *sf = datarate <= 5 ? 12 - datarate : 7;
+        *bw = datarate == 6 ? 250 : 125;
+    }
+}
+
+uint32_t lorawan_get_airtime(twr_cmwx1zzabz_config_band_t band, uint8_t datarate, size_t length)
+{
+    uint32_t sf;
+    uint32_t bw;
+
+    _lorawan_get_modulation(band, datarate, &sf, &bw);
+
+    // Low data rate optimization is mandatory for symbols longer than 16 ms
+    uint32_t de = (sf >= 11 && bw == 125) ? 1 : 0;
+
+    uint32_t t_sym_us = (1000UL << sf) / bw;
+
+    int32_t numerator = 8 * (int32_t) (length + LORAWAN_MAC_OVERHEAD) - 4 * (int32_t) sf + 28 + 16;
+    int32_t denominator = 4 * (sf - 2 * de);
+
+    int32_t symbols = numerator > 0 ? (numerator + denominator - 1) / denominator * 5 : 0;
+
+    // Preamble of 8 symbols plus 4.25 symbols of sync word, 8 symbols of header
+    uint32_t airtime_us = t_sym_us * (8 + 8 + symbols) + t_sym_us * 17 / 4;
+
+    return (airtime_us + 999) / 1000;
+}
+
+int32_t lorawan_get_snr_floor(twr_cmwx1zzabz_config_band_t band, uint8_t datarate)
+{
+    uint32_t sf;
+    uint32_t bw;
+
+    _lorawan_get_modulation(band, datarate, &sf, &bw);
+
+    // SX1276 demodulator, -7.5 dB at SF7 and 2.5 dB lower with every step of the spreading factor
+    return -75 - 25 * ((int32_t) sf - 7);
+}
+
+uint8_t lorawan_get_max_datarate(twr_cmwx1zzabz_config_band_t band)
+{
+    // Highest data rate of 125 kHz channels, the faster ones need a gateway nearby
+    if (band == TWR_CMWX1ZZABZ_CONFIG_BAND_US915)
+    {
+        return 3;
+    }
+
+    return 5;
+}
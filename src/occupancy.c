@@ -0,0 +1,67 @@
+#include <occupancy.h>
+#include <twr.h>
+
+#define OCCUPANCY_MINUTE (60 * 1000)
+
+static struct
+{
+    twr_tick_t start_tick;
+
+    // Minute of the last motion counted, -1 before the first one
+    int32_t minute;
+
+    occupancy_t occupancy;
+
+} _occupancy;
+
+void occupancy_init(twr_tick_t interval)
+{
+    memset(&_occupancy, 0, sizeof(_occupancy));
+
+    occupancy_start(interval);
+}
+
+void occupancy_start(twr_tick_t interval)
+{
+    uint32_t minutes = (interval + OCCUPANCY_MINUTE - 1) / OCCUPANCY_MINUTE;
+    uint32_t bin = (minutes + OCCUPANCY_BINS - 1) / OCCUPANCY_BINS;
+
+    memset(&_occupancy.occupancy, 0, sizeof(_occupancy.occupancy));
+
+    _occupancy.occupancy.bin = bin == 0 ? 1 : bin > 255 ? 255 : bin;
+    _occupancy.start_tick = twr_tick_get();
+    _occupancy.minute = -1;
+}
+
+void occupancy_motion(void)
+{
+    occupancy_t *occupancy = &_occupancy.occupancy;
+
+    int32_t minute = (twr_tick_get() - _occupancy.start_tick) / OCCUPANCY_MINUTE;
+
+    // Motions come in order, only the first one of every minute counts
+    if (minute == _occupancy.minute)
+    {
+        return;
+    }
+
+    if (_occupancy.minute < 0)
+    {
+        occupancy->first = minute;
+    }
+
+    _occupancy.minute = minute;
+
+    occupancy->minutes++;
+    occupancy->last = minute;
+
+    // Interval stretched by the jitter or a postponed uplink ends in the last bin
+    uint32_t index = minute / occupancy->bin;
+
+    occupancy->bitmap |= 1 << (index < OCCUPANCY_BINS ? index : OCCUPANCY_BINS - 1);
+}
+
+void occupancy_get(occupancy_t *occupancy)
+{
+    *occupancy = _occupancy.occupancy;
+}
@@ -0,0 +1,302 @@
+#include <payload.h>
+
+#define PAYLOAD_KEYFRAME_INTERVAL_DEFAULT 8
+
+static struct
+{
+    payload_format_t format;
+    bool stats;
+    uint8_t keyframe_interval;
+    uint8_t frames_since_keyframe;
+    uint8_t sequence;
+    bool keyframe_valid;
+    payload_t keyframe;
+
+} _payload;
+
+static size_t _payload_put_varint(uint8_t *buffer, size_t size, size_t length, uint32_t value);
+static uint32_t _payload_zigzag(int32_t value);
+
+void payload_init(void)
+{
+    memset(&_payload, 0, sizeof(_payload));
+
+    _payload.format = PAYLOAD_FORMAT_STANDARD;
+    _payload.keyframe_interval = PAYLOAD_KEYFRAME_INTERVAL_DEFAULT;
+}
+
+void payload_set_format(payload_format_t format)
+{
+    _payload.format = format;
+
+    payload_request_keyframe();
+}
+
+payload_format_t payload_get_format(void)
+{
+    return _payload.format;
+}
+
+void payload_set_stats(bool stats)
+{
+    _payload.stats = stats;
+}
+
+bool payload_get_stats(void)
+{
+    return _payload.stats;
+}
+
+void payload_set_keyframe_interval(uint8_t interval)
+{
+    _payload.keyframe_interval = interval;
+}
+
+uint8_t payload_get_keyframe_interval(void)
+{
+    return _payload.keyframe_interval;
+}
+
+void payload_request_keyframe(void)
+{
+    _payload.keyframe_valid = false;
+}
+
+int16_t payload_get_temperature(int32_t value)
+{
+    int16_t temperature = value / 10;
+
+    // 0xffff marks a missing value in the 16-bit fields
+    return temperature == -1 ? -2 : temperature;
+}
+
+size_t payload_encode(const payload_t *payload, uint8_t *buffer, size_t size)
+{
+    if (_payload.format == PAYLOAD_FORMAT_COMPACT)
+    {
+        return payload_encode_compact(payload, buffer, size);
+    }
+
+    return payload_encode_standard(payload, buffer, size);
+}
+
+size_t payload_encode_standard(const payload_t *payload, uint8_t *buffer, size_t size)
+{
+    size_t length = PAYLOAD_STANDARD_SIZE + (_payload.stats ? PAYLOAD_STATS_SIZE : 0) + PAYLOAD_OCCUPANCY_SIZE;
+
+    if (size < length)
+    {
+        return 0;
+    }
+
+    memset(buffer, 0xff, length);
+
+    buffer[0] = payload->header;
+
+    if (payload->fields & PAYLOAD_FIELD_VOLTAGE)
+    {
+        buffer[1] = payload->voltage;
+    }
+
+    if (payload->fields & PAYLOAD_FIELD_ORIENTATION)
+    {
+        buffer[2] = payload->orientation;
+    }
+
+    if (payload->fields & PAYLOAD_FIELD_TEMPERATURE)
+    {
+        buffer[3] = payload->temperature >> 8;
+        buffer[4] = payload->temperature;
+    }
+
+    if (payload->fields & PAYLOAD_FIELD_HUMIDITY)
+    {
+        buffer[5] = payload->humidity;
+    }
+
+    if (payload->fields & PAYLOAD_FIELD_ILLUMINANCE)
+    {
+        buffer[6] = payload->illuminance >> 8;
+        buffer[7] = payload->illuminance;
+    }
+
+    if (payload->fields & PAYLOAD_FIELD_PRESSURE)
+    {
+        buffer[8] = payload->pressure >> 8;
+        buffer[9] = payload->pressure;
+    }
+
+    if (payload->fields & PAYLOAD_FIELD_PIR_MOTION_COUNT)
+    {
+        buffer[10] = payload->pir_motion_count >> 24;
+        buffer[11] = payload->pir_motion_count >> 16;
+        buffer[12] = payload->pir_motion_count >> 8;
+        buffer[13] = payload->pir_motion_count;
+
+        // Appended so the bytes of the counter keep their meaning for the decoders in the field
+        uint8_t *occupancy = buffer + length - PAYLOAD_OCCUPANCY_SIZE;
+
+        occupancy[0] = payload->occupancy.minutes > 254 ? 254 : payload->occupancy.minutes;
+        occupancy[1] = payload->occupancy.bin;
+        occupancy[2] = payload->occupancy.bitmap >> 8;
+        occupancy[3] = payload->occupancy.bitmap;
+    }
+
+    if (payload->fields & PAYLOAD_FIELD_CO2)
+    {
+        buffer[14] = payload->co2 >> 8;
+        buffer[15] = payload->co2;
+    }
+
+    if (!_payload.stats)
+    {
+        return length;
+    }
+
+    if (payload->fields & PAYLOAD_FIELD_TEMPERATURE)
+    {
+        buffer[16] = payload->temperature_min >> 8;
+        buffer[17] = payload->temperature_min;
+        buffer[18] = payload->temperature_max >> 8;
+        buffer[19] = payload->temperature_max;
+        buffer[20] = payload->temperature_stddev;
+    }
+
+    if (payload->fields & PAYLOAD_FIELD_CO2)
+    {
+        buffer[21] = payload->co2_min >> 8;
+        buffer[22] = payload->co2_min;
+        buffer[23] = payload->co2_max >> 8;
+        buffer[24] = payload->co2_max;
+        buffer[25] = payload->co2_stddev >> 8;
+        buffer[26] = payload->co2_stddev;
+    }
+
+    return length;
+}
+
+// Compact frame: header, field bitmap and one varint per field in the bitmap order.
+// Keyframe carries absolute values, other frames carry zigzag deltas against the last keyframe
+// and leave out the fields without change. PIR motion count is always an unsigned delta in a delta frame.
+size_t payload_encode_compact(const payload_t *payload, uint8_t *buffer, size_t size)
+{
+    if (size < PAYLOAD_COMPACT_MAX_SIZE)
+    {
+        return 0;
+    }
+
+    const payload_t *keyframe = &_payload.keyframe;
+
+    // A field which appeared or disappeared since the keyframe can be expressed only by a new keyframe
+    bool is_keyframe = !_payload.keyframe_valid ||
+            _payload.frames_since_keyframe + 1 >= _payload.keyframe_interval ||
+            keyframe->fields != payload->fields ||
+            keyframe->tier != payload->tier ||
+            payload->pir_motion_count < keyframe->pir_motion_count;
+
+    if (is_keyframe)
+    {
+        _payload.keyframe = *payload;
+        _payload.keyframe_valid = true;
+        _payload.frames_since_keyframe = 0;
+        _payload.sequence++;
+    }
+    else
+    {
+        _payload.frames_since_keyframe++;
+    }
+
+    int32_t value[8] = {
+            payload->voltage - keyframe->voltage,
+            payload->orientation - keyframe->orientation,
+            payload->temperature - keyframe->temperature,
+            payload->humidity - keyframe->humidity,
+            payload->illuminance - keyframe->illuminance,
+            payload->pressure - keyframe->pressure,
+            0,
+            payload->co2 - keyframe->co2,
+    };
+
+    if (is_keyframe)
+    {
+        value[0] = payload->voltage;
+        value[1] = payload->orientation;
+        value[2] = payload->temperature;
+        value[3] = payload->humidity;
+        value[4] = payload->illuminance;
+        value[5] = payload->pressure;
+        value[7] = payload->co2;
+    }
+
+    uint32_t pir_motion_count = is_keyframe ? payload->pir_motion_count : payload->pir_motion_count - keyframe->pir_motion_count;
+
+    uint8_t fields = payload->fields;
+
+    buffer[0] = PAYLOAD_HEADER_COMPACT | (payload->header & PAYLOAD_HEADER_MASK) |
+            ((_payload.sequence << PAYLOAD_HEADER_SEQUENCE_SHIFT) & PAYLOAD_HEADER_SEQUENCE_MASK);
+
+    if (is_keyframe)
+    {
+        buffer[0] |= PAYLOAD_HEADER_KEYFRAME;
+    }
+
+    size_t length = 2;
+
+    for (int i = 0; i < 8; i++)
+    {
+        uint8_t field = 1 << i;
+
+        if (!(fields & field))
+        {
+            continue;
+        }
+
+        if (field == PAYLOAD_FIELD_PIR_MOTION_COUNT)
+        {
+            length = _payload_put_varint(buffer, size, length, pir_motion_count);
+        }
+        else if (!is_keyframe && value[i] == 0)
+        {
+            fields &= ~field;
+        }
+        else if (is_keyframe && field != PAYLOAD_FIELD_TEMPERATURE)
+        {
+            length = _payload_put_varint(buffer, size, length, (uint32_t) value[i]);
+        }
+        else
+        {
+            length = _payload_put_varint(buffer, size, length, _payload_zigzag(value[i]));
+        }
+    }
+
+    buffer[1] = fields;
+
+    // The header has no room for the tier, delta frames share the one of their keyframe
+    if (is_keyframe && payload->tier != 0 && length < size)
+    {
+        buffer[length++] = payload->tier;
+    }
+
+    return length;
+}
+
+static size_t _payload_put_varint(uint8_t *buffer, size_t size, size_t length, uint32_t value)
+{
+    while (value >= 0x80 && length < size)
+    {
+        buffer[length++] = (value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+
+    if (length < size)
+    {
+        buffer[length++] = value;
+    }
+
+    return length;
+}
+
+static uint32_t _payload_zigzag(int32_t value)
+{
+    return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+}
@@ -0,0 +1,73 @@
+#include <power.h>
+#include <battery.h>
+#include <twr.h>
+
+// Thresholds of the tiers below normal, state of charge [%] and voltage under load [mV]
+static const struct
+{
+    int charge;
+    int loaded;
+
+} _power_threshold[] = {
+        [POWER_TIER_ECO] = {20, 4600},
+        [POWER_TIER_SURVIVAL] = {5, 4200},
+};
+
+// Margin above the threshold to leave a tier
+#define POWER_HYSTERESIS_CHARGE 5
+#define POWER_HYSTERESIS_LOADED 200
+
+static struct
+{
+    power_tier_t tier;
+
+} _power;
+
+static bool _power_is_below(power_tier_t tier, int margin_charge, int margin_loaded);
+
+void power_init(void)
+{
+    memset(&_power, 0, sizeof(_power));
+}
+
+bool power_update(void)
+{
+    power_tier_t tier = _power.tier;
+
+    // Deeper tier first, the state of charge only falls between two battery swaps
+    while (tier < POWER_TIER_SURVIVAL && _power_is_below(tier + 1, 0, 0))
+    {
+        tier++;
+    }
+
+    while (tier > POWER_TIER_NORMAL && !_power_is_below(tier, POWER_HYSTERESIS_CHARGE, POWER_HYSTERESIS_LOADED))
+    {
+        tier--;
+    }
+
+    if (tier == _power.tier)
+    {
+        return false;
+    }
+
+    _power.tier = tier;
+
+    return true;
+}
+
+power_tier_t power_get_tier(void)
+{
+    return _power.tier;
+}
+
+static bool _power_is_below(power_tier_t tier, int margin_charge, int margin_loaded)
+{
+    int value;
+
+    if (battery_get_charge(&value) && value <= _power_threshold[tier].charge + margin_charge)
+    {
+        return true;
+    }
+
+    return battery_get_voltage(true, &value) && value < _power_threshold[tier].loaded + margin_loaded;
+}
@@ -0,0 +1,286 @@
+#include <profile.h>
+#include <twr.h>
+
+#define PROFILE_DAY (24 * 60 * 60 * 1000)
+#define PROFILE_HOUR (60 * 60 * 1000)
+
+// Sources active at the same time, measure jobs within a task within a callback
+#define PROFILE_DEPTH_MAX 8
+
+// Supply currents in microamperes, rough datasheet figures for the whole board
+#define PROFILE_CURRENT_MCU_RUN 2500
+#define PROFILE_CURRENT_SLEEP 20
+
+static const struct
+{
+    uint32_t current;
+    twr_tick_t active;
+
+} _profile_peripheral[PROFILE_PERIPHERAL_COUNT] = {
+        [PROFILE_PERIPHERAL_THERMOMETER] = {40, 35},
+        [PROFILE_PERIPHERAL_HYGROMETER] = {300, 30},
+        [PROFILE_PERIPHERAL_LUX_METER] = {2, 800},
+        [PROFILE_PERIPHERAL_BAROMETER] = {650, 520},
+        [PROFILE_PERIPHERAL_CO2] = {5000, 8000},
+        [PROFILE_PERIPHERAL_LIS2DH12] = {200, 10},
+        [PROFILE_PERIPHERAL_BATTERY] = {1000, 20},
+        [PROFILE_PERIPHERAL_RADIO] = {20000, 0},
+};
+
+static const char *_profile_source_name[PROFILE_SOURCE_COUNT] = {
+        [PROFILE_SOURCE_APPLICATION_TASK] = "application_task",
+        [PROFILE_SOURCE_BATTERY_MEASURE_TASK] = "battery_measure_task",
+        [PROFILE_SOURCE_CALIBRATION_TASK] = "calibration_task",
+        [PROFILE_SOURCE_BUTTON] = "button",
+        [PROFILE_SOURCE_PIR] = "pir",
+        [PROFILE_SOURCE_CO2] = "co2",
+        [PROFILE_SOURCE_CLIMATE] = "climate",
+        [PROFILE_SOURCE_BATTERY] = "battery",
+        [PROFILE_SOURCE_LIS2DH12] = "lis2dh12",
+        [PROFILE_SOURCE_LORA] = "lora",
+        [PROFILE_SOURCE_MEASURE] = "measure",
+};
+
+typedef struct
+{
+    uint32_t wakes;
+    uint64_t active_us;
+    // Charge in nanocoulombs, uA * ms
+    uint64_t charge;
+
+} profile_counter_t;
+
+static struct
+{
+    profile_counter_t total[PROFILE_SOURCE_COUNT];
+    profile_counter_t day[PROFILE_SOURCE_COUNT];
+    int depth;
+
+    // Sources begun and not ended yet, only the innermost one is charged for the time running
+    profile_source_t stack[PROFILE_DEPTH_MAX];
+    twr_tick_t timer_tick;
+    uint32_t mark_us;
+
+    twr_tick_t day_start;
+    twr_scheduler_task_id_t task_id;
+
+    // Tick the last activity ended, stop mode exits in total, in the hour running and the one before
+    twr_tick_t idle_tick;
+    uint32_t exits;
+    uint32_t exits_hour;
+    uint32_t exits_last_hour;
+    twr_tick_t hour_start;
+
+} _profile;
+
+static void _profile_task(void *param);
+static uint32_t _profile_get_us(void);
+static void _profile_account(profile_source_t source, uint32_t active_us);
+static void _profile_exit(void);
+static void _profile_exit_hour(void);
+static void _profile_print_counters(const char *prefix, profile_counter_t *counter, twr_tick_t duration);
+
+void profile_init(void)
+{
+    memset(&_profile, 0, sizeof(_profile));
+
+    twr_timer_init();
+
+    _profile.day_start = twr_tick_get();
+    _profile.hour_start = _profile.day_start;
+    _profile.idle_tick = TWR_TICK_INFINITY;
+    _profile.task_id = twr_scheduler_register(_profile_task, NULL, _profile.day_start + PROFILE_DAY);
+}
+
+void profile_begin(profile_source_t source)
+{
+    if (_profile.depth == 0)
+    {
+        twr_timer_start();
+
+        _profile.timer_tick = twr_tick_get();
+        _profile.mark_us = 0;
+
+        _profile_exit();
+    }
+    else if (_profile.depth <= PROFILE_DEPTH_MAX)
+    {
+        // The outer source pauses while the nested one runs
+        uint32_t now_us = _profile_get_us();
+
+        _profile_account(_profile.stack[_profile.depth - 1], now_us - _profile.mark_us);
+
+        _profile.mark_us = now_us;
+    }
+
+    if (_profile.depth < PROFILE_DEPTH_MAX)
+    {
+        _profile.stack[_profile.depth] = source;
+    }
+
+    _profile.depth++;
+
+    _profile.total[source].wakes++;
+    _profile.day[source].wakes++;
+}
+
+void profile_end(profile_source_t source)
+{
+    uint32_t now_us = _profile_get_us();
+
+    if (_profile.depth <= PROFILE_DEPTH_MAX)
+    {
+        _profile_account(source, now_us - _profile.mark_us);
+
+        _profile.mark_us = now_us;
+    }
+
+    if (--_profile.depth == 0)
+    {
+        twr_timer_stop();
+
+        _profile.idle_tick = twr_tick_get();
+    }
+}
+
+void profile_charge(profile_source_t source, profile_peripheral_t peripheral)
+{
+    profile_charge_ticks(source, peripheral, _profile_peripheral[peripheral].active);
+}
+
+void profile_charge_ticks(profile_source_t source, profile_peripheral_t peripheral, twr_tick_t active)
+{
+    uint64_t charge = (uint64_t) _profile_peripheral[peripheral].current * active;
+
+    _profile.total[source].charge += charge;
+    _profile.day[source].charge += charge;
+}
+
+// The timer counts microseconds in 16 bits, the tick supplies the milliseconds it wrapped over
+static uint32_t _profile_get_us(void)
+{
+    uint32_t coarse_us = (uint32_t) (twr_tick_get() - _profile.timer_tick) * 1000;
+
+    uint16_t fine_us = twr_timer_get_microseconds();
+
+    return coarse_us + (int16_t) (fine_us - (uint16_t) coarse_us);
+}
+
+static void _profile_account(profile_source_t source, uint32_t active_us)
+{
+    uint64_t charge = (uint64_t) PROFILE_CURRENT_MCU_RUN * active_us / 1000;
+
+    _profile.total[source].active_us += active_us;
+    _profile.total[source].charge += charge;
+    _profile.day[source].active_us += active_us;
+    _profile.day[source].charge += charge;
+}
+
+static uint64_t _profile_sum_charge(profile_counter_t *counter, twr_tick_t duration)
+{
+    uint64_t charge = (uint64_t) PROFILE_CURRENT_SLEEP * duration;
+
+    for (int i = 0; i < PROFILE_SOURCE_COUNT; i++)
+    {
+        charge += counter[i].charge;
+    }
+
+    return charge;
+}
+
+uint32_t profile_get_average_current(void)
+{
+    twr_tick_t uptime = twr_tick_get();
+
+    if (uptime == 0)
+    {
+        return 0;
+    }
+
+    return _profile_sum_charge(_profile.total, uptime) / uptime;
+}
+
+uint64_t profile_get_charge(void)
+{
+    return _profile_sum_charge(_profile.total, twr_tick_get()) / 1000;
+}
+
+uint32_t profile_get_exits(void)
+{
+    return _profile.exits;
+}
+
+uint32_t profile_get_exits_last_hour(void)
+{
+    _profile_exit_hour();
+
+    return _profile.exits_last_hour;
+}
+
+void profile_print(void)
+{
+    _profile_print_counters("$PROFILE", _profile.total, twr_tick_get());
+
+    twr_atci_printf("$PROFILE: \"Stop mode exits\",%lu,%lu", (unsigned long) profile_get_exits(),
+                    (unsigned long) profile_get_exits_last_hour());
+}
+
+static void _profile_print_counters(const char *prefix, profile_counter_t *counter, twr_tick_t duration)
+{
+    twr_atci_printf("%s: \"Duration\",%llu", prefix, (unsigned long long) (duration / 1000));
+
+    for (int i = 0; i < PROFILE_SOURCE_COUNT; i++)
+    {
+        twr_atci_printf("%s: \"%s\",%lu,%llu,%llu", prefix, _profile_source_name[i],
+                (unsigned long) counter[i].wakes,
+                (unsigned long long) counter[i].active_us,
+                (unsigned long long) (counter[i].charge / 1000));
+    }
+
+    twr_atci_printf("%s: \"sleep\",,,%llu", prefix, (unsigned long long) ((uint64_t) PROFILE_CURRENT_SLEEP * duration / 1000));
+
+    uint32_t average = duration != 0 ? _profile_sum_charge(counter, duration) / duration : 0;
+
+    twr_atci_printf("%s: \"Average current\",%lu", prefix, (unsigned long) average);
+}
+
+static void _profile_exit_hour(void)
+{
+    twr_tick_t now = twr_tick_get();
+
+    while (now - _profile.hour_start >= PROFILE_HOUR)
+    {
+        _profile.exits_last_hour = _profile.exits_hour;
+        _profile.exits_hour = 0;
+        _profile.hour_start += PROFILE_HOUR;
+    }
+}
+
+static void _profile_exit(void)
+{
+    twr_tick_t now = twr_tick_get();
+
+    // Handlers of one wake-up run at the same tick, the scheduler sleeps between ticks
+    if (now == _profile.idle_tick)
+    {
+        return;
+    }
+
+    _profile_exit_hour();
+
+    _profile.exits++;
+    _profile.exits_hour++;
+}
+
+static void _profile_task(void *param)
+{
+    (void) param;
+
+    _profile_print_counters("$PROFILE_DAY", _profile.day, twr_tick_get() - _profile.day_start);
+
+    memset(_profile.day, 0, sizeof(_profile.day));
+
+    _profile.day_start = twr_tick_get();
+
+    twr_scheduler_plan_current_relative(PROFILE_DAY);
+}
@@ -0,0 +1,141 @@
+#include <report.h>
+#include <twr.h>
+
+static struct
+{
+    bool enabled;
+    twr_tick_t heartbeat;
+    uint32_t deadband[REPORT_FIELD_COUNT];
+
+    bool sent;
+    twr_tick_t sent_tick;
+    payload_t last;
+
+} _report;
+
+static int _report_field_index(payload_field_t field);
+static uint32_t _report_field_delta(const payload_t *payload, int index);
+
+void report_init(void)
+{
+    memset(&_report, 0, sizeof(_report));
+}
+
+void report_set_enabled(bool enabled)
+{
+    _report.enabled = enabled;
+}
+
+bool report_is_enabled(void)
+{
+    return _report.enabled;
+}
+
+void report_set_heartbeat(twr_tick_t heartbeat)
+{
+    _report.heartbeat = heartbeat;
+}
+
+twr_tick_t report_get_heartbeat(void)
+{
+    return _report.heartbeat;
+}
+
+void report_set_deadband(payload_field_t field, uint32_t deadband)
+{
+    int index = _report_field_index(field);
+
+    if (index >= 0)
+    {
+        _report.deadband[index] = deadband;
+    }
+}
+
+uint32_t report_get_deadband(payload_field_t field)
+{
+    int index = _report_field_index(field);
+
+    return index < 0 ? 0 : _report.deadband[index];
+}
+
+bool report_is_needed(const payload_t *payload)
+{
+    if (!_report.enabled || !_report.sent)
+    {
+        return true;
+    }
+
+    if (twr_tick_get() - _report.sent_tick >= _report.heartbeat)
+    {
+        return true;
+    }
+
+    // A field which appeared or disappeared is a change as well
+    if (payload->fields != _report.last.fields)
+    {
+        return true;
+    }
+
+    for (int i = 0; i < REPORT_FIELD_COUNT; i++)
+    {
+        if ((payload->fields & (1 << i)) == 0)
+        {
+            continue;
+        }
+
+        if (_report_field_delta(payload, i) > _report.deadband[i])
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void report_sent(const payload_t *payload)
+{
+    _report.last = *payload;
+    _report.sent_tick = twr_tick_get();
+    _report.sent = true;
+}
+
+static int _report_field_index(payload_field_t field)
+{
+    for (int i = 0; i < REPORT_FIELD_COUNT; i++)
+    {
+        if (field == (payload_field_t) (1 << i))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static uint32_t _report_field_delta(const payload_t *payload, int index)
+{
+    const payload_t *last = &_report.last;
+
+    switch (1 << index)
+    {
+        case PAYLOAD_FIELD_VOLTAGE:
+            return abs(payload->voltage - last->voltage);
+        case PAYLOAD_FIELD_ORIENTATION:
+            return abs(payload->orientation - last->orientation);
+        case PAYLOAD_FIELD_TEMPERATURE:
+            return abs(payload->temperature - last->temperature);
+        case PAYLOAD_FIELD_HUMIDITY:
+            return abs(payload->humidity - last->humidity);
+        case PAYLOAD_FIELD_ILLUMINANCE:
+            return abs(payload->illuminance - last->illuminance);
+        case PAYLOAD_FIELD_PRESSURE:
+            return abs(payload->pressure - last->pressure);
+        case PAYLOAD_FIELD_PIR_MOTION_COUNT:
+            // The counter only grows, wrap included
+            return payload->pir_motion_count - last->pir_motion_count;
+        case PAYLOAD_FIELD_CO2:
+            return abs(payload->co2 - last->co2);
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,199 @@
+#include <ringlog.h>
+#include <twr.h>
+
+// Every cell is written once per lap of the ring, there is no write cursor stored in a fixed cell:
+// the position is found at boot as the end of the run of consecutive sequence numbers
+
+#define RINGLOG_MARK_NONE 0xffff
+
+static struct
+{
+    uint32_t address;
+    int capacity;
+
+    int head;
+    int count;
+    uint16_t sequence;
+
+} _ringlog;
+
+static bool _ringlog_load(int index, ringlog_record_t *record);
+static uint8_t _ringlog_check(const uint8_t *raw);
+
+void ringlog_init(uint32_t address, size_t size)
+{
+    memset(&_ringlog, 0, sizeof(_ringlog));
+
+    _ringlog.address = address;
+    _ringlog.capacity = size < RINGLOG_CONTROL_SIZE ? 0 : (size - RINGLOG_CONTROL_SIZE) / RINGLOG_RECORD_SIZE;
+
+    ringlog_record_t record;
+    ringlog_record_t next;
+
+    // Newest record is the one not followed by its successor
+    for (int i = 0; i < _ringlog.capacity; i++)
+    {
+        if (!_ringlog_load(i, &record))
+        {
+            continue;
+        }
+
+        _ringlog.count++;
+
+        int j = (i + 1) % _ringlog.capacity;
+
+        if (!_ringlog_load(j, &next) || next.sequence != (uint16_t) (record.sequence + 1))
+        {
+            _ringlog.head = j;
+            _ringlog.sequence = record.sequence + 1;
+        }
+    }
+}
+
+int ringlog_get_capacity(void)
+{
+    return _ringlog.capacity;
+}
+
+uint16_t ringlog_get_sequence(void)
+{
+    return _ringlog.sequence;
+}
+
+bool ringlog_append(ringlog_record_t *record)
+{
+    if (_ringlog.capacity == 0)
+    {
+        return false;
+    }
+
+    record->sequence = _ringlog.sequence;
+
+    uint8_t raw[RINGLOG_RECORD_SIZE];
+
+    raw[0] = record->sequence >> 8;
+    raw[1] = record->sequence;
+    raw[2] = record->fields;
+    raw[3] = record->temperature >> 8;
+    raw[4] = record->temperature;
+    raw[5] = record->humidity;
+    raw[6] = record->co2 >> 8;
+    raw[7] = record->co2;
+    raw[8] = record->pir_motion_count;
+    raw[9] = record->interval >> 8;
+    raw[10] = record->interval;
+    raw[11] = _ringlog_check(raw);
+
+    uint32_t address = _ringlog.address + RINGLOG_CONTROL_SIZE + _ringlog.head * RINGLOG_RECORD_SIZE;
+
+    if (!twr_eeprom_write(address, raw, sizeof(raw)))
+    {
+        return false;
+    }
+
+    _ringlog.head = (_ringlog.head + 1) % _ringlog.capacity;
+    _ringlog.sequence++;
+
+    if (_ringlog.count < _ringlog.capacity)
+    {
+        _ringlog.count++;
+    }
+
+    return true;
+}
+
+bool ringlog_read(uint16_t sequence, ringlog_record_t *record)
+{
+    uint16_t age = _ringlog.sequence - sequence;
+
+    if (age == 0 || age > _ringlog.count)
+    {
+        return false;
+    }
+
+    int index = (_ringlog.head + _ringlog.capacity - age) % _ringlog.capacity;
+
+    return _ringlog_load(index, record) && record->sequence == sequence;
+}
+
+uint16_t ringlog_get_oldest(void)
+{
+    return _ringlog.sequence - _ringlog.count;
+}
+
+void ringlog_set_mark(uint16_t sequence)
+{
+    uint8_t raw[RINGLOG_CONTROL_SIZE] = { sequence >> 8, sequence, ~sequence >> 8, ~sequence };
+
+    uint8_t old[RINGLOG_CONTROL_SIZE];
+
+    // Skip the write if nothing changes
+    if (twr_eeprom_read(_ringlog.address, old, sizeof(old)) && memcmp(old, raw, sizeof(raw)) == 0)
+    {
+        return;
+    }
+
+    twr_eeprom_write(_ringlog.address, raw, sizeof(raw));
+}
+
+bool ringlog_get_mark(uint16_t *sequence)
+{
+    uint8_t raw[RINGLOG_CONTROL_SIZE];
+
+    if (!twr_eeprom_read(_ringlog.address, raw, sizeof(raw)))
+    {
+        return false;
+    }
+
+    uint16_t mark = raw[0] << 8 | raw[1];
+    uint16_t inverse = raw[2] << 8 | raw[3];
+
+    if (mark == RINGLOG_MARK_NONE || (uint16_t) (mark ^ inverse) != 0xffff)
+    {
+        return false;
+    }
+
+    *sequence = mark;
+
+    return true;
+}
+
+void ringlog_clear_mark(void)
+{
+    ringlog_set_mark(RINGLOG_MARK_NONE);
+}
+
+static bool _ringlog_load(int index, ringlog_record_t *record)
+{
+    uint8_t raw[RINGLOG_RECORD_SIZE];
+
+    uint32_t address = _ringlog.address + RINGLOG_CONTROL_SIZE + index * RINGLOG_RECORD_SIZE;
+
+    if (!twr_eeprom_read(address, raw, sizeof(raw)) || raw[RINGLOG_RECORD_SIZE - 1] != _ringlog_check(raw))
+    {
+        return false;
+    }
+
+    record->sequence = raw[0] << 8 | raw[1];
+    record->fields = raw[2];
+    record->temperature = raw[3] << 8 | raw[4];
+    record->humidity = raw[5];
+    record->co2 = raw[6] << 8 | raw[7];
+    record->pir_motion_count = raw[8];
+    record->interval = raw[9] << 8 | raw[10];
+
+    return true;
+}
+
+// Erased EEPROM (all zeros or all ones) never passes the check
+static uint8_t _ringlog_check(const uint8_t *raw)
+{
+    uint8_t check = 0xa5;
+
+    for (int i = 0; i < RINGLOG_RECORD_SIZE - 1; i++)
+    {
+        check = (check << 1 | check >> 7) ^ raw[i];
+    }
+
+    return check;
+}
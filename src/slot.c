@@ -0,0 +1,102 @@
+#include <slot.h>
+#include <twr.h>
+
+static struct
+{
+    twr_cmwx1zzabz_t *lora;
+    twr_tick_t jitter;
+    uint32_t random;
+
+} _slot;
+
+static uint32_t _slot_hash(void);
+
+void slot_init(twr_cmwx1zzabz_t *lora)
+{
+    memset(&_slot, 0, sizeof(_slot));
+
+    _slot.lora = lora;
+}
+
+void slot_set_jitter(twr_tick_t jitter)
+{
+    _slot.jitter = jitter;
+}
+
+twr_tick_t slot_get_jitter(void)
+{
+    return _slot.jitter;
+}
+
+twr_tick_t slot_get_offset(twr_tick_t interval)
+{
+    return interval != 0 ? _slot_hash() % interval : 0;
+}
+
+twr_tick_t slot_get_random(void)
+{
+    return slot_get_random_range(_slot.jitter);
+}
+
+twr_tick_t slot_get_random_range(twr_tick_t range)
+{
+    if (range == 0)
+    {
+        return 0;
+    }
+
+    // Seeded by the DevEUI, every device has its own sequence
+    if (_slot.random == 0)
+    {
+        _slot.random = _slot_hash() | 1;
+    }
+
+    // xorshift32
+    _slot.random ^= _slot.random << 13;
+    _slot.random ^= _slot.random >> 17;
+    _slot.random ^= _slot.random << 5;
+
+    return _slot.random % (range + 1);
+}
+
+twr_tick_t slot_get_delay(twr_tick_t interval)
+{
+    if (interval == 0)
+    {
+        return 0;
+    }
+
+    twr_tick_t now = twr_tick_get();
+    twr_tick_t offset = slot_get_offset(interval);
+
+    // First slot starting after now, the jitter of the current one does not shift the next
+    twr_tick_t next = now < offset ? offset : (now - offset) / interval * interval + offset + interval;
+
+    // Jitter stays within a quarter of the interval, the order of the slots is kept
+    twr_tick_t jitter = slot_get_random();
+
+    if (jitter > interval / 4)
+    {
+        jitter %= interval / 4 + 1;
+    }
+
+    return next - now + jitter;
+}
+
+// FNV-1a of the DevEUI
+static uint32_t _slot_hash(void)
+{
+    char deveui[16 + 1];
+
+    twr_cmwx1zzabz_get_deveui(_slot.lora, deveui);
+
+    uint32_t hash = 2166136261UL;
+
+    for (size_t i = 0; i < sizeof(deveui) && deveui[i] != '\0'; i++)
+    {
+        hash ^= (uint8_t) deveui[i];
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
@@ -0,0 +1,218 @@
+#include <threshold.h>
+#include <twr.h>
+
+#define THRESHOLD_CO2_HYSTERESIS 50
+
+// Never closer than the minimum gap to the last uplink, the duty cycle is left to the airtime accountant
+#define THRESHOLD_MIN_GAP (60 * 1000)
+
+// Token bucket of threshold uplinks
+#define THRESHOLD_BUCKET_SIZE 4
+#define THRESHOLD_BUCKET_REFILL (15 * 60 * 1000)
+
+static struct
+{
+    void (*callback)(void);
+
+    uint16_t co2_level[THRESHOLD_CO2_LEVELS];
+    int co2_band;
+
+    uint16_t temperature_delta;
+    // Tenths of degree
+    int16_t temperature_sent;
+    bool temperature_valid;
+
+    twr_tick_t motion_quiet;
+    twr_tick_t motion_last;
+
+    twr_tick_t next_allowed;
+    int tokens;
+    twr_tick_t refill_tick;
+    bool pending;
+    twr_scheduler_task_id_t task_id;
+
+} _threshold;
+
+static void _threshold_task(void *param);
+static void _threshold_request(void);
+
+void threshold_init(void (*callback)(void))
+{
+    memset(&_threshold, 0, sizeof(_threshold));
+
+    _threshold.callback = callback;
+    _threshold.tokens = THRESHOLD_BUCKET_SIZE;
+    _threshold.refill_tick = twr_tick_get();
+    _threshold.motion_last = twr_tick_get();
+
+    _threshold.task_id = twr_scheduler_register(_threshold_task, NULL, TWR_TICK_INFINITY);
+}
+
+void threshold_set_co2_levels(uint16_t level_1, uint16_t level_2)
+{
+    if (level_1 != 0 && level_2 != 0 && level_2 < level_1)
+    {
+        uint16_t tmp = level_1;
+        level_1 = level_2;
+        level_2 = tmp;
+    }
+
+    _threshold.co2_level[0] = level_1;
+    _threshold.co2_level[1] = level_2;
+    _threshold.co2_band = 0;
+}
+
+void threshold_get_co2_levels(uint16_t *level_1, uint16_t *level_2)
+{
+    *level_1 = _threshold.co2_level[0];
+    *level_2 = _threshold.co2_level[1];
+}
+
+void threshold_set_temperature_delta(uint16_t delta)
+{
+    _threshold.temperature_delta = delta;
+}
+
+uint16_t threshold_get_temperature_delta(void)
+{
+    return _threshold.temperature_delta;
+}
+
+void threshold_set_motion_quiet(twr_tick_t quiet)
+{
+    _threshold.motion_quiet = quiet;
+}
+
+twr_tick_t threshold_get_motion_quiet(void)
+{
+    return _threshold.motion_quiet;
+}
+
+void threshold_feed_co2(int32_t ppm)
+{
+    // Band is the number of enabled levels below the concentration, a level is left
+    // downwards only when the concentration drops below it by the hysteresis, levels are ascending
+    int band = 0;
+
+    for (int i = 0; i < THRESHOLD_CO2_LEVELS; i++)
+    {
+        uint16_t level = _threshold.co2_level[i];
+
+        if (level == 0)
+        {
+            continue;
+        }
+
+        if (ppm >= level || (band < _threshold.co2_band && ppm >= level - THRESHOLD_CO2_HYSTERESIS))
+        {
+            band++;
+        }
+    }
+
+    if (band != _threshold.co2_band)
+    {
+        _threshold.co2_band = band;
+
+        _threshold_request();
+    }
+}
+
+void threshold_feed_temperature(int32_t temperature)
+{
+    if (_threshold.temperature_delta == 0 || !_threshold.temperature_valid)
+    {
+        return;
+    }
+
+    temperature /= 10;
+
+    if (abs(temperature - _threshold.temperature_sent) >= _threshold.temperature_delta)
+    {
+        // Do not request again until the new value is sent
+        _threshold.temperature_sent = temperature;
+
+        _threshold_request();
+    }
+}
+
+void threshold_feed_motion(void)
+{
+    twr_tick_t now = twr_tick_get();
+
+    bool quiet = now - _threshold.motion_last >= _threshold.motion_quiet;
+
+    _threshold.motion_last = now;
+
+    if (_threshold.motion_quiet != 0 && quiet)
+    {
+        _threshold_request();
+    }
+}
+
+void threshold_sent(const payload_t *payload)
+{
+    if (payload->fields & PAYLOAD_FIELD_TEMPERATURE)
+    {
+        _threshold.temperature_sent = payload->temperature;
+        _threshold.temperature_valid = true;
+    }
+
+    _threshold.next_allowed = twr_tick_get() + THRESHOLD_MIN_GAP;
+
+    // Any uplink carries the fresh values, nothing is pending any more
+    _threshold.pending = false;
+
+    twr_scheduler_plan_absolute(_threshold.task_id, TWR_TICK_INFINITY);
+}
+
+static void _threshold_refill(twr_tick_t now)
+{
+    while (_threshold.tokens < THRESHOLD_BUCKET_SIZE && now - _threshold.refill_tick >= THRESHOLD_BUCKET_REFILL)
+    {
+        _threshold.tokens++;
+        _threshold.refill_tick += THRESHOLD_BUCKET_REFILL;
+    }
+
+    if (_threshold.tokens == THRESHOLD_BUCKET_SIZE)
+    {
+        _threshold.refill_tick = now;
+    }
+}
+
+static void _threshold_request(void)
+{
+    twr_tick_t now = twr_tick_get();
+
+    _threshold_refill(now);
+
+    _threshold.pending = true;
+
+    if (_threshold.tokens > 0 && now >= _threshold.next_allowed)
+    {
+        _threshold.tokens--;
+        _threshold.pending = false;
+
+        _threshold.callback();
+
+        return;
+    }
+
+    twr_tick_t retry = _threshold.next_allowed;
+
+    if (_threshold.tokens == 0 && _threshold.refill_tick + THRESHOLD_BUCKET_REFILL > retry)
+    {
+        retry = _threshold.refill_tick + THRESHOLD_BUCKET_REFILL;
+    }
+
+    twr_scheduler_plan_absolute(_threshold.task_id, retry);
+}
+
+static void _threshold_task(void *param)
+{
+    (void) param;
+
+    if (_threshold.pending)
+    {
+        _threshold_request();
+    }
+}
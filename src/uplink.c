@@ -0,0 +1,104 @@
+#include <uplink.h>
+#include <twr.h>
+
+// Events of the radio should wake the waiting tasks, this only covers one that never comes
+#define UPLINK_WATCHDOG (5 * 1000)
+
+static struct
+{
+    twr_cmwx1zzabz_t *lora;
+
+    twr_scheduler_task_id_t task_id[UPLINK_CLASS_COUNT];
+    bool pending[UPLINK_CLASS_COUNT];
+
+    twr_scheduler_task_id_t watchdog_task_id;
+
+} _uplink;
+
+static void _uplink_watchdog_task(void *param);
+
+void uplink_init(twr_cmwx1zzabz_t *lora)
+{
+    memset(&_uplink, 0, sizeof(_uplink));
+
+    _uplink.lora = lora;
+
+    _uplink.watchdog_task_id = twr_scheduler_register(_uplink_watchdog_task, NULL, TWR_TICK_INFINITY);
+}
+
+void uplink_register(uplink_class_t uplink_class, twr_scheduler_task_id_t task_id)
+{
+    _uplink.task_id[uplink_class] = task_id;
+}
+
+bool uplink_acquire(uplink_class_t uplink_class)
+{
+    bool higher_pending = false;
+
+    for (int i = 0; i < (int) uplink_class; i++)
+    {
+        higher_pending |= _uplink.pending[i];
+    }
+
+    if (twr_cmwx1zzabz_is_ready(_uplink.lora) && !higher_pending)
+    {
+        // The task serves every class it is registered for
+        for (int i = 0; i < UPLINK_CLASS_COUNT; i++)
+        {
+            if (_uplink.task_id[i] == _uplink.task_id[uplink_class])
+            {
+                _uplink.pending[i] = false;
+            }
+        }
+
+        return true;
+    }
+
+    _uplink.pending[uplink_class] = true;
+
+    twr_scheduler_plan_relative(_uplink.watchdog_task_id, UPLINK_WATCHDOG);
+
+    return false;
+}
+
+void uplink_release(void)
+{
+    uplink_kick();
+}
+
+void uplink_kick(void)
+{
+    if (!twr_cmwx1zzabz_is_ready(_uplink.lora))
+    {
+        return;
+    }
+
+    for (int i = 0; i < UPLINK_CLASS_COUNT; i++)
+    {
+        if (_uplink.pending[i])
+        {
+            twr_scheduler_plan_now(_uplink.task_id[i]);
+
+            return;
+        }
+    }
+
+    twr_scheduler_plan_absolute(_uplink.watchdog_task_id, TWR_TICK_INFINITY);
+}
+
+static void _uplink_watchdog_task(void *param)
+{
+    (void) param;
+
+    uplink_kick();
+
+    for (int i = 0; i < UPLINK_CLASS_COUNT; i++)
+    {
+        if (_uplink.pending[i])
+        {
+            twr_scheduler_plan_current_relative(UPLINK_WATCHDOG);
+
+            return;
+        }
+    }
+}
@@ -0,0 +1,231 @@
+#include <wake.h>
+#include <twr.h>
+
+typedef struct
+{
+    void (*job)(void *);
+    void *param;
+    twr_tick_t interval;
+    // Grid tick of the last run, TWR_TICK_INFINITY before the first one
+    twr_tick_t last;
+    // Earliest tick of a single run on top of the interval
+    twr_tick_t once;
+
+} wake_job_t;
+
+static struct
+{
+    twr_tick_t grid;
+    twr_tick_t tolerance;
+    twr_tick_t origin;
+
+    wake_job_t jobs[WAKE_JOBS];
+    int count;
+
+    twr_scheduler_task_id_t task_id;
+    twr_scheduler_task_id_t release_task_id;
+    // System clock held up for the jobs of the tick, released on the second run of the release task
+    bool held;
+    bool releasing;
+
+} _wake;
+
+static void _wake_task(void *param);
+static void _wake_release_task(void *param);
+static void _wake_plan(void);
+static twr_tick_t _wake_round_up(twr_tick_t tick);
+static twr_tick_t _wake_get_tick(wake_job_t *job, twr_tick_t now);
+
+void wake_init(twr_tick_t grid, twr_tick_t tolerance)
+{
+    memset(&_wake, 0, sizeof(_wake));
+
+    _wake.task_id = twr_scheduler_register(_wake_task, NULL, TWR_TICK_INFINITY);
+    _wake.release_task_id = twr_scheduler_register(_wake_release_task, NULL, TWR_TICK_INFINITY);
+
+    wake_set_grid(grid, tolerance);
+}
+
+void wake_set_grid(twr_tick_t grid, twr_tick_t tolerance)
+{
+    _wake.grid = grid != 0 ? grid : 1;
+    _wake.tolerance = tolerance < _wake.grid ? tolerance : _wake.grid - 1;
+    _wake.origin = twr_tick_get();
+
+    _wake_plan();
+}
+
+twr_tick_t wake_get_grid(void)
+{
+    return _wake.grid;
+}
+
+twr_tick_t wake_get_tolerance(void)
+{
+    return _wake.tolerance;
+}
+
+int wake_register(void (*job)(void *), void *param, twr_tick_t interval)
+{
+    if (_wake.count == WAKE_JOBS)
+    {
+        return -1;
+    }
+
+    _wake.jobs[_wake.count].job = job;
+    _wake.jobs[_wake.count].param = param;
+    _wake.jobs[_wake.count].interval = interval;
+    _wake.jobs[_wake.count].last = TWR_TICK_INFINITY;
+    _wake.jobs[_wake.count].once = TWR_TICK_INFINITY;
+
+    _wake_plan();
+
+    return _wake.count++;
+}
+
+void wake_set_interval(int id, twr_tick_t interval)
+{
+    if (id < 0 || id >= _wake.count)
+    {
+        return;
+    }
+
+    _wake.jobs[id].interval = interval;
+
+    _wake_plan();
+}
+
+void wake_schedule(int id, twr_tick_t delay)
+{
+    if (id < 0 || id >= _wake.count)
+    {
+        return;
+    }
+
+    twr_tick_t once = twr_tick_get() + delay;
+
+    if (once < _wake.jobs[id].once)
+    {
+        _wake.jobs[id].once = once;
+    }
+
+    _wake_plan();
+}
+
+static void _wake_task(void *param)
+{
+    (void) param;
+
+    twr_tick_t now = twr_tick_get();
+
+    // Late run keeps the grid, the jobs count from the tick it was planned for
+    twr_tick_t tick = _wake.origin + (now - _wake.origin) / _wake.grid * _wake.grid;
+
+    // One bus session for all the jobs of the tick and the conversions they start
+    if (!_wake.held)
+    {
+        _wake.held = true;
+
+        twr_system_pll_enable();
+    }
+
+    for (int i = 0; i < _wake.count; i++)
+    {
+        if (_wake_get_tick(&_wake.jobs[i], tick) <= tick)
+        {
+            _wake.jobs[i].last = tick;
+            _wake.jobs[i].once = TWR_TICK_INFINITY;
+
+            _wake.jobs[i].job(_wake.jobs[i].param);
+        }
+    }
+
+    // Drivers start their conversions from tasks planned now, the clock is held until they ran
+    _wake.releasing = false;
+
+    twr_scheduler_plan_now(_wake.release_task_id);
+
+    _wake_plan();
+}
+
+static void _wake_release_task(void *param)
+{
+    (void) param;
+
+    // First run may come before the driver tasks of lower ids, the second one is after all of them
+    if (!_wake.releasing)
+    {
+        _wake.releasing = true;
+
+        twr_scheduler_plan_current_now();
+
+        return;
+    }
+
+    _wake.releasing = false;
+    _wake.held = false;
+
+    twr_system_pll_disable();
+}
+
+static void _wake_plan(void)
+{
+    twr_tick_t now = twr_tick_get();
+    twr_tick_t next = TWR_TICK_INFINITY;
+
+    for (int i = 0; i < _wake.count; i++)
+    {
+        twr_tick_t tick = _wake_get_tick(&_wake.jobs[i], now);
+
+        // Overdue job waits for the next grid tick instead of waking the MCU off the grid
+        if (tick < now)
+        {
+            tick = _wake_round_up(now);
+        }
+
+        if (tick < next)
+        {
+            next = tick;
+        }
+    }
+
+    twr_scheduler_plan_absolute(_wake.task_id, next);
+}
+
+static twr_tick_t _wake_round_up(twr_tick_t tick)
+{
+    tick = tick > _wake.origin ? tick : _wake.origin;
+
+    return _wake.origin + (tick - _wake.origin + _wake.grid - 1) / _wake.grid * _wake.grid;
+}
+
+// First grid tick from now on that is no more than the tolerance before the job is due
+static twr_tick_t _wake_get_tick(wake_job_t *job, twr_tick_t now)
+{
+    twr_tick_t tick = TWR_TICK_INFINITY;
+
+    if (job->interval != TWR_TICK_INFINITY)
+    {
+        twr_tick_t due = job->last != TWR_TICK_INFINITY ? job->last + job->interval : now;
+
+        if (due < now)
+        {
+            due = now;
+        }
+
+        tick = _wake_round_up(due > _wake.tolerance ? due - _wake.tolerance : 0);
+    }
+
+    // Single run waits for the delay in full
+    if (job->once != TWR_TICK_INFINITY)
+    {
+        twr_tick_t once = _wake_round_up(job->once > now ? job->once : now);
+
+        if (once < tick)
+        {
+            tick = once;
+        }
+    }
+
+    return tick;
+}
@@ -4,28 +4,213 @@ Decoder for The Things Network
 
 */
 
+var HEADER_BATCH = 0x04;
+var HEADER_BACKFILL = 0x06;
+var HEADER_COMPACT = 0x80;
+var HEADER_KEYFRAME = 0x40;
+var HEADER_ACK = 0x08;
+// Power tier of the device in the standard and batch frames, compact keyframes close with it unless it is normal
+var HEADER_TIER = 0x30;
+var TIERS = ["NORMAL", "ECO", "SURVIVAL"];
+var ORIENTATION_TAMPER = 0x80;
+
+// name, conversion to the physical value, signed in keyframe
+var COMPACT_FIELDS = [
+    ["voltage", function (v) { return v / 10.0; }, false],
+    ["orientation", function (v) { return v; }, false],
+    ["temperature", function (v) { return v / 10.0; }, true],
+    ["humidity", function (v) { return v / 2; }, false],
+    ["illuminance", function (v) { return v; }, false],
+    ["pressure", function (v) { return v * 2.0; }, false],
+    ["pir_motion_count", function (v) { return v; }, false],
+    ["co2", function (v) { return v; }, false]
+];
+
+function DecodeCompact(bytes) {
+    // Keyframe carries absolute values, other frames carry changes against the keyframe
+    // with the same sequence, which has to be added by the application
+    var keyframe = (bytes[0] & HEADER_KEYFRAME) !== 0;
+    var fields = bytes[1];
+    var offset = 2;
+
+    var decoded = {
+      header: bytes[0] & 0x07,
+      keyframe: keyframe,
+      sequence: (bytes[0] >> 4) & 0x03
+    };
+
+    var values = keyframe ? decoded : (decoded.delta = {});
+
+    for (var i = 0; i < COMPACT_FIELDS.length; i++) {
+      if (!(fields & (1 << i))) {
+        continue;
+      }
+
+      var value = 0;
+      var shift = 0;
+      var byte;
+
+      do {
+        byte = bytes[offset++];
+        value += (byte & 0x7f) * Math.pow(2, shift);
+        shift += 7;
+      } while (byte & 0x80);
+
+      var name = COMPACT_FIELDS[i][0];
+
+      if (name !== "pir_motion_count" && (!keyframe || COMPACT_FIELDS[i][2])) {
+        value = (value % 2) ? -(value + 1) / 2 : value / 2;
+      }
+
+      values[name] = COMPACT_FIELDS[i][1](value);
+    }
+
+    // Delta frames share the tier of their keyframe
+    if (keyframe) {
+      decoded.tier = TIERS[offset < bytes.length ? bytes[offset] : 0];
+    }
+
+    // Delta frames carry the change of the whole byte, the flag is split once it is added to the keyframe
+    if (keyframe && decoded.orientation !== undefined) {
+      decoded.tamper = (decoded.orientation & ORIENTATION_TAMPER) !== 0;
+      decoded.orientation &= ~ORIENTATION_TAMPER;
+    }
+
+    return decoded;
+  }
+
+function DecodeSnapshots(bytes, offset, count, ageSize) {
+    var snapshots = [];
+    var size = 6 + (ageSize || 1);
+
+    for (var i = 0; i < count; i++) {
+      // Last byte of the age, the fields after it as in a batch snapshot
+      var p = offset + i * size + size - 7;
+      var age = ageSize === 2 ? (bytes[p - 1] << 8) | bytes[p] : bytes[p];
+      var temperature = (bytes[p + 1] << 8) | bytes[p + 2];
+
+      snapshots.push({
+        age: age,
+        temperature: temperature === 0xffff ? null : ((temperature << 16) >> 16) / 10.0,
+        humidity: bytes[p + 3] === 0xff ? null : bytes[p + 3] / 2,
+        co2: ((bytes[p + 4] << 8) | bytes[p + 5]) === 0xffff ? null : ((bytes[p + 4] << 8) | bytes[p + 5]),
+        pir_motion: bytes[p + 6]
+      });
+    }
+
+    return snapshots;
+  }
+
+function DecodeBatch(bytes) {
+    return {
+      header: bytes[0],
+      tier: TIERS[0],
+      voltage: bytes[1] / 10.0,
+      orientation: bytes[2] & ~ORIENTATION_TAMPER,
+      tamper: (bytes[2] & ORIENTATION_TAMPER) !== 0,
+      illuminance: ((bytes[3] << 8) | bytes[4]),
+      pressure: ((bytes[5] << 8) | bytes[6]) * 2.0,
+      snapshots: DecodeSnapshots(bytes, 8, bytes[7])
+    };
+  }
+
+function DecodeBackfill(bytes) {
+    return {
+      header: bytes[0],
+      sequence: (bytes[1] << 8) | bytes[2],
+      records: DecodeSnapshots(bytes, 4, bytes[3], 2)
+    };
+  }
 
 function Decoder(bytes, port) {
     // Decode an uplink message from a buffer
+    if (bytes[0] & HEADER_ACK) {
+      // Acknowledgement of the last downlink closes the frame
+      var stripped = Array.prototype.slice.call(bytes, 0, bytes.length - 2);
+      stripped[0] &= ~HEADER_ACK;
+
+      var decoded = Decoder(stripped, port);
+      decoded.ack = { sequence: bytes[bytes.length - 2], status: bytes[bytes.length - 1] };
+
+      return decoded;
+    }
+
+    if (bytes[0] & HEADER_COMPACT) {
+      return DecodeCompact(bytes);
+    }
+
+    if (bytes[0] & HEADER_TIER) {
+      var untiered = Array.prototype.slice.call(bytes);
+      untiered[0] &= ~HEADER_TIER;
+
+      var result = Decoder(untiered, port);
+      result.tier = TIERS[(bytes[0] & HEADER_TIER) >> 4];
+
+      return result;
+    }
+
+    if (bytes[0] === HEADER_BATCH) {
+      return DecodeBatch(bytes);
+    }
+
+    if (bytes[0] === HEADER_BACKFILL) {
+      return DecodeBackfill(bytes);
+    }
+
     var header = bytes[0];
     var voltage = bytes[1] / 10.0;
     var orientation = bytes[2];
-    var temperature = ((bytes[3] << 8) | bytes[4]) / 10.0;
+    var temperature = (bytes[3] << 8) | bytes[4];
     var humidity = bytes[5] / 2;
     var illuminance = ((bytes[6] << 8) | bytes[7]);
     var pressure = ((bytes[8] << 8) | bytes[9]) * 2.0;
+    var count = ((bytes[10] << 24) | (bytes[11] << 16) | (bytes[12] << 8) | bytes[13]) >>> 0;
+    var occupancy = null;
+
+    // Occupancy closes the frame, firmware before it ends after CO2 or the statistics
+    if (bytes.length === 20 || bytes.length === 31) {
+      var o = bytes.length - 4;
+      var bitmap = (bytes[o + 2] << 8) | bytes[o + 3];
+      var first = null;
+      var last = null;
+
+      // Occupied bins of the send interval, bit 0 first
+      for (var i = 0; i < 16; i++) {
+        if (bitmap & (1 << i)) {
+          first = first === null ? i * bytes[o + 1] : first;
+          last = (i + 1) * bytes[o + 1];
+        }
+      }
+
+      occupancy = bitmap === 0xffff && bytes[o] === 0xff ? null :
+        { minutes: bytes[o], bin: bytes[o + 1], bitmap: bitmap, first: first, last: last };
+    }
 
     // (array) of bytes to an object of fields.
     var decoded = {
       header: header,
+      tier: TIERS[0],
       voltage: voltage,
-      orientation: orientation,
-      temperature: temperature,
+      orientation: orientation & ~ORIENTATION_TAMPER,
+      tamper: (orientation & ORIENTATION_TAMPER) !== 0,
+      temperature: temperature === 0xffff ? null : ((temperature << 16) >> 16) / 10.0,
       humidity: humidity,
       illuminance: illuminance,
-      pressure: pressure
-
+      pressure: pressure,
+      pir_motion_count: count === 0xffffffff ? null : count,
+      occupancy: occupancy,
+      co2: ((bytes[14] << 8) | bytes[15]) === 0xffff ? null : ((bytes[14] << 8) | bytes[15])
     };
 
+    // Interval statistics appended by AT$STATS=1
+    if (bytes.length === 27 || bytes.length === 31) {
+      decoded.temperature_min = (((bytes[16] << 8) | bytes[17]) << 16 >> 16) / 10.0;
+      decoded.temperature_max = (((bytes[18] << 8) | bytes[19]) << 16 >> 16) / 10.0;
+      decoded.temperature_stddev = bytes[20] / 100.0;
+      decoded.co2_min = (bytes[21] << 8) | bytes[22];
+      decoded.co2_max = (bytes[23] << 8) | bytes[24];
+      decoded.co2_stddev = (bytes[25] << 8) | bytes[26];
+    }
+
     return decoded;
   }